@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "arena.h"
+#include "stats.h"
+
+// Alignment of every allocation (enough for pointers, ints and doubles)
+#define ARENA_ALIGN 16
+
+// Space taken by the block header (rounded up so data stays aligned)
+#define BLOCK_HEADER (((sizeof(ArenaBlock) + ARENA_ALIGN - 1) / ARENA_ALIGN) * ARENA_ALIGN)
+
+
+/* Allocate a new, empty block
+ * Parameters:
+ *		size		number of bytes of data in the block
+ * Return: pointer to new ArenaBlock
+ */
+static ArenaBlock* create_block(size_t size) {
+	ArenaBlock* block = malloc(BLOCK_HEADER + size);
+	if (block == NULL) {
+		fprintf(stderr, "Out of memory (arena block of %zu bytes)\n", size);
+		exit(EXIT_FAILURE);
+	}
+	block->next = NULL;
+	block->size = size;
+	block->used = 0;
+	STATS_COUNT(STAT_ALLOCATIONS, 1);
+	return block;
+}
+
+/* Create an arena
+ * Parameters:
+ *		initial_size	size in bytes of the first block
+ * Return: pointer to new Arena
+ */
+Arena* create_arena(size_t initial_size) {
+	Arena* arena = malloc(sizeof * arena);
+	STATS_COUNT(STAT_ALLOCATIONS, 1);
+	arena->first = create_block(initial_size > 0 ? initial_size : ARENA_ALIGN);
+	arena->current = arena->first;
+	return arena;
+}
+
+/* Destroy an arena (free all blocks, and so every allocation made from it)
+ * Parameters:
+ *		self		Arena instance
+ * Return: void
+ */
+void destroy_arena(Arena* self) {
+	if (self == NULL) {
+		return;
+	}
+
+	ArenaBlock* current = self->first;
+	while (current != NULL) {
+		ArenaBlock* to_free = current;
+		current = current->next;
+		free(to_free);
+	}
+	free(self);
+}
+
+/* Allocate memory from an arena (aligned for any type)
+ * Parameters:
+ *		self		Arena instance
+ *		size		number of bytes
+ * Return: pointer to memory
+ */
+void* arena_alloc(Arena* self, size_t size) {
+	size = ((size + ARENA_ALIGN - 1) / ARENA_ALIGN) * ARENA_ALIGN;
+
+	// Move on to the next block (kept from before a reset, or new and twice as big) if this one is full
+	while (self->current->used + size > self->current->size) {
+		if (self->current->next == NULL) {
+			size_t new_size = self->current->size * 2;
+			if (new_size < size) {
+				new_size = size;
+			}
+			self->current->next = create_block(new_size);
+		}
+		self->current = self->current->next;
+	}
+
+	void* memory = (char*)self->current + BLOCK_HEADER + self->current->used;
+	self->current->used += size;
+	return memory;
+}
+
+/* Release every allocation at once, keeping the blocks for reuse
+ * Parameters:
+ *		self		Arena instance
+ * Return: void
+ */
+void arena_reset(Arena* self) {
+	for (ArenaBlock* block = self->first; block != NULL; block = block->next) {
+		block->used = 0;
+	}
+	self->current = self->first;
+}
@@ -0,0 +1,53 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/* Block of memory handed out by an arena (data follows the header in the same allocation) */
+typedef struct arenaBlock {
+	struct arenaBlock* next;
+	size_t size;
+	size_t used;
+} ArenaBlock;
+
+/* Bump allocator: allocations are never freed one by one, only all at once
+ *		Blocks double in size as the arena grows, reset keeps them for reuse
+ */
+typedef struct arena {
+	ArenaBlock* first;
+	ArenaBlock* current;
+} Arena;
+
+
+/* Create an arena
+ * Parameters:
+ *		initial_size	size in bytes of the first block
+ * Return: pointer to new Arena
+ */
+Arena* create_arena(size_t initial_size);
+
+
+/* Destroy an arena (free all blocks, and so every allocation made from it)
+ * Parameters:
+ *		self		Arena instance
+ * Return: void
+ */
+void destroy_arena(Arena* self);
+
+
+/* Allocate memory from an arena (aligned for any type)
+ * Parameters:
+ *		self		Arena instance
+ *		size		number of bytes
+ * Return: pointer to memory
+ */
+void* arena_alloc(Arena* self, size_t size);
+
+
+/* Release every allocation at once, keeping the blocks for reuse
+ * Parameters:
+ *		self		Arena instance
+ * Return: void
+ */
+void arena_reset(Arena* self);
+#endif
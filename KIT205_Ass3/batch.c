@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "graph.h"
+#include "pathcache.h"
+#include "steiner.h"
+#include "batch.h"
+#include "stats.h"
+
+
+/* Read a ticket set (Read inputs) ------------------------------------
+ *		Line 1: number of tickets, line 2: tickets as pairs "a,b"
+ * Parameters:
+ *		self		pointer to TicketSet to fill in
+ *		input		Parser positioned at the ticket set
+ *		V			number of vertices in the map (to check cities)
+ * Return: true if a ticket set was read, false at end of input or if it is malformed (input->failed set)
+ */
+bool read_ticket_set(TicketSet* self, Parser* input, int V) {
+	self->n_tickets = 0;
+	self->from_cities = NULL;
+	self->to_cities = NULL;
+
+	if (parser_at_end(input) || !parse_int(input, &self->n_tickets, "number of tickets")) {
+		return false;
+	}
+	if (self->n_tickets < 0) {
+		parser_error(input, "number of tickets cannot be negative");
+		return false;
+	}
+
+	self->from_cities = malloc(sizeof(int) * self->n_tickets);
+	self->to_cities = malloc(sizeof(int) * self->n_tickets);
+	for (int n = 0; n < self->n_tickets; n++) {
+		if (!parse_pair(input, &self->from_cities[n], &self->to_cities[n], "ticket \"a,b\"")) {
+			break;
+		}
+		if (self->from_cities[n] < 0 || self->from_cities[n] >= V || self->to_cities[n] < 0 || self->to_cities[n] >= V) {
+			parser_error(input, "ticket city is not a vertex of the map");
+		}
+	}
+
+	if (input->failed) {
+		destroy_ticket_set(self);
+		return false;
+	}
+	return true;
+}
+
+/* Destroy a ticket set (free all memory)
+ * Parameters:
+ *		self		TicketSet instance
+ * Return: void
+ */
+void destroy_ticket_set(TicketSet* self) {
+	free(self->from_cities);
+	free(self->to_cities);
+	self->from_cities = NULL;
+	self->to_cities = NULL;
+	self->n_tickets = 0;
+}
+
+
+/* Solve many ticket sets against 1 map in parallel
+ *		Shortest path trees of all ticket cities are computed first, then the map and cache are
+ *		only read while the sets are solved on the OpenMP worker threads
+ * Parameters:
+ *		map			CSRGraph instance
+ *		sets[]		array of ticket sets
+ *		n_sets		number of ticket sets
+ *		results[]	array storing the result of each set (same order as sets)
+ * Return: void
+ */
+void solve_batch(CSRGraph* map, TicketSet sets[], int n_sets, BatchResult results[]) {
+	STATS_BEGIN("solve_batch");
+	PathCache cache = create_path_cache(map);
+
+	// Fill the cache up front with every ticket city of every set
+	int n_cities = 0;
+	for (int s = 0; s < n_sets; s++) {
+		n_cities += sets[s].n_tickets * 2;
+	}
+	int* cities = malloc(sizeof(int) * (n_cities > 0 ? n_cities : 1));
+	n_cities = 0;
+	for (int s = 0; s < n_sets; s++) {
+		for (int n = 0; n < sets[s].n_tickets; n++) {
+			cities[n_cities++] = sets[s].from_cities[n];
+			cities[n_cities++] = sets[s].to_cities[n];
+		}
+	}
+	if (n_cities > 0) {
+		warm_path_cache(&cache, cities, n_cities);
+	}
+
+	// Solve each set independently (sets can differ a lot in size, so hand them out dynamically)
+	#pragma omp parallel for schedule(dynamic)
+	for (int s = 0; s < n_sets; s++) {
+		TicketSet* set = &sets[s];
+		if (set->n_tickets == 0) {
+			results[s].shortest_paths_cost = 0;
+			results[s].steiner_tree_cost = 0;
+			continue;
+		}
+
+		Graph shortest_G = cached_shortest_paths(&cache, set->from_cities, set->to_cities, set->n_tickets);
+		results[s].shortest_paths_cost = graph_weight(&shortest_G);
+		destroy_graph(&shortest_G);
+
+		// Merge from and to_cities into 1 array
+		int* terminals = malloc(sizeof(int) * set->n_tickets * 2);
+		for (int n = 0; n < set->n_tickets; n++) {
+			terminals[n] = set->from_cities[n];
+			terminals[n + set->n_tickets] = set->to_cities[n];
+		}
+
+		Graph steiner_t = solve_steiner_tree(&cache, terminals, set->n_tickets * 2);
+		results[s].steiner_tree_cost = graph_weight(&steiner_t);
+		destroy_graph(&steiner_t);
+		free(terminals);
+	}
+
+	/* Free memory */
+	free(cities);
+	destroy_path_cache(&cache);
+	STATS_END("solve_batch");
+}
@@ -0,0 +1,52 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "parser.h"
+
+/* A set of tickets (a hand) to fulfil on a map */
+typedef struct ticketSet {
+	int n_tickets;
+	int* from_cities;
+	int* to_cities;
+} TicketSet;
+
+/* Costs of both solutions for 1 ticket set */
+typedef struct batchResult {
+	int shortest_paths_cost;
+	int steiner_tree_cost;
+} BatchResult;
+
+
+/* Read a ticket set (Read inputs) ------------------------------------
+ *		Line 1: number of tickets, line 2: tickets as pairs "a,b"
+ * Parameters:
+ *		self		pointer to TicketSet to fill in
+ *		input		Parser positioned at the ticket set
+ *		V			number of vertices in the map (to check cities)
+ * Return: true if a ticket set was read, false at end of input or if it is malformed (input->failed set)
+ */
+bool read_ticket_set(TicketSet* self, Parser* input, int V);
+
+
+/* Destroy a ticket set (free all memory)
+ * Parameters:
+ *		self		TicketSet instance
+ * Return: void
+ */
+void destroy_ticket_set(TicketSet* self);
+
+
+/* Solve many ticket sets against 1 map in parallel
+ *		Shortest path trees of all ticket cities are computed first, then the map and cache are
+ *		only read while the sets are solved on the OpenMP worker threads
+ * Parameters:
+ *		map			CSRGraph instance
+ *		sets[]		array of ticket sets
+ *		n_sets		number of ticket sets
+ *		results[]	array storing the result of each set (same order as sets)
+ * Return: void
+ */
+void solve_batch(CSRGraph* map, TicketSet sets[], int n_sets, BatchResult results[]);
+#endif
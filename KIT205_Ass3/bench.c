@@ -0,0 +1,668 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include "graph.h"
+#include "pathcache.h"
+#include "routesearch.h"
+#include "hierarchy.h"
+#include "mst.h"
+#include "dense.h"
+#include "steiner.h"
+#include "steiner_kmb.h"
+#include "steiner_multistart.h"
+#include "steiner_local.h"
+#include "steiner_incremental.h"
+#include "longest_trail.h"
+#include "ticket_select.h"
+#include "batch.h"
+#include "mapgen.h"
+#include "bench.h"
+#include "stats.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Differences in median time below this are noise, never a regression
+#define BENCH_NOISE_MS 0.5
+
+// Routes claimed by the player whose longest continuous route is timed
+#define BENCH_TRAIL_ROUTES 45
+
+// Candidate tickets (the first of each map's tickets) for ticket selection, within half their total length
+#define BENCH_SELECT_TICKETS 12
+
+// Maps used when none are given
+static MapSpec default_maps[] = {
+	{ MAP_GRID, 10000, 0, 20 },
+	{ MAP_PLANAR, 10000, 0, 20 },
+	{ MAP_RANDOM, 10000, 0, 20 },
+	{ MAP_GRID, 100000, 0, 20 },
+};
+
+/* What a solver gets to work on
+ *		hierarchy is built by the "hierarchy" solver, for the solvers after it (NULL until then)
+ *		dense is the matrix form of a dense map, built by the "dense_matrix" solver (NULL until then, or if the map
+ *		is not dense)
+ */
+typedef struct benchContext {
+	CSRGraph* map;
+	TicketSet* tickets;
+	int* terminals;
+	int n_terminals;
+	int run;
+	ContractionHierarchy* hierarchy;
+	DenseGraph* dense;
+} BenchContext;
+
+/* A solver to time (returns the cost of its solution, to check results do not change)
+ *		once: preprocessing, run and timed only once (no warm-up run)
+ */
+typedef struct benchSolver {
+	const char* name;
+	long long (*solve)(BenchContext* context);
+	bool once;
+} BenchSolver;
+
+/* 1 line of results (1 solver on 1 map) */
+typedef struct benchRow {
+	char map[16];
+	int V;
+	int E;
+	int n_tickets;
+	char solver[32];
+	int runs;
+	double p50_ms;
+	double p99_ms;
+	long peak_kb;
+	long long cost;
+} BenchRow;
+
+
+/* Solvers ----------------------------------------------------------- */
+
+static long long solve_prims_mst(BenchContext* context) {
+	Graph MST = csr_prims_mst(context->map);
+	long long cost = graph_weight(&MST);
+	destroy_graph(&MST);
+	return cost;
+}
+
+static long long solve_kruskal_mst(BenchContext* context) {
+	Graph MST = csr_kruskal_mst(context->map);
+	long long cost = graph_weight(&MST);
+	destroy_graph(&MST);
+	return cost;
+}
+
+static long long solve_boruvka_mst(BenchContext* context) {
+	Graph MST = csr_boruvka_mst(context->map);
+	long long cost = graph_weight(&MST);
+	destroy_graph(&MST);
+	return cost;
+}
+
+// 1 ticket per run (cycling through the tickets)
+static long long solve_dijkstra(BenchContext* context) {
+	TicketSet* tickets = context->tickets;
+	if (tickets->n_tickets == 0) {
+		return 0;
+	}
+	int n = context->run % tickets->n_tickets;
+	Arena* arena = create_arena(4096);
+	int distance;
+	csr_dijkstra(context->map, tickets->from_cities[n], tickets->to_cities[n], &distance, arena);
+	destroy_arena(arena);
+	return distance;
+}
+
+// 1 ticket per run, bidirectional (only the search state is set up per run)
+static long long solve_bidirectional_search(BenchContext* context) {
+	TicketSet* tickets = context->tickets;
+	if (tickets->n_tickets == 0) {
+		return 0;
+	}
+	int n = context->run % tickets->n_tickets;
+	Arena* arena = create_arena(4096);
+	RouteSearch search = create_route_search(context->map);
+	int distance;
+	bidirectional_search(&search, tickets->from_cities[n], tickets->to_cities[n], &distance, arena);
+	destroy_route_search(&search);
+	destroy_arena(arena);
+	return distance;
+}
+
+// Matrix form of a dense map, kept in the context (nothing to do on a sparse map, see solvers[])
+static long long solve_dense_matrix(BenchContext* context) {
+	if (context->dense != NULL) {
+		destroy_dense_graph(context->dense);
+		free(context->dense);
+		context->dense = NULL;
+	}
+	if (!csr_is_dense(context->map)) {
+		return 0;
+	}
+	context->dense = malloc(sizeof(DenseGraph));
+	*context->dense = create_dense_graph(context->map);
+	return context->dense->stride;
+}
+
+static long long solve_dense_prims_mst(BenchContext* context) {
+	if (context->dense == NULL) {
+		return 0;
+	}
+	Graph MST = dense_prims_mst(context->dense);
+	long long cost = graph_weight(&MST);
+	destroy_graph(&MST);
+	return cost;
+}
+
+// 1 ticket per run (cycling through the tickets, as dijkstra)
+static long long solve_dense_dijkstra(BenchContext* context) {
+	TicketSet* tickets = context->tickets;
+	if (context->dense == NULL || tickets->n_tickets == 0) {
+		return 0;
+	}
+	int n = context->run % tickets->n_tickets;
+	Arena* arena = create_arena(4096);
+	int distance;
+	dense_dijkstra(context->dense, tickets->from_cities[n], tickets->to_cities[n], &distance, arena);
+	destroy_arena(arena);
+	return distance;
+}
+
+// Bidirectional searches until landmarks are built, A* (ALT) after (see solvers[])
+static long long solve_shortest_paths(BenchContext* context) {
+	TicketSet* tickets = context->tickets;
+	Graph G = csr_shortest_paths(context->map, tickets->from_cities, tickets->to_cities, tickets->n_tickets);
+	long long cost = graph_weight(&G);
+	destroy_graph(&G);
+	return cost;
+}
+
+static long long solve_landmarks(BenchContext* context) {
+	build_landmarks(context->map, 0);
+	return context->map->n_landmarks;
+}
+
+static long long solve_csr_steiner_tree(BenchContext* context) {
+	Graph G = csr_steiner_tree(context->map, context->terminals, context->n_terminals);
+	long long cost = graph_weight(&G);
+	destroy_graph(&G);
+	return cost;
+}
+
+// Both solutions from a new (cold) path cache, as main() runs them
+static long long solve_cached(BenchContext* context) {
+	TicketSet* tickets = context->tickets;
+	PathCache cache = create_path_cache(context->map);
+	Graph shortest_G = cached_shortest_paths(&cache, tickets->from_cities, tickets->to_cities, tickets->n_tickets);
+	Graph steiner_t = solve_steiner_tree(&cache, context->terminals, context->n_terminals);
+	long long cost = graph_weight(&steiner_t);
+	destroy_graph(&shortest_G);
+	destroy_graph(&steiner_t);
+	destroy_path_cache(&cache);
+	return cost;
+}
+
+// KMB Steiner tree from a new (cold) path cache
+static long long solve_kmb_steiner_tree(BenchContext* context) {
+	PathCache cache = create_path_cache(context->map);
+	Graph steiner_t = kmb_steiner_tree(&cache, context->terminals, context->n_terminals);
+	long long cost = graph_weight(&steiner_t);
+	destroy_graph(&steiner_t);
+	destroy_path_cache(&cache);
+	return cost;
+}
+
+// Best greedy Steiner tree over every first terminal, from a new (cold) path cache
+static long long solve_multistart_steiner_tree(BenchContext* context) {
+	PathCache cache = create_path_cache(context->map);
+	Graph steiner_t = multistart_steiner_tree(&cache, context->terminals, context->n_terminals, 0);
+	long long cost = graph_weight(&steiner_t);
+	destroy_graph(&steiner_t);
+	destroy_path_cache(&cache);
+	return cost;
+}
+
+// Union of shortest paths (Solution 1) improved by local search, from a new (cold) path cache
+static long long solve_improved_shortest_paths(BenchContext* context) {
+	TicketSet* tickets = context->tickets;
+	PathCache cache = create_path_cache(context->map);
+	Graph G = cached_shortest_paths(&cache, tickets->from_cities, tickets->to_cities, tickets->n_tickets);
+	improve_steiner_tree(context->map, &G, context->terminals, context->n_terminals, 0);
+	long long cost = graph_weight(&G);
+	destroy_graph(&G);
+	destroy_path_cache(&cache);
+	return cost;
+}
+
+// KMB Steiner tree improved by local search, from a new (cold) path cache
+static long long solve_improved_kmb_steiner_tree(BenchContext* context) {
+	PathCache cache = create_path_cache(context->map);
+	Graph steiner_t = kmb_steiner_tree(&cache, context->terminals, context->n_terminals);
+	improve_steiner_tree(context->map, &steiner_t, context->terminals, context->n_terminals, 0);
+	long long cost = graph_weight(&steiner_t);
+	destroy_graph(&steiner_t);
+	destroy_path_cache(&cache);
+	return cost;
+}
+
+// Steiner tree grown 1 ticket at a time
+static long long solve_incremental_steiner_tree(BenchContext* context) {
+	TicketSet* tickets = context->tickets;
+	SteinerState state = create_steiner_state(context->map, NULL, NULL, 0);
+	for (int n = 0; n < tickets->n_tickets; n++) {
+		steiner_add_ticket(&state, tickets->from_cities[n], tickets->to_cities[n]);
+	}
+	long long cost = state.cost;
+	destroy_steiner_state(&state);
+	return cost;
+}
+
+// Contraction hierarchy of the map, kept in the context (see solvers[])
+static long long solve_hierarchy(BenchContext* context) {
+	if (context->hierarchy == NULL) {
+		context->hierarchy = malloc(sizeof(ContractionHierarchy));
+	}
+	else {
+		destroy_hierarchy(context->hierarchy);
+	}
+	*context->hierarchy = build_hierarchy(context->map);
+	return context->hierarchy->up.E;
+}
+
+// 1 ticket per run on the hierarchy (only the query state is set up per run)
+static long long solve_hierarchy_query(BenchContext* context) {
+	TicketSet* tickets = context->tickets;
+	if (tickets->n_tickets == 0) {
+		return 0;
+	}
+	int n = context->run % tickets->n_tickets;
+	Arena* arena = create_arena(4096);
+	HierarchyQuery query = create_hierarchy_query(context->hierarchy);
+	int distance;
+	hierarchy_path(&query, tickets->from_cities[n], tickets->to_cities[n], &distance, arena);
+	destroy_hierarchy_query(&query);
+	destroy_arena(arena);
+	return distance;
+}
+
+// Both solutions from a new (cold) path cache with the hierarchy attached
+static long long solve_hierarchy_cached(BenchContext* context) {
+	TicketSet* tickets = context->tickets;
+	PathCache cache = create_path_cache(context->map);
+	HierarchyQuery query = create_hierarchy_query(context->hierarchy);
+	attach_hierarchy(&cache, &query);
+	Graph shortest_G = cached_shortest_paths(&cache, tickets->from_cities, tickets->to_cities, tickets->n_tickets);
+	Graph steiner_t = solve_steiner_tree(&cache, context->terminals, context->n_terminals);
+	long long cost = graph_weight(&steiner_t);
+	destroy_graph(&shortest_G);
+	destroy_graph(&steiner_t);
+	destroy_hierarchy_query(&query);
+	destroy_path_cache(&cache);
+	return cost;
+}
+
+// Longest continuous route in the first BENCH_TRAIL_ROUTES routes around the first terminal (search order)
+//		A patch of the map full of cycles, harder than the trees a player usually claims
+static long long solve_longest_trail(BenchContext* context) {
+	CSRGraph* map = context->map;
+	Graph claimed = create_empty_graph(map->V);
+	if (context->n_terminals > 0) {
+		// state: 0 = not reached, 1 = queued, 2 = its routes to every city done before it claimed
+		int* queue = malloc(sizeof(int) * map->V);
+		char* state = calloc(map->V, sizeof(char));
+		int head = 0;
+		int tail = 0;
+		int n_routes = 0;
+		queue[tail++] = context->terminals[0];
+		state[context->terminals[0]] = 1;
+		while (head < tail && n_routes < BENCH_TRAIL_ROUTES) {
+			int v = queue[head++];
+			for (int e = map->offsets[v]; e < map->offsets[v + 1]; e++) {
+				if (state[map->to_vertex[e]] == 0) {
+					state[map->to_vertex[e]] = 1;
+					queue[tail++] = map->to_vertex[e];
+				}
+			}
+			state[v] = 2;
+			for (int e = map->offsets[v]; e < map->offsets[v + 1] && n_routes < BENCH_TRAIL_ROUTES; e++) {
+				int u = map->to_vertex[e];
+				if (state[u] == 2 && u != v) {
+					add_edge(&claimed, v < u ? v : u, v < u ? u : v, map->weight[e]);
+					n_routes++;
+				}
+			}
+		}
+		free(queue);
+		free(state);
+	}
+
+	int length;
+	EdgeList trail = longest_trail(&claimed, &length, NULL);
+	destroy_path(&trail);
+	destroy_graph(&claimed);
+	return length;
+}
+
+// Tickets worth the most points (their lengths) within the budget, from a new (cold) path cache
+static long long solve_ticket_selection(BenchContext* context) {
+	TicketSet* tickets = context->tickets;
+	TicketSet candidates = { tickets->n_tickets < BENCH_SELECT_TICKETS ? tickets->n_tickets : BENCH_SELECT_TICKETS,
+		tickets->from_cities, tickets->to_cities };
+	PathCache cache = create_path_cache(context->map);
+	long long length = 0;
+	for (int n = 0; n < candidates.n_tickets; n++) {
+		int distance = cached_distance(&cache, candidates.from_cities[n], candidates.to_cities[n]);
+		length += distance != INT_MAX ? distance : 0;
+	}
+	TicketSelection selection = select_tickets(&cache, &candidates, NULL, (int)(length / 2));
+	long long score = selection.score;
+	destroy_ticket_selection(&selection);
+	destroy_path_cache(&cache);
+	return score;
+}
+
+static BenchSolver solvers[] = {
+	{ "prims_mst", solve_prims_mst, false },
+	{ "kruskal_mst", solve_kruskal_mst, false },
+	{ "boruvka_mst", solve_boruvka_mst, false },
+	{ "dijkstra", solve_dijkstra, false },
+	{ "dense_matrix", solve_dense_matrix, true },
+	{ "dense_prims_mst", solve_dense_prims_mst, false },
+	{ "dense_dijkstra", solve_dense_dijkstra, false },
+	{ "bidirectional_search", solve_bidirectional_search, false },
+	{ "shortest_paths", solve_shortest_paths, false },
+	{ "landmarks", solve_landmarks, false },
+	{ "alt_shortest_paths", solve_shortest_paths, false },
+	{ "steiner_tree", solve_csr_steiner_tree, false },
+	{ "kmb_steiner_tree", solve_kmb_steiner_tree, false },
+	{ "multistart_steiner", solve_multistart_steiner_tree, false },
+	{ "local_search_paths", solve_improved_shortest_paths, false },
+	{ "local_search_kmb", solve_improved_kmb_steiner_tree, false },
+	{ "incremental_steiner", solve_incremental_steiner_tree, false },
+	{ "cached_solutions", solve_cached, false },
+	{ "hierarchy", solve_hierarchy, true },
+	{ "hierarchy_query", solve_hierarchy_query, false },
+	{ "hierarchy_solutions", solve_hierarchy_cached, false },
+	{ "longest_trail", solve_longest_trail, false },
+	{ "ticket_selection", solve_ticket_selection, false },
+};
+
+
+/* Measurements ------------------------------------------------------ */
+
+/* Start a new peak memory measurement (only possible on Linux, elsewhere the peak is for the whole process) */
+static void reset_peak_memory(void) {
+#ifdef __linux__
+	FILE* file = fopen("/proc/self/clear_refs", "w");
+	if (file != NULL) {
+		fputs("5", file);
+		fclose(file);
+	}
+#endif
+}
+
+/* Peak resident memory in KB */
+static long peak_memory_kb(void) {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return (long)(counters.PeakWorkingSetSize / 1024);
+	}
+	return 0;
+#else
+#ifdef __linux__
+	// VmHWM follows reset_peak_memory()
+	FILE* file = fopen("/proc/self/status", "r");
+	if (file != NULL) {
+		char line[256];
+		long peak = -1;
+		while (peak < 0 && fgets(line, sizeof(line), file) != NULL) {
+			if (strncmp(line, "VmHWM:", 6) == 0) {
+				peak = strtol(line + 6, NULL, 10);
+			}
+		}
+		fclose(file);
+		if (peak >= 0) {
+			return peak;
+		}
+	}
+#endif
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+#endif
+}
+
+/* Compare doubles for qsort() */
+static int compare_times(const void* a, const void* b) {
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+/* Percentile of sorted times (nearest rank) */
+static double percentile(double sorted[], int n, int p) {
+	int rank = (p * n + 99) / 100;
+	return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/* Time 1 solver on 1 map (1 untimed warm-up run, then runs timed runs, or 1 timed run only for preprocessing) */
+static void time_solver(BenchSolver* solver, BenchContext* context, int runs, BenchRow* row) {
+	if (solver->once) {
+		runs = 1;
+	}
+	double* times = malloc(sizeof(double) * runs);
+
+	reset_peak_memory();
+	context->run = 0;
+	if (solver->once) {
+		double start = stats_now();
+		row->cost = solver->solve(context);
+		times[0] = stats_now() - start;
+	}
+	else {
+		row->cost = solver->solve(context);
+		for (int r = 0; r < runs; r++) {
+			context->run = r;
+			double start = stats_now();
+			solver->solve(context);
+			times[r] = stats_now() - start;
+		}
+	}
+	row->peak_kb = peak_memory_kb();
+
+	qsort(times, runs, sizeof(double), compare_times);
+	row->runs = runs;
+	row->p50_ms = percentile(times, runs, 50);
+	row->p99_ms = percentile(times, runs, 99);
+	snprintf(row->solver, sizeof(row->solver), "%s", solver->name);
+	free(times);
+}
+
+
+/* Baseline files ---------------------------------------------------- */
+
+static FILE* open_file(const char* path, const char* mode) {
+	FILE* file = NULL;
+#ifdef _MSC_VER
+	fopen_s(&file, path, mode);
+#else
+	file = fopen(path, mode);
+#endif
+	return file;
+}
+
+/* Save results as CSV (with a header line) */
+static bool save_results(const char* path, BenchRow rows[], int n_rows) {
+	FILE* file = open_file(path, "w");
+	if (file == NULL) {
+		fprintf(stderr, "Cannot write benchmark results '%s'\n", path);
+		return false;
+	}
+
+	fprintf(file, "map,V,E,tickets,solver,runs,p50_ms,p99_ms,peak_kb,cost\n");
+	for (int n = 0; n < n_rows; n++) {
+		BenchRow* row = &rows[n];
+		fprintf(file, "%s,%d,%d,%d,%s,%d,%.4f,%.4f,%ld,%lld\n", row->map, row->V, row->E, row->n_tickets,
+			row->solver, row->runs, row->p50_ms, row->p99_ms, row->peak_kb, row->cost);
+	}
+	fclose(file);
+	return true;
+}
+
+/* Read 1 CSV line saved by save_results() (false for the header or a malformed line) */
+static bool read_result(char* line, BenchRow* row) {
+	char* fields[10];
+	int n_fields = 0;
+	fields[n_fields++] = line;
+	for (char* c = line; *c != '\0' && *c != '\n' && *c != '\r'; c++) {
+		if (*c == ',') {
+			*c = '\0';
+			if (n_fields == 10) {
+				return false;
+			}
+			fields[n_fields++] = c + 1;
+		}
+	}
+	if (n_fields != 10 || strcmp(fields[0], "map") == 0) {
+		return false;
+	}
+
+	// Map and solver names longer than the row holds are not from save_results()
+	if (snprintf(row->map, sizeof(row->map), "%s", fields[0]) >= (int)sizeof(row->map)
+		|| snprintf(row->solver, sizeof(row->solver), "%s", fields[4]) >= (int)sizeof(row->solver)) {
+		return false;
+	}
+	row->V = atoi(fields[1]);
+	row->E = atoi(fields[2]);
+	row->n_tickets = atoi(fields[3]);
+	row->runs = atoi(fields[5]);
+	row->p50_ms = strtod(fields[6], NULL);
+	row->p99_ms = strtod(fields[7], NULL);
+	row->peak_kb = strtol(fields[8], NULL, 10);
+	row->cost = strtoll(fields[9], NULL, 10);
+	return true;
+}
+
+/* Compare results with a saved baseline, print changes
+ * Return: number of regressions (-1 if the baseline cannot be read)
+ */
+static int compare_with_baseline(const char* path, BenchRow rows[], int n_rows) {
+	FILE* file = open_file(path, "r");
+	if (file == NULL) {
+		fprintf(stderr, "Cannot read benchmark baseline '%s'\n", path);
+		return -1;
+	}
+
+	printf("\nCompared with %s (regression: median over %.0f%% slower):\n", path, BENCH_REGRESSION_PERCENT);
+	int n_regressions = 0;
+	char line[256];
+	BenchRow old;
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (!read_result(line, &old)) {
+			continue;
+		}
+
+		for (int n = 0; n < n_rows; n++) {
+			BenchRow* row = &rows[n];
+			if (strcmp(row->map, old.map) != 0 || row->V != old.V || row->E != old.E
+				|| row->n_tickets != old.n_tickets || strcmp(row->solver, old.solver) != 0) {
+				continue;
+			}
+
+			double change = old.p50_ms > 0 ? 100.0 * (row->p50_ms - old.p50_ms) / old.p50_ms : 0;
+			bool regressed = change > BENCH_REGRESSION_PERCENT && row->p50_ms - old.p50_ms > BENCH_NOISE_MS;
+			n_regressions += regressed;
+			printf("%-8s %9d %-18s %10.3f -> %10.3f ms (%+6.1f%%)%s%s\n", row->map, row->V, row->solver,
+				old.p50_ms, row->p50_ms, change, regressed ? "  REGRESSION" : "",
+				row->cost != old.cost ? "  COST CHANGED" : "");
+		}
+	}
+	fclose(file);
+	return n_regressions;
+}
+
+
+/* Time every solver on generated maps, print p50 / p99 latency and peak memory, save / compare a CSV baseline
+ * Parameters:
+ *		options		BenchOptions
+ * Return: exit code (1 if a solver regressed against the baseline, or a file cannot be used)
+ */
+int run_benchmarks(BenchOptions* options) {
+	MapSpec* maps = options->maps;
+	int n_maps = options->n_maps;
+	if (n_maps == 0) {
+		maps = default_maps;
+		n_maps = sizeof(default_maps) / sizeof(default_maps[0]);
+	}
+	int n_solvers = sizeof(solvers) / sizeof(solvers[0]);
+	int runs = options->runs > 0 ? options->runs : 1;
+
+	BenchRow* rows = malloc(sizeof(BenchRow) * n_maps * n_solvers);
+	int n_rows = 0;
+
+	printf("%-8s %9s %9s %7s %-18s %10s %10s %10s %12s\n", "map", "V", "E", "tickets", "solver", "p50 (ms)", "p99 (ms)", "peak (KB)", "cost");
+	for (int m = 0; m < n_maps; m++) {
+		// Map and tickets (seeded, so every run of the benchmark uses the same ones)
+		Graph G = generate_map(&maps[m], options->seed + m);
+		CSRGraph map = create_csr_graph(&G);
+		destroy_graph(&G);
+		TicketSet tickets = generate_tickets(map.V, maps[m].n_tickets, options->seed + m + 1000);
+
+		int n_terminals = tickets.n_tickets * 2;
+		int* terminals = malloc(sizeof(int) * (n_terminals > 0 ? n_terminals : 1));
+		for (int n = 0; n < tickets.n_tickets; n++) {
+			terminals[n] = tickets.from_cities[n];
+			terminals[n + tickets.n_tickets] = tickets.to_cities[n];
+		}
+
+		BenchContext context = { &map, &tickets, terminals, n_terminals, 0, NULL, NULL };
+		for (int s = 0; s < n_solvers; s++) {
+			BenchRow* row = &rows[n_rows++];
+			snprintf(row->map, sizeof(row->map), "%s", map_shape_name(maps[m].shape));
+			row->V = map.V;
+			row->E = map.E / 2;
+			row->n_tickets = tickets.n_tickets;
+			time_solver(&solvers[s], &context, runs, row);
+
+			printf("%-8s %9d %9d %7d %-18s %10.3f %10.3f %10ld %12lld\n", row->map, row->V, row->E, row->n_tickets,
+				row->solver, row->p50_ms, row->p99_ms, row->peak_kb, row->cost);
+			fflush(stdout);
+		}
+
+		if (context.hierarchy != NULL) {
+			destroy_hierarchy(context.hierarchy);
+			free(context.hierarchy);
+		}
+		if (context.dense != NULL) {
+			destroy_dense_graph(context.dense);
+			free(context.dense);
+		}
+		free(terminals);
+		destroy_ticket_set(&tickets);
+		destroy_csr_graph(&map);
+	}
+
+	int status = 0;
+	if (options->output_path != NULL && !save_results(options->output_path, rows, n_rows)) {
+		status = 1;
+	}
+	if (options->baseline_path != NULL) {
+		int n_regressions = compare_with_baseline(options->baseline_path, rows, n_rows);
+		if (n_regressions != 0) {
+			status = 1;
+		}
+	}
+
+	free(rows);
+	return status;
+}
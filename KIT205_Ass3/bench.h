@@ -0,0 +1,32 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include "mapgen.h"
+
+// A solver counts as slower than the baseline if its median time grows by more than this
+#define BENCH_REGRESSION_PERCENT 15.0
+
+/* Options of a benchmark run
+ *		maps / n_maps		generated maps to run every solver on (NULL / 0 for the default suite)
+ *		runs				timed runs per solver and map
+ *		output_path			CSV file to save the results to (NULL to not save)
+ *		baseline_path		CSV file saved by an earlier run to compare with (NULL to not compare)
+ */
+typedef struct benchOptions {
+	MapSpec* maps;
+	int n_maps;
+	int runs;
+	uint64_t seed;
+	const char* output_path;
+	const char* baseline_path;
+} BenchOptions;
+
+
+/* Time every solver on generated maps, print p50 / p99 latency and peak memory, save / compare a CSV baseline
+ * Parameters:
+ *		options		BenchOptions
+ * Return: exit code (1 if a solver regressed against the baseline, or a file cannot be used)
+ */
+int run_benchmarks(BenchOptions* options);
+#endif
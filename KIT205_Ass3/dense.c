@@ -0,0 +1,493 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "graph.h"
+#include "dense.h"
+#include "stats.h"
+
+// SIMD kernels are only built for x86-64 (SSE2 is always there, AVX2 is checked at run time)
+#if defined(__x86_64__) || defined(_M_X64)
+#define DENSE_X86_64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DENSE_TARGET_AVX2
+#else
+#define DENSE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Smallest map csr_is_dense() accepts (below this, the heap searches are just as fast)
+#define DENSE_MIN_VERTICES 64
+
+// Key of a vertex that is settled (in the tree), or a padding entry: the largest key as an unsigned int
+#define DENSE_SETTLED (-1)
+
+// Kernel used by dense_prims_mst(), csr_dense_prims_mst() and dense_dijkstra()
+static DenseKernel dense_kernel = DENSE_KERNEL_AUTO;
+
+/* Batched relaxation: relax the edges of a newly settled vertex v, from its row of the matrix
+ *		key[u] becomes d + row[u] where that is smaller (pred[u] = v then). Settled and padding keys are -1, which no
+ *		new key is below
+ */
+typedef void (*RelaxRow)(const int row[], int d, int key[], int pred[], int v, int stride);
+
+/* Argmin over the vertices not yet settled: settled and padding keys (-1) are the largest keys as unsigned ints,
+ * so the minimum of the unsigned keys skips them
+ * Return: vertex with the smallest key (the lowest on a tie), -1 if no vertex left is reachable
+ */
+typedef int (*SelectMin)(const int key[], int stride);
+
+
+/* Portable kernels */
+static void relax_row_scalar(const int row[], int d, int key[], int pred[], int v, int stride) {
+	for (int u = 0; u < stride; u++) {
+		if (d + row[u] < key[u]) {
+			key[u] = d + row[u];
+			pred[u] = v;
+		}
+	}
+}
+
+static int select_min_scalar(const int key[], int stride) {
+	unsigned int best = (unsigned int)DENSE_SETTLED;
+	int best_index = -1;
+	for (int u = 0; u < stride; u++) {
+		if ((unsigned int)key[u] < best) {
+			best = (unsigned int)key[u];
+			best_index = u;
+		}
+	}
+	return best == DENSE_INF ? -1 : best_index;
+}
+
+#ifdef DENSE_X86_64
+/* Smallest key of the lanes of a select kernel (keys biased by INT_MIN, so signed order is unsigned order), lowest index on a tie */
+static int select_lane(const int best[], const int best_index[], int lanes, const int key[]) {
+	int lowest = 0;
+	for (int lane = 1; lane < lanes; lane++) {
+		if (best[lane] < best[lowest] || (best[lane] == best[lowest] && best_index[lane] < best_index[lowest])) {
+			lowest = lane;
+		}
+	}
+	int index = best_index[lowest];
+	return index == -1 || key[index] == DENSE_INF ? -1 : index;
+}
+
+/* SSE2 kernels: 4 vertices at a time (stride is a multiple of 8). SSE2 has no blend, so select with and / andnot */
+static void relax_row_sse2(const int row[], int d, int key[], int pred[], int v, int stride) {
+	const __m128i d4 = _mm_set1_epi32(d);
+	const __m128i v4 = _mm_set1_epi32(v);
+	for (int u = 0; u < stride; u += 4) {
+		__m128i k = _mm_loadu_si128((const __m128i*)(key + u));
+		__m128i new_key = _mm_add_epi32(d4, _mm_loadu_si128((const __m128i*)(row + u)));
+		__m128i shorter = _mm_cmpgt_epi32(k, new_key);
+		k = _mm_or_si128(_mm_and_si128(shorter, new_key), _mm_andnot_si128(shorter, k));
+		_mm_storeu_si128((__m128i*)(key + u), k);
+		__m128i p = _mm_loadu_si128((const __m128i*)(pred + u));
+		p = _mm_or_si128(_mm_and_si128(shorter, v4), _mm_andnot_si128(shorter, p));
+		_mm_storeu_si128((__m128i*)(pred + u), p);
+	}
+}
+
+static int select_min_sse2(const int key[], int stride) {
+	// SSE2 has no unsigned compare either, so compare keys biased by INT_MIN
+	const __m128i bias = _mm_set1_epi32(INT_MIN);
+	const __m128i step = _mm_set1_epi32(4);
+	__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i best = _mm_set1_epi32(INT_MAX);
+	__m128i best_index = _mm_set1_epi32(-1);
+	for (int u = 0; u < stride; u += 4) {
+		__m128i biased = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(key + u)), bias);
+		__m128i lower = _mm_cmpgt_epi32(best, biased);
+		best = _mm_or_si128(_mm_and_si128(lower, biased), _mm_andnot_si128(lower, best));
+		best_index = _mm_or_si128(_mm_and_si128(lower, index), _mm_andnot_si128(lower, best_index));
+		index = _mm_add_epi32(index, step);
+	}
+
+	int lanes[4];
+	int lane_index[4];
+	_mm_storeu_si128((__m128i*)lanes, best);
+	_mm_storeu_si128((__m128i*)lane_index, best_index);
+	return select_lane(lanes, lane_index, 4, key);
+}
+
+/* AVX2 kernels: 8 vertices at a time */
+DENSE_TARGET_AVX2
+static void relax_row_avx2(const int row[], int d, int key[], int pred[], int v, int stride) {
+	const __m256i d8 = _mm256_set1_epi32(d);
+	const __m256i v8 = _mm256_set1_epi32(v);
+	for (int u = 0; u < stride; u += 8) {
+		__m256i k = _mm256_loadu_si256((const __m256i*)(key + u));
+		__m256i new_key = _mm256_add_epi32(d8, _mm256_loadu_si256((const __m256i*)(row + u)));
+		__m256i shorter = _mm256_cmpgt_epi32(k, new_key);
+		_mm256_storeu_si256((__m256i*)(key + u), _mm256_blendv_epi8(k, new_key, shorter));
+		__m256i p = _mm256_loadu_si256((const __m256i*)(pred + u));
+		_mm256_storeu_si256((__m256i*)(pred + u), _mm256_blendv_epi8(p, v8, shorter));
+	}
+}
+
+DENSE_TARGET_AVX2
+static int select_min_avx2(const int key[], int stride) {
+	const __m256i bias = _mm256_set1_epi32(INT_MIN);
+	const __m256i step = _mm256_set1_epi32(8);
+	__m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i best = _mm256_set1_epi32(INT_MAX);
+	__m256i best_index = _mm256_set1_epi32(-1);
+	for (int u = 0; u < stride; u += 8) {
+		__m256i biased = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(key + u)), bias);
+		__m256i lower = _mm256_cmpgt_epi32(best, biased);
+		best = _mm256_blendv_epi8(best, biased, lower);
+		best_index = _mm256_blendv_epi8(best_index, index, lower);
+		index = _mm256_add_epi32(index, step);
+	}
+
+	int lanes[8];
+	int lane_index[8];
+	_mm256_storeu_si256((__m256i*)lanes, best);
+	_mm256_storeu_si256((__m256i*)lane_index, best_index);
+	return select_lane(lanes, lane_index, 8, key);
+}
+
+/* Ask the CPU (and operating system) if AVX2 is supported */
+static bool query_cpu_avx2() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	// OSXSAVE, and the OS saves the YMM registers
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// AVX2 support of the CPU (-1 until cpu_has_avx2() first asks)
+static int avx2_supported = -1;
+
+/* Check if the CPU (and operating system) supports AVX2 (asked once, every kernel lookup after that reuses it) */
+static bool cpu_has_avx2() {
+	#pragma omp critical(dense_cpu)
+	{
+		if (avx2_supported == -1) {
+			avx2_supported = query_cpu_avx2() ? 1 : 0;
+		}
+	}
+	return avx2_supported == 1;
+}
+#endif
+
+
+/* Set the kernel used by dense_prims_mst(), csr_dense_prims_mst() and dense_dijkstra()
+ * Parameters:
+ *		kind		DenseKernel (default: DENSE_KERNEL_AUTO)
+ * Return: void
+ */
+void set_dense_kernel(DenseKernel kind) {
+	dense_kernel = kind;
+}
+
+/* Get the kernel dense_prims_mst(), csr_dense_prims_mst() and dense_dijkstra() actually run (never DENSE_KERNEL_AUTO)
+ * No parameters
+ * Return: DenseKernel
+ */
+DenseKernel get_dense_kernel() {
+#ifdef DENSE_X86_64
+	if (dense_kernel == DENSE_KERNEL_SCALAR) {
+		return DENSE_KERNEL_SCALAR;
+	}
+	if (dense_kernel != DENSE_KERNEL_SSE2 && cpu_has_avx2()) {
+		return DENSE_KERNEL_AVX2;
+	}
+	return DENSE_KERNEL_SSE2;
+#else
+	return DENSE_KERNEL_SCALAR;
+#endif
+}
+
+/* Name of a dense kernel (for output)
+ * Parameters:
+ *		kind		DenseKernel
+ * Return: "auto", "scalar", "SSE2" or "AVX2"
+ */
+const char* dense_kernel_name(DenseKernel kind) {
+	switch (kind) {
+	case DENSE_KERNEL_SCALAR:
+		return "scalar";
+	case DENSE_KERNEL_SSE2:
+		return "SSE2";
+	case DENSE_KERNEL_AVX2:
+		return "AVX2";
+	default:
+		return "auto";
+	}
+}
+
+/* Relaxation kernel of the kernel get_dense_kernel() picks */
+static RelaxRow relax_row_kernel() {
+	switch (get_dense_kernel()) {
+#ifdef DENSE_X86_64
+	case DENSE_KERNEL_AVX2:
+		return relax_row_avx2;
+	case DENSE_KERNEL_SSE2:
+		return relax_row_sse2;
+#endif
+	default:
+		return relax_row_scalar;
+	}
+}
+
+/* Argmin kernel of the kernel get_dense_kernel() picks */
+static SelectMin select_min_kernel() {
+	switch (get_dense_kernel()) {
+#ifdef DENSE_X86_64
+	case DENSE_KERNEL_AVX2:
+		return select_min_avx2;
+	case DENSE_KERNEL_SSE2:
+		return select_min_sse2;
+#endif
+	default:
+		return select_min_scalar;
+	}
+}
+
+
+/* Check if a CSR graph is dense enough for the O(V^2) searches to be faster than the heap searches
+ *		At most DENSE_MAX_VERTICES vertices, an average degree of at least V / 8, and no path can reach DENSE_INF
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: true / false
+ */
+bool csr_is_dense(CSRGraph* self) {
+	int V = self->V;
+	if (V < DENSE_MIN_VERTICES || V > DENSE_MAX_VERTICES || (long long)self->E * 8 < (long long)V * V) {
+		return false;
+	}
+
+	// A path has at most V - 1 edges, so the longest possible distance must stay below DENSE_INF
+	long long max_weight = 0;
+	for (int e = 0; e < self->E; e++) {
+		if (self->weight[e] < 0) {
+			return false;
+		}
+		if (self->weight[e] > max_weight) {
+			max_weight = self->weight[e];
+		}
+	}
+	return max_weight * (V - 1) < DENSE_INF;
+}
+
+/* Create the adjacency matrix form of a CSR graph (self-loops are left out)
+ *		Every weight must be below DENSE_INF / V (see csr_is_dense())
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: DenseGraph
+ */
+DenseGraph create_dense_graph(CSRGraph* self) {
+	DenseGraph dense;
+	dense.V = self->V;
+	dense.stride = (self->V + 7) / 8 * 8;
+	size_t size = (size_t)dense.V * dense.stride;
+	dense.weight = malloc(sizeof(int) * (size > 0 ? size : 1));
+	STATS_COUNT(STAT_ALLOCATIONS, 1);
+
+	for (size_t n = 0; n < size; n++) {
+		dense.weight[n] = DENSE_INF;
+	}
+	for (int v = 0; v < self->V; v++) {
+		int* row = dense.weight + (size_t)v * dense.stride;
+		for (int e = self->offsets[v]; e < self->offsets[v + 1]; e++) {
+			int u = self->to_vertex[e];
+			if (u != v && self->weight[e] < row[u]) {
+				row[u] = self->weight[e];
+			}
+		}
+	}
+	return dense;
+}
+
+/* Destroy a dense graph (free all memory)
+ * Parameters:
+ *		self		DenseGraph instance
+ * Return: void
+ */
+void destroy_dense_graph(DenseGraph* self) {
+	free(self->weight);
+	self->weight = NULL;
+	self->V = 0;
+	self->stride = 0;
+}
+
+/* Allocate the key and pred arrays of a dense search (keys DENSE_INF, padding settled, no predecessors) */
+static void create_search_arrays(int V, int stride, int** key, int** pred) {
+	int size = stride > 0 ? stride : 1;
+	*key = malloc(sizeof(int) * size);
+	*pred = malloc(sizeof(int) * size);
+	STATS_COUNT(STAT_ALLOCATIONS, 2);
+	for (int u = 0; u < stride; u++) {
+		(*key)[u] = u < V ? DENSE_INF : DENSE_SETTLED;
+		(*pred)[u] = -1;
+	}
+}
+
+/* Prim's minimal spanning tree algorithm on a dense graph, O(V^2) with no priority queue
+ *		Each step relaxes the row of the newest tree vertex, then finds the closest vertex outside the tree in a key
+ *		array (DENSE_INF: not reached, -1: in the tree), both vectorised by the selected kernel
+ *		Same shape as csr_prims_mst(): rooted at the last vertex (a forest if the graph is disconnected)
+ * Parameters:
+ *		self		DenseGraph instance
+ * Return: MST (Graph)
+ */
+Graph dense_prims_mst(DenseGraph* self) {
+	STATS_BEGIN("dense_prims_mst");
+	RelaxRow relax_row = relax_row_kernel();
+	SelectMin select_min = select_min_kernel();
+	Graph MST_G = create_empty_graph(self->V);
+
+	// key: cheapest cost of each vertex outside MST, closest_edge: closest vertex in MST with that cost
+	int* key;
+	int* closest_edge;
+	create_search_arrays(self->V, self->stride, &key, &closest_edge);
+
+	// Start from the last vertex, and start a new tree from the highest vertex not yet in MST whenever
+	// no vertex outside MST is reachable (disconnected graph)
+	int next_root = self->V - 1;
+	int min_index = -1;
+	for (int count = 0; count < self->V; count++) {
+		if (min_index == -1) {
+			while (key[next_root] == DENSE_SETTLED) {
+				next_root--;
+			}
+			min_index = next_root;
+		}
+
+		// Add v to MST (with the edge to its closest vertex in MST, if defined)
+		int cost = key[min_index];
+		key[min_index] = DENSE_SETTLED;
+		if (closest_edge[min_index] != -1) {
+			add_edge(&MST_G, min_index, closest_edge[min_index], cost);
+		}
+
+		// Cheaper edges from v, then the closest vertex outside MST
+		relax_row(self->weight + (size_t)min_index * self->stride, 0, key, closest_edge, min_index, self->stride);
+		min_index = select_min(key, self->stride);
+	}
+
+	free(key);
+	free(closest_edge);
+	STATS_END("dense_prims_mst");
+	return MST_G;
+}
+
+/* Prim's minimal spanning tree algorithm on a dense CSR graph, O(V^2 + E) with no priority queue or matrix
+ *		Edges are relaxed from the CSR rows, and only the search for the closest vertex outside the tree is
+ *		vectorised (as dense_prims_mst()), so a single MST does not pay for building the matrix
+ *		Same shape as csr_prims_mst(): rooted at the last vertex (a forest if the graph is disconnected)
+ * Parameters:
+ *		self		CSRGraph instance (weights below DENSE_INF, see csr_is_dense())
+ * Return: MST (Graph)
+ */
+Graph csr_dense_prims_mst(CSRGraph* self) {
+	STATS_BEGIN("dense_prims_mst");
+	SelectMin select_min = select_min_kernel();
+	Graph MST_G = create_empty_graph(self->V);
+	int stride = (self->V + 7) / 8 * 8;
+
+	// key: cheapest cost of each vertex outside MST, closest_edge: closest vertex in MST with that cost
+	int* key;
+	int* closest_edge;
+	create_search_arrays(self->V, stride, &key, &closest_edge);
+
+	int next_root = self->V - 1;
+	int min_index = -1;
+	for (int count = 0; count < self->V; count++) {
+		if (min_index == -1) {
+			while (key[next_root] == DENSE_SETTLED) {
+				next_root--;
+			}
+			min_index = next_root;
+		}
+
+		int cost = key[min_index];
+		key[min_index] = DENSE_SETTLED;
+		if (closest_edge[min_index] != -1) {
+			add_edge(&MST_G, min_index, closest_edge[min_index], cost);
+		}
+
+		// Cheaper edges from v (a settled key is -1, so no edge to MST, or self-loop, is below it)
+		for (int e = self->offsets[min_index]; e < self->offsets[min_index + 1]; e++) {
+			int considered_v = self->to_vertex[e];
+			if (self->weight[e] < key[considered_v]) {
+				key[considered_v] = self->weight[e];
+				closest_edge[considered_v] = min_index;
+			}
+		}
+		min_index = select_min(key, stride);
+	}
+
+	free(key);
+	free(closest_edge);
+	STATS_END("dense_prims_mst");
+	return MST_G;
+}
+
+/* Dijkstra's algorithm on a dense graph, O(V^2) with no priority queue (same kernels as dense_prims_mst())
+ *		Stops as soon as the destination is visited
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			DenseGraph instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (INT_MAX if unreachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc)
+ * Return: linked list of vertices in the path
+ */
+EdgeList dense_dijkstra(DenseGraph* self, int source, int destination, int* distance, Arena* arena) {
+	RelaxRow relax_row = relax_row_kernel();
+	SelectMin select_min = select_min_kernel();
+	STATS_LOCAL(n_settled);
+
+	// key: distance from source of each unvisited vertex, pred_v: predecessor on that path
+	int* key;
+	int* pred_v;
+	create_search_arrays(self->V, self->stride, &key, &pred_v);
+
+	int shortest = INT_MAX;
+	key[source] = 0;
+	int min_index = source;
+	while (min_index != -1) {
+		// Distance to the closest unvisited vertex is final
+		int d = key[min_index];
+		key[min_index] = DENSE_SETTLED;
+		STATS_INC(n_settled);
+		if (min_index == destination) {
+			shortest = d;
+			break;
+		}
+
+		relax_row(self->weight + (size_t)min_index * self->stride, d, key, pred_v, min_index, self->stride);
+		min_index = select_min(key, self->stride);
+	}
+
+	if (distance != NULL) {
+		*distance = shortest;
+	}
+
+	// Unreachable destination: no predecessor, so the path is only the destination (as csr_dijkstra())
+	EdgeList path = trace_path(pred_v, destination, arena);
+	free(key);
+	free(pred_v);
+
+	STATS_COUNT(STAT_SEARCHES, 1);
+	STATS_COUNT(STAT_SETTLED, n_settled);
+	STATS_COUNT(STAT_RELAXED, n_settled * self->V);
+	return path;
+}
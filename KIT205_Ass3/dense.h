@@ -0,0 +1,123 @@
+#ifndef DENSE_H
+#define DENSE_H
+
+#include <stdbool.h>
+#include "arena.h"
+#include "graph.h"
+
+// Weight of a missing edge in a DenseGraph (a distance plus this never overflows an int)
+#define DENSE_INF 0x3FFFFFFF
+
+// Largest map csr_is_dense() accepts (the matrix has V * V entries)
+#define DENSE_MAX_VERTICES 4096
+
+/* Kernels of the dense-matrix searches
+ *		DENSE_KERNEL_AUTO		fastest kernel the CPU supports (checked once, at run time)
+ *		DENSE_KERNEL_SCALAR		portable C loop
+ *		DENSE_KERNEL_SSE2		4 vertices per instruction (every x86-64 CPU)
+ *		DENSE_KERNEL_AVX2		8 vertices per instruction
+ *		A kernel that is not built for (or not supported by) the CPU falls back to the next slower one
+ */
+typedef enum denseKernel {
+	DENSE_KERNEL_AUTO,
+	DENSE_KERNEL_SCALAR,
+	DENSE_KERNEL_SSE2,
+	DENSE_KERNEL_AVX2
+} DenseKernel;
+
+/* Adjacency matrix form of a graph, for maps with edges between most pairs of cities
+ *		weight[v * stride + u] is the weight of edge vu (the lightest one, DENSE_INF if there is none)
+ *		stride is V rounded up to a multiple of 8, so every row is a whole number of AVX2 vectors
+ *		(the padding entries are DENSE_INF too)
+ */
+typedef struct denseGraph {
+	int V;
+	int stride;
+	int* weight;
+} DenseGraph;
+
+
+/* Set the kernel used by dense_prims_mst(), csr_dense_prims_mst() and dense_dijkstra()
+ * Parameters:
+ *		kind		DenseKernel (default: DENSE_KERNEL_AUTO)
+ * Return: void
+ */
+void set_dense_kernel(DenseKernel kind);
+
+
+/* Get the kernel dense_prims_mst(), csr_dense_prims_mst() and dense_dijkstra() actually run (never DENSE_KERNEL_AUTO)
+ * No parameters
+ * Return: DenseKernel
+ */
+DenseKernel get_dense_kernel();
+
+
+/* Name of a dense kernel (for output)
+ * Parameters:
+ *		kind		DenseKernel
+ * Return: "auto", "scalar", "SSE2" or "AVX2"
+ */
+const char* dense_kernel_name(DenseKernel kind);
+
+
+/* Check if a CSR graph is dense enough for the O(V^2) searches to be faster than the heap searches
+ *		At most DENSE_MAX_VERTICES vertices, an average degree of at least V / 8, and no path can reach DENSE_INF
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: true / false
+ */
+bool csr_is_dense(CSRGraph* self);
+
+
+/* Create the adjacency matrix form of a CSR graph (self-loops are left out)
+ *		Every weight must be below DENSE_INF / V (see csr_is_dense())
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: DenseGraph
+ */
+DenseGraph create_dense_graph(CSRGraph* self);
+
+
+/* Destroy a dense graph (free all memory)
+ * Parameters:
+ *		self		DenseGraph instance
+ * Return: void
+ */
+void destroy_dense_graph(DenseGraph* self);
+
+
+/* Prim's minimal spanning tree algorithm on a dense graph, O(V^2) with no priority queue
+ *		Each step relaxes the row of the newest tree vertex, then finds the closest vertex outside the tree in a key
+ *		array (DENSE_INF: not reached, -1: in the tree), both vectorised by the selected kernel
+ *		Same shape as csr_prims_mst(): rooted at the last vertex (a forest if the graph is disconnected)
+ * Parameters:
+ *		self		DenseGraph instance
+ * Return: MST (Graph)
+ */
+Graph dense_prims_mst(DenseGraph* self);
+
+
+/* Prim's minimal spanning tree algorithm on a dense CSR graph, O(V^2 + E) with no priority queue or matrix
+ *		Edges are relaxed from the CSR rows, and only the search for the closest vertex outside the tree is
+ *		vectorised (as dense_prims_mst()), so a single MST does not pay for building the matrix
+ *		Same shape as csr_prims_mst(): rooted at the last vertex (a forest if the graph is disconnected)
+ * Parameters:
+ *		self		CSRGraph instance (weights below DENSE_INF, see csr_is_dense())
+ * Return: MST (Graph)
+ */
+Graph csr_dense_prims_mst(CSRGraph* self);
+
+
+/* Dijkstra's algorithm on a dense graph, O(V^2) with no priority queue (same kernels as dense_prims_mst())
+ *		Stops as soon as the destination is visited
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			DenseGraph instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (INT_MAX if unreachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc)
+ * Return: linked list of vertices in the path
+ */
+EdgeList dense_dijkstra(DenseGraph* self, int source, int destination, int* distance, Arena* arena);
+#endif
@@ -1,7 +1,118 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
 #include "graph.h"
+#include "routesearch.h"
+#include "pqueue.h"
+#include "parser.h"
+#include "mapfile.h"
+#include "stats.h"
+#include "workspace.h"
+
+
+/* Edge index (open-addressing hash on (from-vertex, to-vertex)) -------- */
+
+// Capacity of a new edge index (grows as edges are added)
+#define INITIAL_INDEX_CAPACITY 64
+
+/* Create an edge index that is not built yet */
+static EdgeIndex create_edge_index(void) {
+	EdgeIndex index = { NULL, NULL, 0, 0 };
+	return index;
+}
+
+/* Key and first slot of edge (from_vertex, to_vertex) */
+static uint64_t index_key(int from_vertex, int to_vertex) {
+	return ((uint64_t)(uint32_t)from_vertex << 32) | (uint32_t)to_vertex;
+}
+
+static size_t index_slot(EdgeIndex* index, uint64_t key) {
+	return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (index->capacity - 1);
+}
+
+/* Put an edge node in the index (replacing an older edge with the same vertices, as lookups found the newest edge first) */
+static void index_put(EdgeIndex* index, uint64_t key, EdgeNodePtr node) {
+	size_t slot = index_slot(index, key);
+	while (index->nodes[slot] != NULL && index->keys[slot] != key) {
+		slot = (slot + 1) & (index->capacity - 1);
+	}
+	if (index->nodes[slot] == NULL) {
+		index->count++;
+	}
+	index->keys[slot] = key;
+	index->nodes[slot] = node;
+}
+
+/* Add an edge node to the index (if built), doubling its capacity when half full */
+static void index_insert(EdgeIndex* index, int from_vertex, EdgeNodePtr node) {
+	if (index->nodes == NULL) {
+		return;
+	}
+	if ((index->count + 1) * 2 > index->capacity) {
+		EdgeIndex old = *index;
+		index->capacity *= 2;
+		index->count = 0;
+		index->keys = malloc(sizeof(uint64_t) * index->capacity);
+		index->nodes = calloc(index->capacity, sizeof(EdgeNodePtr));
+		for (size_t i = 0; i < old.capacity; i++) {
+			if (old.nodes[i] != NULL) {
+				index_put(index, old.keys[i], old.nodes[i]);
+			}
+		}
+		free(old.keys);
+		free(old.nodes);
+	}
+	index_put(index, index_key(from_vertex, node->edge.to_vertex), node);
+}
+
+/* Build the index of a graph from its edge lists (oldest edges first, so the newest of duplicates wins) */
+static void build_edge_index(Graph* self) {
+	EdgeIndex* index = &self->index;
+	index->capacity = INITIAL_INDEX_CAPACITY;
+	index->count = 0;
+	index->keys = malloc(sizeof(uint64_t) * index->capacity);
+	index->nodes = calloc(index->capacity, sizeof(EdgeNodePtr));
+
+	EdgeNodePtr* stack = NULL;
+	int stack_size = 0;
+	for (int v = 0; v < self->V; v++) {
+		int degree = 0;
+		for (EdgeNodePtr current = self->edges[v].head; current != NULL; current = current->next) {
+			if (degree == stack_size) {
+				stack_size = stack_size > 0 ? stack_size * 2 : 16;
+				stack = realloc(stack, sizeof(EdgeNodePtr) * stack_size);
+			}
+			stack[degree++] = current;
+		}
+		while (degree > 0) {
+			index_insert(index, v, stack[--degree]);
+		}
+	}
+	free(stack);
+}
+
+/* Find the edge node of edge (from_vertex, to_vertex)
+ *		The index is built on the first lookup (graphs that are only built and walked, like MSTs, never pay for it)
+ * Return: EdgeNodePtr, NULL if edge does not exist
+ */
+static EdgeNodePtr index_find(Graph* self, int from_vertex, int to_vertex) {
+	EdgeIndex* index = &self->index;
+	if (index->nodes == NULL) {
+		build_edge_index(self);
+	}
+
+	uint64_t key = index_key(from_vertex, to_vertex);
+	size_t slot = index_slot(index, key);
+	while (index->nodes[slot] != NULL) {
+		if (index->keys[slot] == key) {
+			return index->nodes[slot];
+		}
+		slot = (slot + 1) & (index->capacity - 1);
+	}
+	return NULL;
+}
 
 
 /* Add a new directed edge to a graph -----------------------------
@@ -22,35 +133,67 @@ void add_edge(Graph* self, int from_vertex, int to_vertex, int weight) {
 		fprintf(stderr, "To-vertex %d is invalid\n", to_vertex);
 	}
 
-	// Initialise edge node
-	EdgeNodePtr node = malloc(sizeof * node);
+	// Initialise edge node (from the graph's arena)
+	EdgeNodePtr node = arena_alloc(self->arena, sizeof * node);
 	node->edge.to_vertex = to_vertex;
 	node->edge.weight = weight;
 
 	// Insert edge node at front of existing list
 	node->next = self->edges[from_vertex].head;
 	self->edges[from_vertex].head = node;
+	index_insert(&self->index, from_vertex, node);
 }
 
 /* Create a graph (Read inputs) -------------------------------------
- * No parameters
- * Return: Graph
+ * Parameters:
+ *		input		Parser positioned at the start of the map
+ * Return: Graph (empty graph, with input->failed set, if the map is malformed)
  */
-Graph create_graph() {
-	Graph G;
+Graph create_graph(Parser* input) {
+	int V;
+	if (!parse_int(input, &V, "number of vertices") || V < 1) {
+		parser_error(input, "number of vertices must be at least 1");
+		return create_empty_graph(0);
+	}
 
-	scanf_s("%d", &G.V);
+	Graph G;
+	G.V = V;
 	G.edges = malloc(sizeof(G.edges) * G.V);
+	G.arena = create_arena(4096);
+	G.index = create_edge_index();
 	//printf("%d\n", G.V);
 
 	for (int v = 0; v < G.V; v++) {
 		G.edges[v].head = NULL;
+	}
 
+	for (int v = 0; v < G.V && !input->failed; v++) {
 		int n_vertices;
-		scanf_s("%d", &n_vertices);
-		for (int e = 0; e < n_vertices; e++) {
-			EdgeNodePtr node = malloc(sizeof(*node)); // *node ~ edgeNode
-			scanf_s("%d,%d", &node->edge.to_vertex, &node->edge.weight);
+		if (!parse_int(input, &n_vertices, "number of edges")) {
+			break;
+		}
+		if (n_vertices < 0) {
+			parser_error(input, "number of edges cannot be negative");
+			break;
+		}
+
+		for (int e = 0; e < n_vertices && !input->failed; e++) {
+			int to_vertex, weight;
+			if (!parse_pair(input, &to_vertex, &weight, "edge \"to,weight\"")) {
+				break;
+			}
+			if (to_vertex <= v || to_vertex >= G.V) {
+				parser_error(input, "edge must go to a vertex with a higher index (and less than number of vertices)");
+				break;
+			}
+			if (weight < 0) {
+				parser_error(input, "edge weight cannot be negative");
+				break;
+			}
+
+			EdgeNodePtr node = arena_alloc(G.arena, sizeof(*node)); // *node ~ edgeNode
+			node->edge.to_vertex = to_vertex;
+			node->edge.weight = weight;
 
 			// Insert at front
 			node->next = G.edges[v].head;
@@ -58,6 +201,11 @@ Graph create_graph() {
 		}
 	}
 
+	if (input->failed) {
+		destroy_graph(&G);
+		return create_empty_graph(0);
+	}
+
 	/* Add edges in other direction - To form undirected graph 
 	*		(input only include edges from lower from-vertices to higher to-vertices)
 	*/
@@ -75,22 +223,17 @@ Graph create_graph() {
 }
 
 /* Destroy a graph (free all memory) ------------------------------
+ *		Edge nodes are freed in bulk with the graph's arena
  * Parameters:
  *		self    Graph instance
  * Return: void
  */
 void destroy_graph(Graph* self) {
-	for (int v = 0; v < self->V; v++) {
-		EdgeNodePtr current = self->edges[v].head;
-
-		while (current != NULL) {
-			EdgeNodePtr to_free = current;
-			current = current->next;
-			free(to_free);
-		}
-	}
-
+	// Edge nodes all live in the arena
+	destroy_arena(self->arena);
 	free(self->edges);
+	free(self->index.keys);
+	free(self->index.nodes);
 }
 
 
@@ -142,95 +285,175 @@ void print_in_degrees(Graph* self) {
 }
 
 
+/* Create an empty graph (all vertices, but no edges)
+ * Parameters:
+ *		V			number of vertices
+ * Return: Graph
+ */
+Graph create_empty_graph(int V) {
+	Graph G;
+	G.V = V;
+	G.edges = malloc(sizeof(G.edges) * G.V);
+	G.arena = create_arena(sizeof(struct edgeNode) * (V > 16 ? V : 16));
+	G.index = create_edge_index();
+	for (int v = 0; v < G.V; v++) {
+		G.edges[v].head = NULL;
+	}
+	return G;
+}
+
+
+/* Create a compressed sparse row (CSR) copy of a graph ---------------
+ *		Edges of each vertex are stored contiguously, sorted by to-vertex
+ * Parameters:
+ *		self		Graph instance
+ * Return: CSRGraph
+ */
+CSRGraph create_csr_graph(Graph* self) {
+	CSRGraph G;
+	G.V = self->V;
+	G.mapping = NULL;
+	G.mapping_length = 0;
+	G.n_landmarks = 0;
+	G.landmark_dist = NULL;
+	G.offsets = malloc(sizeof(int) * (G.V + 1));
+
+	// Count edges of each vertex --> offsets
+	G.offsets[0] = 0;
+	for (int v = 0; v < G.V; v++) {
+		int degree = 0;
+		EdgeNodePtr current = self->edges[v].head;
+		while (current != NULL) {
+			degree++;
+			current = current->next;
+		}
+		G.offsets[v + 1] = G.offsets[v] + degree;
+	}
+	G.E = G.offsets[G.V];
+
+	G.to_vertex = malloc(sizeof(int) * G.E);
+	G.weight = malloc(sizeof(int) * G.E);
+
+	// Copy edges of each vertex, keeping them sorted by to-vertex (insertion sort, lists are short)
+	for (int v = 0; v < G.V; v++) {
+		int end = G.offsets[v];
+		EdgeNodePtr current = self->edges[v].head;
+		while (current != NULL) {
+			int i = end;
+			while (i > G.offsets[v] && G.to_vertex[i - 1] > current->edge.to_vertex) {
+				G.to_vertex[i] = G.to_vertex[i - 1];
+				G.weight[i] = G.weight[i - 1];
+				i--;
+			}
+			G.to_vertex[i] = current->edge.to_vertex;
+			G.weight[i] = current->edge.weight;
+			end++;
+			current = current->next;
+		}
+	}
+
+	return G;
+}
+
+/* Destroy a CSR graph (free all memory) ------------------------------
+ * Parameters:
+ *		self    CSRGraph instance
+ * Return: void
+ */
+void destroy_csr_graph(CSRGraph* self) {
+	free(self->landmark_dist);
+	if (self->mapping != NULL) {
+		unmap_file(self->mapping, self->mapping_length);
+		return;
+	}
+	free(self->offsets);
+	free(self->to_vertex);
+	free(self->weight);
+}
+
+
 /* Run Prim's minimal spanning tree algorithm on graph ---------------
  * Parameters
  *		self		Graph instance
  * Return: MST (Graph)
  */
 Graph prims_mst(Graph* self) {
-	// Initialise graph with all vertices (but no edges)
-	Graph MST_G;
-	MST_G.V = self->V;
-	MST_G.edges = malloc(sizeof(MST_G.edges) * MST_G.V);
-	for (int v = 0; v < MST_G.V; v++) {
-		MST_G.edges[v].head = NULL;
-	}
+	CSRGraph csr = create_csr_graph(self);
+	Graph MST_G = csr_prims_mst(&csr);
+	destroy_csr_graph(&csr);
+	return MST_G;
+}
 
-	// Array to keep track of cheapest cost for each vertex
-	//		Initially, all are +infinity distance (none are in MST, so infinite distance away)
-	int* cheapest_cost = malloc(sizeof(int) * MST_G.V);
-	
-	// Array to keep track of closest edge (to-vertices) with cheapest cost
-	//		Initially, all are +infinity (none are in MST)
-	int* closest_edge = malloc(sizeof(int) * MST_G.V);
-	
-	// Array to keep track of vertices that are in MST 
-	//		Initially, all are false (none are in MST)
-	bool* inMST = malloc(sizeof(bool) * MST_G.V);
+/* Run Prim's minimal spanning tree algorithm on a CSR graph ----------
+ *		Arrays and queue are the calling thread's workspace (nothing allocated or cleared per call)
+ * Parameters
+ *		self		CSRGraph instance
+ * Return: MST (Graph)
+ */
+Graph csr_prims_mst(CSRGraph* self) {
+	STATS_BEGIN("prims_mst");
 
-	// Initialise values of closest and inMST
-	for (int i = 0; i < MST_G.V; i++) {
-		cheapest_cost[i] = INT_MAX;
-		closest_edge[i] = INT_MAX;
-		inMST[i] = false;
-	}
+	// Initialise graph with all vertices (but no edges)
+	Graph MST_G = create_empty_graph(self->V);
+
+	// Arrays of the thread's workspace (nothing to allocate or clear)
+	//		dist: cheapest cost of each vertex, initially +infinity (none are in MST, so infinite distance away)
+	//		pred_v: closest vertex in MST with that cost, initially -1 (none)
+	//		settled (mark): vertices that are in MST, initially none
+	Workspace* ws = borrow_workspace(self->V);
+	unsigned int* mark = ws->mark;
+	unsigned int epoch = ws->epoch;
+	int* dist = ws->dist;
+	int* pred_v = ws->pred_v;
+	int* cheapest_cost = dist;
+	int* closest_edge = pred_v;
+	PQueue* queue = &ws->queue;
 
 	// Since graph has V vertices, need to iterate V times to add all vertices to MST 
+	//		Start from the last vertex (each other vertex then has exactly 1 edge, to its parent)
+	int next_root = MST_G.V - 1;
 	for (int count = 0; count < MST_G.V ; count++) {
-		// Find min C[v] in vertices outside MST --> vertex v (min_index)
-		int min = INT_MAX;
-		int min_index = 0;
-		for (int v = 0; v < MST_G.V; v++) {
-			if (cheapest_cost[v] <= min && inMST[v] == false) {
-				min = cheapest_cost[v];
-				min_index = v;
+		// Queue empty --> start a new tree from the highest vertex not yet in MST (disconnected graph)
+		if (pq_is_empty(queue)) {
+			while (WS_SETTLED(next_root)) {
+				next_root--;
 			}
+			WS_TOUCH(next_root);
+			pq_insert(queue, next_root, INT_MAX);
 		}
 
+		// Find min C[v] in vertices outside MST --> vertex v (min_index)
+		int min_index = pq_pop_min(queue, NULL);
+
 		// Add v to MST
-		inMST[min_index] = true;
+		WS_SETTLE(min_index);
 
 		// Add edge to MST if closest edge is defined
-		if (closest_edge[min_index] != INT_MAX) {
+		if (closest_edge[min_index] != -1) {
 			add_edge(&MST_G, min_index, closest_edge[min_index], cheapest_cost[min_index]);
 		}
 
 		// Loop through edges from chosen v (with min_index)
 		// If not in MST and edge has smaller weight, change values in arrays
-		EdgeNodePtr current = self->edges[min_index].head;
-		while (current != NULL) {
-			int considered_v = current->edge.to_vertex;
-			if (inMST[considered_v] == false && current->edge.weight < cheapest_cost[considered_v]) {
+		for (int e = self->offsets[min_index]; e < self->offsets[min_index + 1]; e++) {
+			int considered_v = self->to_vertex[e];
+			WS_TOUCH(considered_v);
+			if (!WS_SETTLED(considered_v) && self->weight[e] < cheapest_cost[considered_v]) {
 			// if considered_v is not in MST && weight < cheapest cost
-				cheapest_cost[considered_v] = current->edge.weight;
+				cheapest_cost[considered_v] = self->weight[e];
 				closest_edge[considered_v] = min_index;
 
+				if (pq_contains(queue, considered_v)) {
+					pq_decrease_key(queue, considered_v, self->weight[e]);
+				}
+				else {
+					pq_insert(queue, considered_v, self->weight[e]);
+				}
 			}
-			current = current->next;
-		}
-
-		// FOR TESTING -----------------------------
-		/*
-		for (int i = 0; i < MST_G.V; i++) {
-			printf("%d, ", cheapest_cost[i]);
-		}
-		printf("\n");
-		for (int i = 0; i < MST_G.V; i++) {
-			printf("%d, ", closest_edge[i]);
 		}
-		printf("\n");
-		for (int i = 0; i < MST_G.V; i++) {
-			printf("%d, ", inMST[i]);
-		}
-		printf("\n\n");
-		*/
 	}
 
-	/* Free Memory of dynamic arrays */
-	free(cheapest_cost);
-	free(closest_edge);
-	free(inMST);
-
+	STATS_END("prims_mst");
 	return MST_G;
 }
 
@@ -252,108 +475,299 @@ int graph_weight(Graph* self) {
 	return total_weight;
 }
 
+/* Calculate total weight of a CSR graph (each undirected edge counted once)
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: total weight of graph
+ */
+int csr_graph_weight(CSRGraph* self) {
+	int total_weight = 0;
+	for (int e = 0; e < self->E; e++) {
+		total_weight += self->weight[e];
+	}
+
+	return total_weight / 2;
+}
+
+
+/* Trace path from a vertex back to the start of its search --> form a linked list of vertices (EdgeNode) with weight = 0
+ * Parameters:
+ *		pred_v[]		predecessor of each vertex (-1 for the start of the search)
+ *		v				last vertex of the path (-1 for an empty path)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path
+ */
+EdgeList trace_path(int pred_v[], int v, Arena* arena) {
+	EdgeList path;
+	path.head = NULL;
+	STATS_LOCAL(n_nodes);
+
+	// Since the source vertex has -1 as predecessor 
+	while (v != -1) {
+		// Create new node 
+		EdgeNodePtr node = arena != NULL ? arena_alloc(arena, sizeof * node) : malloc(sizeof * node);
+		STATS_INC(n_nodes);
+		node->edge.to_vertex = v;
+		node->edge.weight = 0;
+
+		// Insert at front of path
+		node->next = path.head;
+		path.head = node;
+
+		// Set v to predecessor 
+		v = pred_v[v];
+	}
+
+	if (arena == NULL) {
+		STATS_COUNT(STAT_ALLOCATIONS, n_nodes);
+	}
+	return path;
+}
 
 /* Dijkstra's algorithm 
  *		Return shortest path from source to destination from a graph
- *		Also change value of pre-created distance and dist_array (passed by reference)
+ *		Also change value of pre-created distance (passed by reference)
  * Parameters:
  *		self			Graph instance
  *		source			source vertex
  *		destination		destination vertex
  *		distance		pointer to variable storing distance of the shortest path from source to destination
- *		dist_array		array of shortest distance for other vertices from source
  * Return: linked list of vertices in the path
  */
 EdgeList dijkstra(Graph* self, int source, int destination, int* distance) {
-	// Array to keep track of shortest distance from source --> vertex u
-	//		Initially, all are +infinity (none are visited to determine shortest distance)
-	int* dist = malloc(sizeof(int) * self->V);
-	
-	// Array to keey track of visited vertices
-	//		Initially, all false (none are visited)
-	bool* visited = malloc(sizeof(bool) * self->V);
-
-	// Array to keep track of predecessor vertex of each vertex (closest previous vertex)
-	//		Initially, all are -1 (no predecessors found yet)
-	int* pred_v = malloc(sizeof(int) * self->V);
+	CSRGraph csr = create_csr_graph(self);
+	EdgeList path = csr_dijkstra(&csr, source, destination, distance, NULL);
+	destroy_csr_graph(&csr);
+	return path;
+}
 
-	// Initialise arrays
-	for (int v = 0; v < self->V; v++) {
-		dist[v] = INT_MAX;
-		visited[v] = false;
-		pred_v[v] = -1;
-	}
+/* Dijkstra's search from a source vertex, until destination is visited (-1 for the whole shortest path tree)
+ *		Return the thread's workspace holding dist and pred_v of every vertex reached (final for every visited vertex)
+ */
+static Workspace* csr_search(CSRGraph* self, int source, int destination) {
+	// Arrays of the thread's workspace: only vertices reached by this search are set (WS_TOUCH())
+	//		dist: shortest distance from source, pred_v: predecessor on that path, settled (mark): visited vertices
+	Workspace* ws = borrow_workspace(self->V);
+	unsigned int* mark = ws->mark;
+	unsigned int epoch = ws->epoch;
+	int* dist = ws->dist;
+	int* pred_v = ws->pred_v;
+	PQueue* queue = &ws->queue;
+	STATS_LOCAL(n_settled);
+	STATS_LOCAL(n_relaxed);
 
 	// Distance from source -> source = 0
+	WS_TOUCH(source);
 	dist[source] = 0;
 
-	// Looping until all vertices have been visited
-	for (int count = 0; count < self->V; count++) {
+	// Priority queue of reached but unvisited vertices, keyed by distance
+	pq_insert(queue, source, 0);
+
+	// Looping until all reachable vertices (or the destination) have been visited
+	while (!pq_is_empty(queue)) {
 		// Find unvisited vertex with shortest distance 
-		int min = INT_MAX;
-		int min_index = 0;
-		for (int v = 0; v < self->V; v++) {
-			if (visited[v] == false && dist[v] < min) {
-				min = dist[v];
-				min_index = v;
-			}
+		int min_index = pq_pop_min(queue, NULL);
+
+		// Distance to the destination is final once it is visited
+		if (min_index == destination) {
+			break;
 		}
 
 		// Mark this vertex as visited
-		visited[min_index] = true;
+		WS_SETTLE(min_index);
+		STATS_INC(n_settled);
 
 		// Loop through edges from chosen v (with min_index)
 		// If not visited and d[u] + d[uv] < current d[u], change values in arrays
-		EdgeNodePtr current = self->edges[min_index].head;
-		while (current != NULL) {
-			int considered_v = current->edge.to_vertex;
-			if (visited[considered_v] == false && dist[min_index] + current->edge.weight < dist[considered_v]) {
-				dist[considered_v] = dist[min_index] + current->edge.weight;
+		for (int e = self->offsets[min_index]; e < self->offsets[min_index + 1]; e++) {
+			int considered_v = self->to_vertex[e];
+			STATS_INC(n_relaxed);
+			WS_TOUCH(considered_v);
+			if (!WS_SETTLED(considered_v) && dist[min_index] + self->weight[e] < dist[considered_v]) {
+				dist[considered_v] = dist[min_index] + self->weight[e];
 				pred_v[considered_v] = min_index;
+
+				if (pq_contains(queue, considered_v)) {
+					pq_decrease_key(queue, considered_v, dist[considered_v]);
+				}
+				else {
+					pq_insert(queue, considered_v, dist[considered_v]);
+				}
 			}
-			current = current->next;
 		}
 	}
 
+	STATS_COUNT(STAT_SEARCHES, 1);
+	STATS_COUNT(STAT_SETTLED, n_settled);
+	STATS_COUNT(STAT_RELAXED, n_relaxed);
+	return ws;
+}
+
+/* Dijkstra's algorithm on a CSR graph
+ *		Return shortest path from source to destination from a graph
+ *		Stops as soon as the destination is visited (its distance is final then)
+ *		Nothing is allocated or cleared per call: the search uses the calling thread's workspace
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			CSRGraph instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path from source to destination
+ *		arena			Arena to allocate path nodes from (NULL to use malloc)
+ * Return: linked list of vertices in the path
+ */
+EdgeList csr_dijkstra(CSRGraph* self, int source, int destination, int* distance, Arena* arena) {
+	Workspace* ws = csr_search(self, source, destination);
+	unsigned int* mark = ws->mark;
+	unsigned int epoch = ws->epoch;
+	int* dist = ws->dist;
+	int* pred_v = ws->pred_v;
+
+	// Unreachable destination: distance +infinity, no predecessor
+	WS_TOUCH(destination);
+
 	// Pass shortest distance from source to target to a pointer (to manipulate value outside the function)
 	//		distance must be initialised before executing function to be changed
 	if (distance != NULL) {
 		*distance = dist[destination];
 	}
 
-	// Trace path from destination back to source --> form a linked list of vertices (EdgeNode) with weight = 0
-	EdgeList path;
-	path.head = NULL;
-	int v = destination;
+	// Trace path from destination back to source (every vertex on it was reached by this search)
+	return trace_path(pred_v, destination, arena);
+}
 
-	// Since the source vertex has -1 as predecessor 
-	while (v != -1) {
-		// Create new node 
-		EdgeNodePtr node = malloc(sizeof * node);
-		node->edge.to_vertex = v;
-		node->edge.weight = 0;
+/* Dijkstra's shortest path tree from a source vertex (CSR graph)
+ *		Change values of pre-created dist and pred_v arrays (V entries each)
+ * Parameters:
+ *		self			CSRGraph instance
+ *		source			source vertex
+ *		dist[]			array storing shortest distance from source to each vertex (INT_MAX if unreachable)
+ *		pred_v[]		array storing predecessor of each vertex on its shortest path (-1 for source / unreachable)
+ * Return: void
+ */
+void csr_shortest_path_tree(CSRGraph* self, int source, int dist[], int pred_v[]) {
+	Workspace* ws = csr_search(self, source, -1);
+	unsigned int* mark = ws->mark;
+	unsigned int epoch = ws->epoch;
+	for (int v = 0; v < self->V; v++) {
+		dist[v] = WS_REACHED(v) ? ws->dist[v] : INT_MAX;
+		pred_v[v] = WS_REACHED(v) ? ws->pred_v[v] : -1;
+	}
+}
 
-		// Insert at front of path
-		node->next = path.head;
-		path.head = node;
 
-		// Set v to predecessor 
-		v = pred_v[v];
-	}
+/* Multi-source Dijkstra's algorithm
+ *		Return shortest path from any source vertex to the closest target vertex
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			Graph instance
+ *		sources[]		sources[v] is true if v is a source vertex
+ *		targets[]		targets[v] is true if v is a target vertex
+ *		distance		pointer to variable storing distance of the shortest path (INT_MAX if no target is reachable)
+ * Return: linked list of vertices in the path (empty if no target is reachable)
+ */
+EdgeList multi_source_dijkstra(Graph* self, bool sources[], bool targets[], int* distance) {
+	CSRGraph csr = create_csr_graph(self);
+	EdgeList path = csr_multi_source_dijkstra(&csr, sources, targets, distance, NULL);
+	destroy_csr_graph(&csr);
+	return path;
+}
 
-	/* Printing output - FOR TESTING */
-	/*
+/* Multi-source Dijkstra's algorithm on a CSR graph
+ *		Search from every source vertex at once (all start at distance 0) and stop at the first target settled
+ *		Searches in the calling thread's workspace, so a call only touches the vertices it reaches
+ *		Return shortest path from the closest source to the closest target
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			CSRGraph instance
+ *		sources[]		sources[v] is true if v is a source vertex
+ *		targets[]		targets[v] is true if v is a target vertex
+ *		distance		pointer to variable storing distance of the shortest path (INT_MAX if no target is reachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc)
+ * Return: linked list of vertices in the path (empty if no target is reachable)
+ */
+EdgeList csr_multi_source_dijkstra(CSRGraph* self, bool sources[], bool targets[], int* distance, Arena* arena) {
+	// Same workspace arrays as csr_dijkstra(), but every source starts at distance 0
+	Workspace* ws = borrow_workspace(self->V);
+	unsigned int* mark = ws->mark;
+	unsigned int epoch = ws->epoch;
+	int* dist = ws->dist;
+	int* pred_v = ws->pred_v;
+	PQueue* queue = &ws->queue;
+	STATS_LOCAL(n_settled);
+	STATS_LOCAL(n_relaxed);
+
+	// Priority queue of reached but unvisited vertices, keyed by distance
 	for (int v = 0; v < self->V; v++) {
-		printf("%d(%d)[%d], ", v, dist[v], pred_v[v]);
+		if (sources[v]) {
+			WS_TOUCH(v);
+			dist[v] = 0;
+			pq_insert(queue, v, 0);
+		}
 	}
-	*/
 
-	/* Free memory for dynamic arrays */
-	free(dist);
-	free(visited);
-	free(pred_v);
+	// Looping until the closest target is visited (or nothing reachable is left)
+	int closest_v = -1;
+	while (!pq_is_empty(queue)) {
+		// Find unvisited vertex with shortest distance
+		int min_index = pq_pop_min(queue, NULL);
 
-	return path;
+		// First target visited is the closest one to any source
+		if (targets[min_index]) {
+			closest_v = min_index;
+			break;
+		}
+
+		// Mark this vertex as visited
+		WS_SETTLE(min_index);
+		STATS_INC(n_settled);
+
+		// Loop through edges from chosen v (with min_index)
+		for (int e = self->offsets[min_index]; e < self->offsets[min_index + 1]; e++) {
+			int considered_v = self->to_vertex[e];
+			STATS_INC(n_relaxed);
+			WS_TOUCH(considered_v);
+			if (!WS_SETTLED(considered_v) && dist[min_index] + self->weight[e] < dist[considered_v]) {
+				dist[considered_v] = dist[min_index] + self->weight[e];
+				pred_v[considered_v] = min_index;
+
+				if (pq_contains(queue, considered_v)) {
+					pq_decrease_key(queue, considered_v, dist[considered_v]);
+				}
+				else {
+					pq_insert(queue, considered_v, dist[considered_v]);
+				}
+			}
+		}
+	}
+
+	if (distance != NULL) {
+		*distance = closest_v == -1 ? INT_MAX : dist[closest_v];
+	}
+
+	STATS_COUNT(STAT_SEARCHES, 1);
+	STATS_COUNT(STAT_SETTLED, n_settled);
+	STATS_COUNT(STAT_RELAXED, n_relaxed);
+
+	// Trace path from closest target back to its source
+	return trace_path(pred_v, closest_v, arena);
+}
+
+
+/* Free all nodes of a path returned by dijkstra() or multi_source_dijkstra()
+ *		Only for paths allocated with malloc (csr_ versions called with a NULL arena)
+ * Parameters:
+ *		path		path (linked list of vertices)
+ * Return: void
+ */
+void destroy_path(EdgeList* path) {
+	EdgeNodePtr current = path->head;
+	while (current != NULL) {
+		EdgeNodePtr to_free = current;
+		current = current->next;
+		free(to_free);
+	}
+	path->head = NULL;
 }
 
 
@@ -368,20 +782,17 @@ int edge_weight(Graph* self, int v, int u) {
 	// Check if vertex v and u are valid
 	if (v < 0 || v >= self->V) {
 		fprintf(stderr, "From-vertex %d is invalid\n", v);
+		return -1;
 	}
 
 	if (u < 0 || u >= self->V) {
 		fprintf(stderr, "To-vertex %d is invalid\n", u);
+		return -1;
 	}
 
-	// Retrieve weight of edge uv
-	EdgeNodePtr current = self->edges[v].head;
-	while (current != NULL) {
-		if (current->edge.to_vertex == u) {
-			return current->edge.weight;
-		}
-		current = current->next;
-	}
+	// Retrieve weight of edge uv (from the index)
+	EdgeNodePtr node = index_find(self, v, u);
+	return node != NULL ? node->edge.weight : -1;
 }
 
 /* Check if edge uv exists in a graph
@@ -395,20 +806,283 @@ bool edge_exists(Graph* self, int v, int u) {
 	// Check if vertex v and u are valid
 	if (v < 0 || v >= self->V) {
 		fprintf(stderr, "From-vertex %d is invalid\n", v);
+		return false;
 	}
 
 	if (u < 0 || u >= self->V) {
 		fprintf(stderr, "To-vertex %d is invalid\n", u);
+		return false;
 	}
+
+	return index_find(self, v, u) != NULL;
+}
+
+/* Position of edge uv in the arrays of a CSR graph (binary search, rows are sorted by to-vertex)
+ * Return: index, -1 if edge does not exist
+ */
+static int csr_find_edge(CSRGraph* self, int v, int u) {
+	int low = self->offsets[v];
+	int high = self->offsets[v + 1] - 1;
+	while (low <= high) {
+		int middle = low + (high - low) / 2;
+		if (self->to_vertex[middle] < u) {
+			low = middle + 1;
+		}
+		else if (self->to_vertex[middle] > u) {
+			high = middle - 1;
+		}
+		else {
+			return middle;
+		}
+	}
+	return -1;
+}
+
+/* Return edge weight of vertex v --> vertex u (edge uv) in a CSR graph
+ * Parameters:
+ *		self		CSRGraph instance
+ *		v			first vertex
+ *		u			second vertex
+ * Return: edge weight (int), -1 if edge does not exist
+ */
+int csr_edge_weight(CSRGraph* self, int v, int u) {
+	// Check if vertex v and u are valid
+	if (v < 0 || v >= self->V) {
+		fprintf(stderr, "From-vertex %d is invalid\n", v);
+		return -1;
+	}
+
+	if (u < 0 || u >= self->V) {
+		fprintf(stderr, "To-vertex %d is invalid\n", u);
+		return -1;
+	}
+
 	// Retrieve weight of edge uv
-	EdgeNodePtr current = self->edges[v].head;
+	int e = csr_find_edge(self, v, u);
+	return e != -1 ? self->weight[e] : -1;
+}
+
+/* Check if edge uv exists in a CSR graph
+ * Parameters:
+ *		self		CSRGraph instance
+ *		v			first vertex
+ *		u			second vertex
+ * Return: true / false
+ */
+bool csr_edge_exists(CSRGraph* self, int v, int u) {
+	return csr_edge_weight(self, v, u) != -1;
+}
+
+/* Free the landmark distances of a CSR graph (they are no longer lower bounds once a weight changes) */
+static void csr_drop_landmarks(CSRGraph* self) {
+	free(self->landmark_dist);
+	self->landmark_dist = NULL;
+	self->n_landmarks = 0;
+}
+
+/* Change the weight of an undirected edge uv in a CSR graph (both directions)
+ * Parameters:
+ *		self		CSRGraph instance
+ *		v			first vertex
+ *		u			second vertex
+ *		weight		new edge weight
+ * Return: old edge weight, -1 if edge does not exist
+ */
+int csr_set_edge_weight(CSRGraph* self, int v, int u, int weight) {
+	if (v < 0 || v >= self->V || u < 0 || u >= self->V || v == u) {
+		return -1;
+	}
+
+	int forward = csr_find_edge(self, v, u);
+	int backward = csr_find_edge(self, u, v);
+	if (forward == -1 || backward == -1) {
+		return -1;
+	}
+
+	int old_weight = self->weight[forward];
+	self->weight[forward] = weight;
+	self->weight[backward] = weight;
+	csr_drop_landmarks(self);
+	return old_weight;
+}
+
+/* Turn the edge at index e of row v into a self-loop of weight 0, keeping the row sorted */
+static void csr_make_self_loop(CSRGraph* self, int v, int e) {
+	// Shift entries over until the self-loop is in order
+	while (e > self->offsets[v] && self->to_vertex[e - 1] > v) {
+		self->to_vertex[e] = self->to_vertex[e - 1];
+		self->weight[e] = self->weight[e - 1];
+		e--;
+	}
+	while (e < self->offsets[v + 1] - 1 && self->to_vertex[e + 1] < v) {
+		self->to_vertex[e] = self->to_vertex[e + 1];
+		self->weight[e] = self->weight[e + 1];
+		e++;
+	}
+	self->to_vertex[e] = v;
+	self->weight[e] = 0;
+}
+
+/* Remove an undirected edge uv from a CSR graph (both directions)
+ *		Each direction stays in its row as a self-loop of weight 0, so offsets (and E) do not change
+ *		Self-loops never shorten a path or join 2 trees, so every algorithm ignores them
+ * Parameters:
+ *		self		CSRGraph instance
+ *		v			first vertex
+ *		u			second vertex
+ * Return: old edge weight, -1 if edge does not exist
+ */
+int csr_remove_edge(CSRGraph* self, int v, int u) {
+	if (v < 0 || v >= self->V || u < 0 || u >= self->V || v == u) {
+		return -1;
+	}
+
+	int forward = csr_find_edge(self, v, u);
+	int backward = csr_find_edge(self, u, v);
+	if (forward == -1 || backward == -1) {
+		return -1;
+	}
+
+	int old_weight = self->weight[forward];
+	csr_make_self_loop(self, v, forward);
+	csr_make_self_loop(self, u, backward);
+	csr_drop_landmarks(self);
+	return old_weight;
+}
+
+/* Repair a shortest path tree (or a multi-source forest, sources have pred_v -1) after edge uv changed weight
+ *		The graph must already have the new weight (or no edge uv if it was removed)
+ *		Heavier / removed edge: only matters if it is a tree edge, then the subtree below it is searched again from its boundary
+ *		Lighter edge: Dijkstra's algorithm from the end it brings closer, which stops where distances do not improve
+ *		So the work is proportional to the vertices whose distance changes (plus their edges)
+ * Parameters:
+ *		self			CSRGraph instance
+ *		dist[]			distances of the tree (V entries, updated)
+ *		pred_v[]		predecessors of the tree (V entries, updated)
+ *		v				first vertex of the edge
+ *		u				second vertex of the edge
+ *		old_weight		weight before the change
+ *		new_weight		weight after the change (INT_MAX if the edge was removed)
+ *		queue			empty PQueue with capacity V (reused between calls, empty again afterwards)
+ *		stack[]			scratch array of V entries
+ * Return: void
+ */
+void csr_repair_shortest_path_tree(CSRGraph* self, int dist[], int pred_v[], int v, int u, int old_weight, int new_weight,
+	PQueue* queue, int stack[]) {
+	if (new_weight > old_weight) {
+		// Tree edge? (child is the end whose predecessor is the other end)
+		int child;
+		if (pred_v[u] == v && dist[v] != INT_MAX && dist[u] == dist[v] + old_weight) {
+			child = u;
+		}
+		else if (pred_v[v] == u && dist[u] != INT_MAX && dist[v] == dist[u] + old_weight) {
+			child = v;
+		}
+		else {
+			return;
+		}
+
+		// Subtree below the edge (children of x are neighbours whose predecessor is x)
+		int n_subtree = 0;
+		stack[n_subtree++] = child;
+		for (int i = 0; i < n_subtree; i++) {
+			int x = stack[i];
+			for (int e = self->offsets[x]; e < self->offsets[x + 1]; e++) {
+				int y = self->to_vertex[e];
+				if (y != x && pred_v[y] == x) {
+					stack[n_subtree++] = y;
+				}
+			}
+		}
+		for (int i = 0; i < n_subtree; i++) {
+			dist[stack[i]] = INT_MAX;
+			pred_v[stack[i]] = -1;
+		}
+
+		// Best way into the subtree from outside it (outside distances did not change)
+		for (int i = 0; i < n_subtree; i++) {
+			int x = stack[i];
+			for (int e = self->offsets[x]; e < self->offsets[x + 1]; e++) {
+				int y = self->to_vertex[e];
+				if (dist[y] != INT_MAX && dist[y] + self->weight[e] < dist[x]) {
+					dist[x] = dist[y] + self->weight[e];
+					pred_v[x] = y;
+				}
+			}
+			if (dist[x] != INT_MAX) {
+				pq_insert(queue, x, dist[x]);
+			}
+		}
+	}
+	else if (new_weight < old_weight) {
+		// Either end can now be reached more cheaply through the other
+		if (dist[v] != INT_MAX && dist[v] + new_weight < dist[u]) {
+			dist[u] = dist[v] + new_weight;
+			pred_v[u] = v;
+			pq_insert(queue, u, dist[u]);
+		}
+		else if (dist[u] != INT_MAX && dist[u] + new_weight < dist[v]) {
+			dist[v] = dist[u] + new_weight;
+			pred_v[v] = u;
+			pq_insert(queue, v, dist[v]);
+		}
+	}
+
+	// Spread the changed distances
+	while (!pq_is_empty(queue)) {
+		int x = pq_pop_min(queue, NULL);
+		for (int e = self->offsets[x]; e < self->offsets[x + 1]; e++) {
+			int y = self->to_vertex[e];
+			int alt = dist[x] + self->weight[e];
+			if (alt < dist[y]) {
+				dist[y] = alt;
+				pred_v[y] = x;
+				if (pq_contains(queue, y)) {
+					pq_decrease_key(queue, y, alt);
+				}
+				else {
+					pq_insert(queue, y, alt);
+				}
+			}
+		}
+	}
+}
+
+
+/* Add edges of a path to a result graph (each edge stored once, from lower to higher vertex)
+ * Parameters:
+ *		self			result Graph instance
+ *		map				CSRGraph the path was found in (for edge weights)
+ *		path			linked list of vertices in the path
+ * Return: void
+ */
+void add_path_edges(Graph* self, CSRGraph* map, EdgeList path) {
+	if (path.head == NULL) {
+		return;
+	}
+
+	EdgeNodePtr prev = path.head;
+	EdgeNodePtr current = path.head->next;
 	while (current != NULL) {
-		if (current->edge.to_vertex == u) {
-			return true;
+		int start_v, end_v;
+		// Make sure start_v < end_v
+		if (prev->edge.to_vertex < current->edge.to_vertex) {
+			start_v = prev->edge.to_vertex;
+			end_v = current->edge.to_vertex;
 		}
+		else {
+			start_v = current->edge.to_vertex;
+			end_v = prev->edge.to_vertex;
+		}
+
+		// If edge not yet added to result graph, add it
+		if (!edge_exists(self, start_v, end_v)) {
+			add_edge(self, start_v, end_v, csr_edge_weight(map, start_v, end_v));
+		}
+
+		prev = prev->next;
 		current = current->next;
 	}
-	return false;
 }
 
 /* Create a graph that combines edges from tickets 
@@ -420,43 +1094,47 @@ bool edge_exists(Graph* self, int v, int u) {
  * Return: Graph containing shortest path edges
  */
 Graph shortest_paths(Graph* self, int from_cities[], int to_cities[], int n_tickets) {
+	CSRGraph csr = create_csr_graph(self);
+	Graph shortest_G = csr_shortest_paths(&csr, from_cities, to_cities, n_tickets);
+	destroy_csr_graph(&csr);
+	return shortest_G;
+}
+
+/* Create a graph that combines edges from tickets (CSR graph)
+ * Parameters:
+ *		self			CSRGraph instance
+ *		from_cities[]	array of source vertices in tickets
+ *		to_citites[]	array of destination vertices in tickets
+ *		n_tickets		number of tickets
+ * Return: Graph containing shortest path edges
+ */
+Graph csr_shortest_paths(CSRGraph* self, int from_cities[], int to_cities[], int n_tickets) {
+	STATS_BEGIN("shortest_paths");
+
 	// Initialise graph with all vertices (but no edges)
-	Graph shortest_G;
-	shortest_G.V = self->V;
-	shortest_G.edges = malloc(sizeof(shortest_G.edges) * shortest_G.V);
-	for (int v = 0; v < shortest_G.V; v++) {
-		shortest_G.edges[v].head = NULL;
-	}
+	Graph shortest_G = create_empty_graph(self->V);
 
-	// Use Dijkstra to find shortest path for each ticket, then edges to shortest_G
+	// Paths are only needed until their edges are copied, so they share 1 arena reset per ticket
+	Arena* scratch = create_arena(sizeof(struct edgeNode) * 64);
+
+	// Point-to-point search state, reused by every ticket (each only resets what it reached)
+	RouteSearch search = create_route_search(self);
+
+	// Find shortest path for each ticket, then edges to shortest_G
 	for (int n = 0; n < n_tickets; n++) {
-		// Apply Dijkstra's
-		EdgeList path = dijkstra(self, from_cities[n], to_cities[n], NULL);
-		
-		// Add edges to shortest_G
-		EdgeNodePtr prev = path.head;
-		EdgeNodePtr current = path.head->next;
-		while (current != NULL) {
-			int start_v, end_v;
-			// Make sure start_v < end_v
-			if (prev->edge.to_vertex < current->edge.to_vertex) {
-				start_v = prev->edge.to_vertex;
-				end_v = current->edge.to_vertex;
-			}
-			else {
-				start_v = current->edge.to_vertex;
-				end_v = prev->edge.to_vertex;
-			}
+		// Bidirectional Dijkstra's (A* if the map has landmarks)
+		EdgeList path = route_search(&search, from_cities[n], to_cities[n], NULL, scratch);
 
-			// If edge not yet added to shortest_G, add it
-			if (!edge_exists(&shortest_G, start_v, end_v)) {
-				add_edge(&shortest_G, start_v, end_v, edge_weight(self, start_v, end_v));
-			}
+		// Add edges to shortest_G
+		add_path_edges(&shortest_G, self, path);
 
-			prev = prev->next;
-			current = current->next;
-		}
+		arena_reset(scratch);
 	}
+
+	destroy_route_search(&search);
+	destroy_arena(scratch);
+
+	STATS_END("shortest_paths");
 	return shortest_G;
 }
 
@@ -470,92 +1148,85 @@ Graph shortest_paths(Graph* self, int from_cities[], int to_cities[], int n_tick
  * Return: steiner tree (Graph)
  */
 Graph steiner_tree(Graph* self, int terminals[], int n_terminals) {
+	CSRGraph csr = create_csr_graph(self);
+	Graph steiner_t = csr_steiner_tree(&csr, terminals, n_terminals);
+	destroy_csr_graph(&csr);
+	return steiner_t;
+}
+
+/* Steiner tree with set of terminal vertices in a CSR graph 
+ * Parameters:
+ *		self			CSRGraph instance
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ * Return: steiner tree (Graph)
+ */
+Graph csr_steiner_tree(CSRGraph* self, int terminals[], int n_terminals) {
+	STATS_BEGIN("steiner_tree");
+
 	// Initialise graph with all vertices (but no edges)
-	Graph steiner_t;
-	steiner_t.V = self->V;
-	steiner_t.edges = malloc(sizeof(steiner_t.edges) * steiner_t.V);
-	for (int v = 0; v < steiner_t.V; v++) {
-		steiner_t.edges[v].head = NULL;
+	Graph steiner_t = create_empty_graph(self->V);
+
+	// No tickets: nothing to connect
+	if (n_terminals == 0) {
+		STATS_END("steiner_tree");
+		return steiner_t;
 	}
 
 	// Array to keep check of which vertices are in steiner tree
 	//		Initally, all false except the starting vertex (can be any)
 	bool* inTree = malloc(sizeof(bool) * self->V);
 
-
-	// Array to check which vertices are terminals
-	bool* isTerm = malloc(sizeof(bool) * self->V);
-
+	// Array to check which terminals are not yet connected to the tree
+	bool* remaining = malloc(sizeof(bool) * self->V);
 
 	for (int v = 0; v < self->V; v++) {
 		inTree[v] = false;
-		isTerm[v] = false;
+		remaining[v] = false;
 	}
 
 	for (int i = 0; i < n_terminals; i++) {
-		isTerm[terminals[i]] = true;
+		remaining[terminals[i]] = true;
 	}
 	
 	// Add first terminal vertex to tree
 	inTree[terminals[0]] = true;
+	remaining[terminals[0]] = false;
+
+	// Path nodes of each round, reset once the path is in the tree
+	Arena* scratch = create_arena(sizeof(struct edgeNode) * 64);
 
 	// Loop until all terminal vertices are added to tree 
 	//		Only until n_terminals - 1 (first terminal already added)
 	for (int count = 0; count < n_terminals - 1; count++) {
-		// Find closest terminal not in tree to a vertex in tree
-		int closest_distance = INT_MAX;
-		int closest_v;
-		EdgeList shortest_path;
-		for (int n = 0; n < self->V; n++) {
-			int distance = 0;
-			if (inTree[n]) { // every vertex in tree
-				for (int i = 0; i < self->V; i++) {
-					if (!inTree[i] && isTerm[i]) { // terminal vertices that are not yet in tree
-						EdgeList path = dijkstra(self, n, i, &distance);
-						//printf("       Distance = %d\n", distance);
-						if (distance < closest_distance) {
-							closest_distance = distance;
-							closest_v = i;
-							shortest_path = dijkstra(self, n, i, &distance);
-
-							//printf("        Closest distance = %d\n", closest_distance);
-
-						}
-					}
-				}
-			}
-		}
+		// One search seeded from the whole tree finds the closest terminal not in tree
+		EdgeList shortest_path = csr_multi_source_dijkstra(self, inTree, remaining, NULL, scratch);
 
-		//printf("==> Closest distance = %d\n", closest_distance);
-		//printf("==> Closest v = %d\n", closest_v);
+		// No terminal left to connect (duplicate terminals) or the rest are unreachable
+		if (shortest_path.head == NULL) {
+			break;
+		}
 
 		// Add all vertices on shortest paths to tree
-		EdgeNodePtr prev = shortest_path.head;
-		EdgeNodePtr current = shortest_path.head->next;
-		while (current != NULL) {
-			int start_v, end_v;
-			// Make sure start_v < end_v
-			if (prev->edge.to_vertex < current->edge.to_vertex) {
-				start_v = prev->edge.to_vertex;
-				end_v = current->edge.to_vertex;
-			}
-			else {
-				start_v = current->edge.to_vertex;
-				end_v = prev->edge.to_vertex;
-			}
-
-			// If edge not yet added to steiner_t, add it
-			if (!edge_exists(&steiner_t, start_v, end_v)) {
-				add_edge(&steiner_t, start_v, end_v, edge_weight(self, start_v, end_v));
-			}
+		add_path_edges(&steiner_t, self, shortest_path);
 
-			// Set inTree value to true
+		// Set inTree value to true (terminals passed on the way are connected too)
+		EdgeNodePtr current = shortest_path.head;
+		while (current != NULL) {
 			inTree[current->edge.to_vertex] = true;
-
-			prev = prev->next;
+			remaining[current->edge.to_vertex] = false;
 			current = current->next;
 		}
+
+		arena_reset(scratch);
 	}
 
+	/* Free memory for dynamic arrays */
+	free(inTree);
+	free(remaining);
+	destroy_arena(scratch);
+	STATS_COUNT(STAT_ALLOCATIONS, 2);
+
+	STATS_END("steiner_tree");
 	return steiner_t;
 }
\ No newline at end of file
@@ -1,6 +1,13 @@
 #ifndef LIST_H
 #define LIST_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+#include "parser.h"
+#include "pqueue.h"
+
 typedef struct edge {
 	int to_vertex;
 	int weight;
@@ -15,17 +22,56 @@ typedef struct edgeList {
 	EdgeNodePtr head;
 } EdgeList;
 
+/* Open-addressing hash index of the edges of a graph, keyed by (from-vertex, to-vertex)
+ *		nodes[i] is NULL for an empty slot, otherwise the edge node with key keys[i]
+ *		capacity is a power of 2, and the index is kept at most half full
+ *		Built on the first lookup (nodes == NULL until then), then kept up to date by add_edge()
+ */
+typedef struct edgeIndex {
+	uint64_t* keys;
+	EdgeNodePtr* nodes;
+	size_t capacity;
+	size_t count;
+} EdgeIndex;
+
+/* Adjacency list graph
+ *		All edge nodes are allocated from the graph's arena, so destroy_graph() frees them in bulk
+ *		Edges are also in index, so edge_exists() / edge_weight() take constant time
+ */
 typedef struct graph {
 	int V;
 	EdgeList* edges;
+	Arena* arena;
+	EdgeIndex index;
 } Graph;
 
+/* Compressed sparse row (CSR) form of a graph, built once from a Graph (or loaded from a binary map file)
+ *		Only edge weights change afterwards (csr_set_edge_weight(), csr_remove_edge()), offsets never do
+ *		Edges from vertex v are to_vertex[e] / weight[e] for offsets[v] <= e < offsets[v + 1]
+ *		E counts directed edges (each undirected edge is stored in both directions)
+ *		mapping is the memory-mapped map file holding the arrays (NULL if they were malloc'd)
+ *		landmark_dist[i * V + v] is the distance from landmark i to v, for A* lower bounds
+ *		(NULL until build_landmarks() is called, dropped again when a weight changes)
+ */
+typedef struct csrGraph {
+	int V;
+	int E;
+	int* offsets;
+	int* to_vertex;
+	int* weight;
+	void* mapping;
+	size_t mapping_length;
+	int n_landmarks;
+	int* landmark_dist;
+} CSRGraph;
+
 
 /* Create a graph (Read inputs) -------------------------------------
- * No parameters
- * Return: Graph
+ * Parameters:
+ *		input		Parser positioned at the start of the map
+ * Return: Graph (empty graph, with input->failed set, if the map is malformed)
  */
-Graph create_graph();
+Graph create_graph(Parser* input);
 
 
 /* Destroy a graph (free all memory) ------------------------------
@@ -36,6 +82,62 @@ Graph create_graph();
 void destroy_graph(Graph* self);
 
 
+/* Create an empty graph (all vertices, but no edges)
+ * Parameters:
+ *		V			number of vertices
+ * Return: Graph
+ */
+Graph create_empty_graph(int V);
+
+
+/* Add a new directed edge to a graph
+ * Parameters:
+ *		self			Graph instance
+ *		from_vertex		vertex where the edge begins
+ *		to_vertex		vertex where the edge ends
+ *		weight			edge weight
+ * Return: void
+ */
+void add_edge(Graph* self, int from_vertex, int to_vertex, int weight);
+
+
+/* Return edge weight of vertex v --> vertex u (edge uv)
+ * Parameters:
+ *		self		Graph instance
+ *		v			first vertex
+ *		u			second vertex
+ * Return: edge weight (int), -1 if edge does not exist
+ */
+int edge_weight(Graph* self, int v, int u);
+
+
+/* Check if edge uv exists in a graph
+ * Parameters:
+ *		self		Graph instance
+ *		v			first vertex
+ *		u			second vertex
+ * Return: true / false
+ */
+bool edge_exists(Graph* self, int v, int u);
+
+
+/* Create a compressed sparse row (CSR) copy of a graph ---------------
+ *		Edges of each vertex are stored contiguously, sorted by to-vertex
+ * Parameters:
+ *		self		Graph instance
+ * Return: CSRGraph
+ */
+CSRGraph create_csr_graph(Graph* self);
+
+
+/* Destroy a CSR graph (free all memory) ------------------------------
+ * Parameters:
+ *		self    CSRGraph instance
+ * Return: void
+ */
+void destroy_csr_graph(CSRGraph* self);
+
+
 /* Print to-vertices of each vertex in graph ----------------------
  * Parameter:
  *		self		Graph instance
@@ -52,11 +154,14 @@ void print_graph(Graph* self);
 void print_in_degrees(Graph* self);
 
 /* Run Prim's minimal spanning tree algorithm on graph ---------------
+ *		csr_ version takes a CSR graph (same for the other algorithms below)
+ *		Its arrays and queue are the calling thread's workspace (see borrow_workspace()), as for Dijkstra's below
  * Parameters
  *		self		Graph instance
  * Return: MST (Graph)
 */
 Graph prims_mst(Graph* self);
+Graph csr_prims_mst(CSRGraph* self);
 
 
 /* Calculate total weight of a graph
@@ -67,20 +172,152 @@ Graph prims_mst(Graph* self);
 int graph_weight(Graph* self);
 
 
+/* Calculate total weight of a CSR graph (each undirected edge counted once)
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: total weight of graph
+ */
+int csr_graph_weight(CSRGraph* self);
+
+
+/* Return edge weight of vertex v --> vertex u (edge uv) in a CSR graph
+ * Parameters:
+ *		self		CSRGraph instance
+ *		v			first vertex
+ *		u			second vertex
+ * Return: edge weight (int), -1 if edge does not exist
+ */
+int csr_edge_weight(CSRGraph* self, int v, int u);
+
+
+/* Check if edge uv exists in a CSR graph
+ * Parameters:
+ *		self		CSRGraph instance
+ *		v			first vertex
+ *		u			second vertex
+ * Return: true / false
+ */
+bool csr_edge_exists(CSRGraph* self, int v, int u);
+
+
+/* Change the weight of an undirected edge uv in a CSR graph (both directions)
+ * Parameters:
+ *		self		CSRGraph instance
+ *		v			first vertex
+ *		u			second vertex
+ *		weight		new edge weight
+ * Return: old edge weight, -1 if edge does not exist
+ */
+int csr_set_edge_weight(CSRGraph* self, int v, int u, int weight);
+
+
+/* Remove an undirected edge uv from a CSR graph (both directions)
+ *		Each direction stays in its row as a self-loop of weight 0, so offsets (and E) do not change
+ *		Self-loops never shorten a path or join 2 trees, so every algorithm ignores them
+ * Parameters:
+ *		self		CSRGraph instance
+ *		v			first vertex
+ *		u			second vertex
+ * Return: old edge weight, -1 if edge does not exist
+ */
+int csr_remove_edge(CSRGraph* self, int v, int u);
+
+
+/* Repair a shortest path tree (or a multi-source forest, sources have pred_v -1) after edge uv changed weight
+ *		The graph must already have the new weight (or no edge uv if it was removed)
+ *		Work is proportional to the vertices whose distance changes (plus their edges)
+ * Parameters:
+ *		self			CSRGraph instance
+ *		dist[]			distances of the tree (V entries, updated)
+ *		pred_v[]		predecessors of the tree (V entries, updated)
+ *		v				first vertex of the edge
+ *		u				second vertex of the edge
+ *		old_weight		weight before the change
+ *		new_weight		weight after the change (INT_MAX if the edge was removed)
+ *		queue			empty PQueue with capacity V (reused between calls, empty again afterwards)
+ *		stack[]			scratch array of V entries
+ * Return: void
+ */
+void csr_repair_shortest_path_tree(CSRGraph* self, int dist[], int pred_v[], int v, int u, int old_weight, int new_weight,
+	PQueue* queue, int stack[]);
+
+
 /* Dijkstra's algorithm
  *		Return shortest path from source to destination from a graph
+ *		Stops as soon as the destination is visited
+ *		Nothing is allocated or cleared per call (csr_ version): the search uses the calling thread's workspace
  *		Also change value of pre-created distance (passed by reference)
  * Parameters:
  *		self			Graph instance
  *		source			source vertex
  *		destination		destination vertex
  *		distance		pointer to variable storing distance of the shortest path from source to destination
+ *		arena			(csr_ only) Arena to allocate path nodes from, NULL to use malloc
  * Return: linked list of vertices in the path
  */
 EdgeList dijkstra(Graph* self, int source, int destination, int* distance);
+EdgeList csr_dijkstra(CSRGraph* self, int source, int destination, int* distance, Arena* arena);
+
+
+/* Dijkstra's shortest path tree from a source vertex (CSR graph)
+ *		Change values of pre-created dist and pred_v arrays (V entries each)
+ * Parameters:
+ *		self			CSRGraph instance
+ *		source			source vertex
+ *		dist[]			array storing shortest distance from source to each vertex (INT_MAX if unreachable)
+ *		pred_v[]		array storing predecessor of each vertex on its shortest path (-1 for source / unreachable)
+ * Return: void
+ */
+void csr_shortest_path_tree(CSRGraph* self, int source, int dist[], int pred_v[]);
+
+
+/* Multi-source Dijkstra's algorithm
+ *		Return shortest path from any source vertex to the closest target vertex
+ *		Searches in the calling thread's workspace (csr_ version), so a call only touches the vertices it reaches
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			Graph instance
+ *		sources[]		sources[v] is true if v is a source vertex
+ *		targets[]		targets[v] is true if v is a target vertex
+ *		distance		pointer to variable storing distance of the shortest path (INT_MAX if no target is reachable)
+ *		arena			(csr_ only) Arena to allocate path nodes from, NULL to use malloc
+ * Return: linked list of vertices in the path, from source to target (empty if no target is reachable)
+ */
+EdgeList multi_source_dijkstra(Graph* self, bool sources[], bool targets[], int* distance);
+EdgeList csr_multi_source_dijkstra(CSRGraph* self, bool sources[], bool targets[], int* distance, Arena* arena);
+
+
+/* Free all nodes of a path returned by dijkstra() or multi_source_dijkstra()
+ *		Only for paths allocated with malloc (csr_ versions called with a NULL arena)
+ * Parameters:
+ *		path		path (linked list of vertices)
+ * Return: void
+ */
+void destroy_path(EdgeList* path);
+
+
+/* Trace path from a vertex back to the start of its search --> linked list of vertices (EdgeNode) with weight = 0
+ * Parameters:
+ *		pred_v[]		predecessor of each vertex (-1 for the start of the search)
+ *		v				last vertex of the path (-1 for an empty path)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path
+ */
+EdgeList trace_path(int pred_v[], int v, Arena* arena);
+
+
+/* Add edges of a path to a result graph (each edge stored once, from lower to higher vertex)
+ * Parameters:
+ *		self			result Graph instance
+ *		map				CSRGraph the path was found in (for edge weights)
+ *		path			linked list of vertices in the path
+ * Return: void
+ */
+void add_path_edges(Graph* self, CSRGraph* map, EdgeList path);
 
 
 /* Create a graph that combines edges from tickets
+ *		Each path is a point-to-point search (csr_ version: see route_search()), so only the region between the 2 cities is explored
  * Parameters:
  *		self			Graph instance
  *		from_cities[]	array of source vertices in tickets
@@ -89,6 +326,7 @@ EdgeList dijkstra(Graph* self, int source, int destination, int* distance);
  * Return: Graph containing shortest path edges
  */
 Graph shortest_paths(Graph* self, int from_cities[], int to_cities[], int n_tickets);
+Graph csr_shortest_paths(CSRGraph* self, int from_cities[], int to_cities[], int n_tickets);
 
 /* Steiner tree with set of terminal vertices in a graph
  * Logic: https://medium.com/@rkarthik3cse/steiner-tree-in-graph-explained-8eb363786599
@@ -96,7 +334,8 @@ Graph shortest_paths(Graph* self, int from_cities[], int to_cities[], int n_tick
  *		self			Graph instance
  *		terminals[]		array containing all terminal vertices
  *		n_terminals		number of terminals (= 2 * n_tickets)
- * Return: steiner tree (Graph)
+ * Return: steiner tree (Graph), no edges if there are no terminals
  */
 Graph steiner_tree(Graph* self, int terminals[], int n_terminals);
+Graph csr_steiner_tree(CSRGraph* self, int terminals[], int n_terminals);
 #endif
\ No newline at end of file
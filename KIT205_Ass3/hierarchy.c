@@ -0,0 +1,578 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "graph.h"
+#include "pqueue.h"
+#include "hierarchy.h"
+#include "stats.h"
+
+
+/* Contraction ------------------------------------------------------- */
+
+/* Edges of a vertex to the vertices not contracted yet (once the vertex is contracted: its up edges) */
+typedef struct contractionEdges {
+	int* to_vertex;
+	int* weight;
+	int* middle;
+	int n;
+	int capacity;
+} ContractionEdges;
+
+/* State of the contraction, with a reusable witness search (dist[] is INT_MAX outside touched[])
+ *		shortcut_from[] / shortcut_to[] / shortcut_weight[] hold the n_shortcuts shortcuts found by the last
+ *		call of find_shortcuts(), so contracting that vertex next does not search again
+ *		n_edges counts the edges between vertices not contracted yet (both directions)
+ */
+typedef struct contraction {
+	int V;
+	ContractionEdges* edges;
+	int* contracted_neighbours;
+	int* dist;
+	int* hops;
+	int* touched;
+	int n_touched;
+	bool* target;
+	PQueue queue;
+	int* shortcut_from;
+	int* shortcut_to;
+	int* shortcut_weight;
+	int n_shortcuts;
+	int shortcut_capacity;
+	long long n_edges;
+} Contraction;
+
+/* Add edge to a vertex's list, or lower its weight if it is already there
+ * Return: true if the edge is new
+ */
+static bool add_contraction_edge(ContractionEdges* list, int to_vertex, int weight, int middle) {
+	for (int i = 0; i < list->n; i++) {
+		if (list->to_vertex[i] == to_vertex) {
+			if (weight < list->weight[i]) {
+				list->weight[i] = weight;
+				list->middle[i] = middle;
+			}
+			return false;
+		}
+	}
+
+	if (list->n == list->capacity) {
+		list->capacity = list->capacity > 0 ? list->capacity * 2 : 4;
+		list->to_vertex = realloc(list->to_vertex, sizeof(int) * list->capacity);
+		list->weight = realloc(list->weight, sizeof(int) * list->capacity);
+		list->middle = realloc(list->middle, sizeof(int) * list->capacity);
+	}
+	list->to_vertex[list->n] = to_vertex;
+	list->weight[list->n] = weight;
+	list->middle[list->n] = middle;
+	list->n++;
+	return true;
+}
+
+/* Remove edge to a vertex from a vertex's list (order is not kept) */
+static void remove_contraction_edge(ContractionEdges* list, int to_vertex) {
+	for (int i = 0; i < list->n; i++) {
+		if (list->to_vertex[i] == to_vertex) {
+			list->n--;
+			list->to_vertex[i] = list->to_vertex[list->n];
+			list->weight[i] = list->weight[list->n];
+			list->middle[i] = list->middle[list->n];
+			return;
+		}
+	}
+}
+
+/* Dijkstra's search from source among the vertices not contracted yet, without skip
+ *		Stops once n_targets vertices marked in target[] are visited, beyond max_distance or after
+ *		HIERARCHY_WITNESS_LIMIT vertices, and does not go on from vertices HIERARCHY_WITNESS_HOPS edges away
+ *		(distances found so far stay in dist[])
+ */
+static void witness_search(Contraction* self, int source, int skip, int n_targets, int max_distance) {
+	for (int i = 0; i < self->n_touched; i++) {
+		self->dist[self->touched[i]] = INT_MAX;
+	}
+	self->n_touched = 0;
+	pq_clear(&self->queue);
+
+	self->dist[source] = 0;
+	self->hops[source] = 0;
+	self->touched[self->n_touched++] = source;
+	pq_insert(&self->queue, source, 0);
+
+	int n_settled = 0;
+	while (!pq_is_empty(&self->queue) && n_settled < HIERARCHY_WITNESS_LIMIT) {
+		int key;
+		int u = pq_pop_min(&self->queue, &key);
+		if (key > max_distance || (self->target[u] && --n_targets == 0)) {
+			break;
+		}
+		n_settled++;
+		if (self->hops[u] == HIERARCHY_WITNESS_HOPS) {
+			continue;
+		}
+
+		ContractionEdges* list = &self->edges[u];
+		for (int i = 0; i < list->n; i++) {
+			int v = list->to_vertex[i];
+			int alt = key + list->weight[i];
+			if (v == skip || alt >= self->dist[v]) {
+				continue;
+			}
+			if (self->dist[v] == INT_MAX) {
+				self->touched[self->n_touched++] = v;
+			}
+			self->dist[v] = alt;
+			self->hops[v] = self->hops[u] + 1;
+			if (pq_contains(&self->queue, v)) {
+				pq_decrease_key(&self->queue, v, alt);
+			}
+			else {
+				pq_insert(&self->queue, v, alt);
+			}
+		}
+	}
+}
+
+/* Shortcuts needed to contract v (between neighbours with no other path as short), kept in the state for contract_vertex()
+ * Return: number of shortcuts
+ */
+static int find_shortcuts(Contraction* self, int v) {
+	ContractionEdges* list = &self->edges[v];
+	self->n_shortcuts = 0;
+
+	// Each pair of neighbours once (i < j)
+	for (int i = 0; i < list->n - 1; i++) {
+		int u = list->to_vertex[i];
+		int max_distance = 0;
+		for (int j = i + 1; j < list->n; j++) {
+			self->target[list->to_vertex[j]] = true;
+			if (list->weight[i] + list->weight[j] > max_distance) {
+				max_distance = list->weight[i] + list->weight[j];
+			}
+		}
+
+		witness_search(self, u, v, list->n - 1 - i, max_distance);
+		for (int j = i + 1; j < list->n; j++) {
+			self->target[list->to_vertex[j]] = false;
+		}
+		for (int j = i + 1; j < list->n; j++) {
+			int w = list->to_vertex[j];
+			int via = list->weight[i] + list->weight[j];
+			if (self->dist[w] > via) {
+				if (self->n_shortcuts == self->shortcut_capacity) {
+					self->shortcut_capacity *= 2;
+					self->shortcut_from = realloc(self->shortcut_from, sizeof(int) * self->shortcut_capacity);
+					self->shortcut_to = realloc(self->shortcut_to, sizeof(int) * self->shortcut_capacity);
+					self->shortcut_weight = realloc(self->shortcut_weight, sizeof(int) * self->shortcut_capacity);
+				}
+				self->shortcut_from[self->n_shortcuts] = u;
+				self->shortcut_to[self->n_shortcuts] = w;
+				self->shortcut_weight[self->n_shortcuts] = via;
+				self->n_shortcuts++;
+			}
+		}
+	}
+	return self->n_shortcuts;
+}
+
+/* Contract v with the shortcuts find_shortcuts() just found for it: its remaining edges become its up edges */
+static void contract_vertex(Contraction* self, int v) {
+	for (int i = 0; i < self->n_shortcuts; i++) {
+		int u = self->shortcut_from[i];
+		int w = self->shortcut_to[i];
+		if (add_contraction_edge(&self->edges[u], w, self->shortcut_weight[i], v)) {
+			self->n_edges++;
+		}
+		if (add_contraction_edge(&self->edges[w], u, self->shortcut_weight[i], v)) {
+			self->n_edges++;
+		}
+	}
+
+	ContractionEdges* list = &self->edges[v];
+	for (int i = 0; i < list->n; i++) {
+		remove_contraction_edge(&self->edges[list->to_vertex[i]], v);
+		self->contracted_neighbours[list->to_vertex[i]]++;
+	}
+	self->n_edges -= 2 * list->n;
+}
+
+/* Priority of a vertex (smaller is contracted first): twice the edge difference plus contracted neighbours */
+static int contraction_priority(Contraction* self, int v) {
+	return 2 * (find_shortcuts(self, v) - self->edges[v].n) + self->contracted_neighbours[v];
+}
+
+/* Build a contraction hierarchy of a map
+ *		Vertices are contracted in order of twice the edge difference (shortcuts added - edges removed) plus
+ *		contracted neighbours, updated lazily, until the ones left average HIERARCHY_CORE_DEGREE edges (the core)
+ * Parameters:
+ *		map			CSRGraph instance
+ * Return: ContractionHierarchy
+ */
+ContractionHierarchy build_hierarchy(CSRGraph* map) {
+	STATS_BEGIN("build_hierarchy");
+	int V = map->V;
+	Contraction state;
+	state.V = V;
+	state.edges = calloc(V > 0 ? V : 1, sizeof(ContractionEdges));
+	state.contracted_neighbours = calloc(V > 0 ? V : 1, sizeof(int));
+	state.dist = malloc(sizeof(int) * (V > 0 ? V : 1));
+	state.hops = malloc(sizeof(int) * (V > 0 ? V : 1));
+	state.touched = malloc(sizeof(int) * (V > 0 ? V : 1));
+	state.n_touched = 0;
+	state.target = calloc(V > 0 ? V : 1, sizeof(bool));
+	state.queue = create_pqueue(V, get_pq_kind());
+	state.shortcut_capacity = 16;
+	state.shortcut_from = malloc(sizeof(int) * state.shortcut_capacity);
+	state.shortcut_to = malloc(sizeof(int) * state.shortcut_capacity);
+	state.shortcut_weight = malloc(sizeof(int) * state.shortcut_capacity);
+	state.n_shortcuts = 0;
+	state.n_edges = 0;
+
+	// Routes of the map (self-loops, i.e. removed routes, are left out, parallel routes keep the lightest)
+	for (int v = 0; v < V; v++) {
+		state.dist[v] = INT_MAX;
+		for (int e = map->offsets[v]; e < map->offsets[v + 1]; e++) {
+			if (map->to_vertex[e] != v) {
+				add_contraction_edge(&state.edges[v], map->to_vertex[e], map->weight[e], -1);
+			}
+		}
+		state.n_edges += state.edges[v].n;
+	}
+
+	// Contraction order (priorities are checked again when a vertex comes out, as contracting others changes them)
+	//		A map already too dense to contract is all core, so its order does not matter
+	ContractionHierarchy hierarchy;
+	hierarchy.V = V;
+	hierarchy.rank = malloc(sizeof(int) * (V > 0 ? V : 1));
+	PQueue order = create_pqueue(V, PQ_BINARY);
+	bool all_core = state.n_edges > (long long)HIERARCHY_CORE_DEGREE * V;
+	for (int v = 0; v < V; v++) {
+		pq_insert(&order, v, all_core ? 0 : contraction_priority(&state, v));
+	}
+
+	// Once the vertices left are too dense, witness searches get slow and most pairs need a shortcut: they are
+	// left as the core instead, ranked in order (their edges to each other stay in both of their lists)
+	int n_contracted = 0;
+	while (!pq_is_empty(&order)) {
+		int v = pq_pop_min(&order, NULL);
+		if (state.n_edges > (long long)HIERARCHY_CORE_DEGREE * (V - n_contracted)) {
+			hierarchy.rank[v] = n_contracted++;
+			continue;
+		}
+
+		int priority = contraction_priority(&state, v);
+		int next_priority;
+		if (pq_peek_min(&order, &next_priority) != -1 && priority > next_priority) {
+			pq_insert(&order, v, priority);
+			continue;
+		}
+
+		contract_vertex(&state, v);
+		hierarchy.rank[v] = n_contracted++;
+	}
+
+	// Up edges in CSR form, rows sorted by to-vertex (insertion sort, rows are short)
+	CSRGraph up;
+	up.V = V;
+	up.E = 0;
+	up.mapping = NULL;
+	up.mapping_length = 0;
+	up.n_landmarks = 0;
+	up.landmark_dist = NULL;
+	up.offsets = malloc(sizeof(int) * (V + 1));
+	for (int v = 0; v < V; v++) {
+		up.offsets[v] = up.E;
+		up.E += state.edges[v].n;
+	}
+	up.offsets[V] = up.E;
+	up.to_vertex = malloc(sizeof(int) * (up.E > 0 ? up.E : 1));
+	up.weight = malloc(sizeof(int) * (up.E > 0 ? up.E : 1));
+	hierarchy.middle = malloc(sizeof(int) * (up.E > 0 ? up.E : 1));
+
+	for (int v = 0; v < V; v++) {
+		ContractionEdges* list = &state.edges[v];
+		int start = up.offsets[v];
+		for (int i = 0; i < list->n; i++) {
+			int j = start + i;
+			while (j > start && up.to_vertex[j - 1] > list->to_vertex[i]) {
+				up.to_vertex[j] = up.to_vertex[j - 1];
+				up.weight[j] = up.weight[j - 1];
+				hierarchy.middle[j] = hierarchy.middle[j - 1];
+				j--;
+			}
+			up.to_vertex[j] = list->to_vertex[i];
+			up.weight[j] = list->weight[i];
+			hierarchy.middle[j] = list->middle[i];
+		}
+		free(list->to_vertex);
+		free(list->weight);
+		free(list->middle);
+	}
+	hierarchy.up = up;
+
+	/* Free memory */
+	free(state.edges);
+	free(state.contracted_neighbours);
+	free(state.dist);
+	free(state.hops);
+	free(state.touched);
+	free(state.target);
+	free(state.shortcut_from);
+	free(state.shortcut_to);
+	free(state.shortcut_weight);
+	destroy_pqueue(&state.queue);
+	destroy_pqueue(&order);
+
+	STATS_END("build_hierarchy");
+	return hierarchy;
+}
+
+/* Destroy a contraction hierarchy (free all memory, or unmap its file)
+ * Parameters:
+ *		self		ContractionHierarchy instance
+ * Return: void
+ */
+void destroy_hierarchy(ContractionHierarchy* self) {
+	// A loaded hierarchy has all its arrays in the mapping of up
+	if (self->up.mapping == NULL) {
+		free(self->rank);
+		free(self->middle);
+	}
+	destroy_csr_graph(&self->up);
+}
+
+
+/* Queries ----------------------------------------------------------- */
+
+/* Create the state of queries on a hierarchy
+ * Parameters:
+ *		hierarchy		ContractionHierarchy instance (must outlive the query)
+ * Return: HierarchyQuery
+ */
+HierarchyQuery create_hierarchy_query(ContractionHierarchy* hierarchy) {
+	int V = hierarchy->V;
+	HierarchyQuery query;
+	query.hierarchy = hierarchy;
+	query.touched = malloc(sizeof(int) * (V > 0 ? V : 1));
+	query.chain = malloc(sizeof(int) * (V > 0 ? V : 1));
+	query.n_touched = 0;
+	query.n_settled = 0;
+	for (int side = 0; side < 2; side++) {
+		query.dist[side] = malloc(sizeof(int) * (V > 0 ? V : 1));
+		query.pred_v[side] = malloc(sizeof(int) * (V > 0 ? V : 1));
+		query.pred_edge[side] = malloc(sizeof(int) * (V > 0 ? V : 1));
+		query.queue[side] = create_pqueue(V, get_pq_kind());
+		for (int v = 0; v < V; v++) {
+			query.dist[side][v] = INT_MAX;
+			query.pred_v[side][v] = -1;
+			query.pred_edge[side][v] = -1;
+		}
+	}
+	return query;
+}
+
+/* Destroy the state of queries on a hierarchy (free all memory)
+ * Parameters:
+ *		self		HierarchyQuery instance
+ * Return: void
+ */
+void destroy_hierarchy_query(HierarchyQuery* self) {
+	for (int side = 0; side < 2; side++) {
+		free(self->dist[side]);
+		free(self->pred_v[side]);
+		free(self->pred_edge[side]);
+		destroy_pqueue(&self->queue[side]);
+	}
+	free(self->touched);
+	free(self->chain);
+}
+
+/* Upward search from both ends
+ * Return: vertex where the shortest path peaks in rank (-1 if unreachable), distance in *distance
+ */
+static int upward_search(HierarchyQuery* self, int source, int destination, int* distance) {
+	CSRGraph* up = &self->hierarchy->up;
+
+	// Reset the vertices reached by the last query
+	for (int i = 0; i < self->n_touched; i++) {
+		int v = self->touched[i];
+		for (int side = 0; side < 2; side++) {
+			self->dist[side][v] = INT_MAX;
+			self->pred_v[side][v] = -1;
+			self->pred_edge[side][v] = -1;
+		}
+	}
+	self->n_touched = 0;
+	self->n_settled = 0;
+	pq_clear(&self->queue[0]);
+	pq_clear(&self->queue[1]);
+
+	int ends[2] = { source, destination };
+	for (int side = 0; side < 2; side++) {
+		if (self->dist[0][ends[side]] == INT_MAX && self->dist[1][ends[side]] == INT_MAX) {
+			self->touched[self->n_touched++] = ends[side];
+		}
+		self->dist[side][ends[side]] = 0;
+		pq_insert(&self->queue[side], ends[side], 0);
+	}
+
+	long long best = INT_MAX;
+	int peak = -1;
+	STATS_LOCAL(n_relaxed);
+	while (true) {
+		// Side with the closer frontier (a side is done once its frontier is no closer than the best path)
+		int side = -1;
+		int side_key = INT_MAX;
+		for (int s = 0; s < 2; s++) {
+			int key;
+			if (pq_peek_min(&self->queue[s], &key) != -1 && key < best && key < side_key) {
+				side = s;
+				side_key = key;
+			}
+		}
+		if (side == -1) {
+			break;
+		}
+
+		int* dist = self->dist[side];
+		int u = pq_pop_min(&self->queue[side], NULL);
+		self->n_settled++;
+
+		// Both searches reached u
+		if (self->dist[1 - side][u] != INT_MAX && (long long)dist[u] + self->dist[1 - side][u] < best) {
+			best = (long long)dist[u] + self->dist[1 - side][u];
+			peak = u;
+		}
+
+		for (int e = up->offsets[u]; e < up->offsets[u + 1]; e++) {
+			int v = up->to_vertex[e];
+			int alt = dist[u] + up->weight[e];
+			STATS_INC(n_relaxed);
+			if (alt >= dist[v]) {
+				continue;
+			}
+			if (self->dist[0][v] == INT_MAX && self->dist[1][v] == INT_MAX) {
+				self->touched[self->n_touched++] = v;
+			}
+			dist[v] = alt;
+			self->pred_v[side][v] = u;
+			self->pred_edge[side][v] = e;
+			if (pq_contains(&self->queue[side], v)) {
+				pq_decrease_key(&self->queue[side], v, alt);
+			}
+			else {
+				pq_insert(&self->queue[side], v, alt);
+			}
+		}
+	}
+
+	STATS_COUNT(STAT_SEARCHES, 1);
+	STATS_COUNT(STAT_SETTLED, self->n_settled);
+	STATS_COUNT(STAT_RELAXED, n_relaxed);
+
+	*distance = (int)best;
+	return peak;
+}
+
+/* Shortest distance between 2 vertices
+ * Parameters:
+ *		self			HierarchyQuery instance
+ *		source			source vertex
+ *		destination		destination vertex
+ * Return: distance (INT_MAX if unreachable)
+ */
+int hierarchy_distance(HierarchyQuery* self, int source, int destination) {
+	int distance;
+	upward_search(self, source, destination, &distance);
+	return distance;
+}
+
+/* Position of the up edge from v to u (binary search, rows are sorted by to-vertex) */
+static int find_up_edge(CSRGraph* up, int v, int u) {
+	int low = up->offsets[v];
+	int high = up->offsets[v + 1] - 1;
+	while (low <= high) {
+		int middle = low + (high - low) / 2;
+		if (up->to_vertex[middle] < u) {
+			low = middle + 1;
+		}
+		else if (up->to_vertex[middle] > u) {
+			high = middle - 1;
+		}
+		else {
+			return middle;
+		}
+	}
+	return -1;
+}
+
+/* Append a vertex at the end of a path */
+static void append_vertex(EdgeNodePtr* tail, int v, Arena* arena) {
+	EdgeNodePtr node = arena != NULL ? arena_alloc(arena, sizeof * node) : malloc(sizeof * node);
+	node->edge.to_vertex = v;
+	node->edge.weight = 0;
+	node->next = NULL;
+	(*tail)->next = node;
+	*tail = node;
+}
+
+/* Append the routes of edge e (from --> to) to a path, unpacking shortcuts into the 2 edges they skip */
+static void unpack_edge(ContractionHierarchy* hierarchy, int from, int to, int e, EdgeNodePtr* tail, Arena* arena) {
+	int middle = hierarchy->middle[e];
+	if (middle == -1) {
+		append_vertex(tail, to, arena);
+		return;
+	}
+
+	// The skipped vertex has lower rank than both ends, so both halves are up edges of it
+	unpack_edge(hierarchy, from, middle, find_up_edge(&hierarchy->up, middle, from), tail, arena);
+	unpack_edge(hierarchy, middle, to, find_up_edge(&hierarchy->up, middle, to), tail, arena);
+}
+
+/* Shortest path between 2 vertices (shortcuts unpacked into routes of the map)
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			HierarchyQuery instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (can be NULL, INT_MAX if unreachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path, from source to destination (empty if unreachable)
+ */
+EdgeList hierarchy_path(HierarchyQuery* self, int source, int destination, int* distance, Arena* arena) {
+	int path_distance;
+	int peak = upward_search(self, source, destination, &path_distance);
+	if (distance != NULL) {
+		*distance = path_distance;
+	}
+
+	EdgeList path;
+	path.head = NULL;
+	if (peak == -1) {
+		return path;
+	}
+
+	EdgeNodePtr head = arena != NULL ? arena_alloc(arena, sizeof * head) : malloc(sizeof * head);
+	head->edge.to_vertex = source;
+	head->edge.weight = 0;
+	head->next = NULL;
+	path.head = head;
+	EdgeNodePtr tail = head;
+
+	// Source up to the peak (forward predecessors, collected backwards first)
+	int n_chain = 0;
+	for (int v = peak; self->pred_v[0][v] != -1; v = self->pred_v[0][v]) {
+		self->chain[n_chain++] = v;
+	}
+	for (int i = n_chain - 1; i >= 0; i--) {
+		int v = self->chain[i];
+		unpack_edge(self->hierarchy, self->pred_v[0][v], v, self->pred_edge[0][v], &tail, arena);
+	}
+
+	// Peak down to the destination (backward predecessors)
+	for (int v = peak; self->pred_v[1][v] != -1; v = self->pred_v[1][v]) {
+		unpack_edge(self->hierarchy, v, self->pred_v[1][v], self->pred_edge[1][v], &tail, arena);
+	}
+
+	return path;
+}
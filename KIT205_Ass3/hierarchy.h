@@ -0,0 +1,108 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "pqueue.h"
+
+// Witness searches settle at most this many vertices, along paths of at most this many edges
+//		(a missed witness only adds an unneeded shortcut)
+#define HIERARCHY_WITNESS_LIMIT 500
+#define HIERARCHY_WITNESS_HOPS 5
+
+// Contraction stops once the vertices left have this many edges each on average (they become the core)
+#define HIERARCHY_CORE_DEGREE 16
+
+/* Contraction hierarchy of a map
+ *		Vertices are contracted 1 at a time (rank[v] = position in that order), each adding shortcut edges between
+ *		its remaining neighbours where it was on their only shortest path
+ *		up holds every edge (original or shortcut) from lower to higher rank, rows sorted by to-vertex
+ *		The core (vertices left once the rest of the map is too dense to contract) takes the highest ranks, and
+ *		keeps its edges to itself in both directions in up
+ *		middle[e] is the vertex a shortcut up edge e skips (-1 for an original edge)
+ *		Any shortest path goes up in rank, through the core, then down, so a query only searches upward from both
+ *		ends (and through the core like a two-way Dijkstra search)
+ *		For a static map: a changed route needs a new hierarchy
+ */
+typedef struct contractionHierarchy {
+	int V;
+	int* rank;
+	CSRGraph up;
+	int* middle;
+} ContractionHierarchy;
+
+/* Reusable state of queries on a hierarchy (1 per thread)
+ *		Index 0 is the search from the source, 1 the search from the destination
+ *		pred_edge[side][v] is the up edge used to reach v (-1 at the start of the search)
+ *		Only vertices a query reached are listed in touched[] and reset by the next one
+ *		n_settled counts the vertices visited by the last query
+ */
+typedef struct hierarchyQuery {
+	ContractionHierarchy* hierarchy;
+	int* dist[2];
+	int* pred_v[2];
+	int* pred_edge[2];
+	PQueue queue[2];
+	int* touched;
+	int n_touched;
+	int* chain;
+	int n_settled;
+} HierarchyQuery;
+
+
+/* Build a contraction hierarchy of a map
+ *		Vertices are contracted in order of twice the edge difference (shortcuts added - edges removed) plus
+ *		contracted neighbours, updated lazily, until the ones left average HIERARCHY_CORE_DEGREE edges (the core)
+ * Parameters:
+ *		map			CSRGraph instance
+ * Return: ContractionHierarchy
+ */
+ContractionHierarchy build_hierarchy(CSRGraph* map);
+
+
+/* Destroy a contraction hierarchy (free all memory, or unmap its file)
+ * Parameters:
+ *		self		ContractionHierarchy instance
+ * Return: void
+ */
+void destroy_hierarchy(ContractionHierarchy* self);
+
+
+/* Create the state of queries on a hierarchy
+ * Parameters:
+ *		hierarchy		ContractionHierarchy instance (must outlive the query)
+ * Return: HierarchyQuery
+ */
+HierarchyQuery create_hierarchy_query(ContractionHierarchy* hierarchy);
+
+
+/* Destroy the state of queries on a hierarchy (free all memory)
+ * Parameters:
+ *		self		HierarchyQuery instance
+ * Return: void
+ */
+void destroy_hierarchy_query(HierarchyQuery* self);
+
+
+/* Shortest distance between 2 vertices
+ * Parameters:
+ *		self			HierarchyQuery instance
+ *		source			source vertex
+ *		destination		destination vertex
+ * Return: distance (INT_MAX if unreachable)
+ */
+int hierarchy_distance(HierarchyQuery* self, int source, int destination);
+
+
+/* Shortest path between 2 vertices (shortcuts unpacked into routes of the map)
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			HierarchyQuery instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (can be NULL, INT_MAX if unreachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path, from source to destination (empty if unreachable)
+ */
+EdgeList hierarchy_path(HierarchyQuery* self, int source, int destination, int* distance, Arena* arena);
+#endif
@@ -0,0 +1,893 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include "graph.h"
+#include "longest_trail.h"
+#include "stats.h"
+
+// Steps of a search between reads of the longest trail found by the other threads
+#define TRAIL_REFRESH_STEPS 1024
+
+// Bound from the lightest edges that can join up the odd-degree cities only for at most this many of them
+//		(memoised in a table of 2^n entries per thread), and only where the cheaper bounds cannot cut the branch
+#define TRAIL_MATCHING_LIMIT 16
+
+// Slots (power of 2) of a search's table of states already searched, and slots probed before one is replaced
+#define TRAIL_MEMO_SLOTS 65536
+#define TRAIL_MEMO_PROBES 8
+
+/* Claimed routes, renumbered to the cities they touch (so the search never costs O(V)), and reduced:
+ *		A chain of routes through cities with 2 routes is 1 edge (a longest trail uses all of it or none of it),
+ *		and only the 2 heaviest dead-end edges at a city are kept (a trail uses at most 2 dead ends)
+ *		Edge e joins from[e] and to[e] (from[e] == to[e] for a loop), incident[offsets[v] .. offsets[v + 1]) are
+ *		the edges of local vertex v (heaviest first, a loop listed twice)
+ *		chain_vertex[chain_first[e] .. chain_last[e]] are the cities along edge e from from[e] to to[e],
+ *		chain_weight[c] is the weight of the route into chain_vertex[c]
+ *		by_weight[] lists the edges from lightest to heaviest
+ *		n_words is the number of 64-bit words in a bitset of the edges
+ */
+typedef struct trailGraph {
+	int n_vertices;
+	int* global;
+	int n_edges;
+	int* from;
+	int* to;
+	int* weight;
+	int* chain_first;
+	int* chain_last;
+	int* chain_vertex;
+	int* chain_weight;
+	int* offsets;
+	int* incident;
+	int* by_weight;
+	int n_words;
+} TrailGraph;
+
+/* Search state of 1 thread
+ *		At depth d the trail is at vertex[d], reached along edge edge[d], with cursor[d] the next incident edge to try
+ *		memo[] holds states already searched (TRAIL_MEMO_SLOTS slots of n_words + 1 words: the edges used, then the
+ *		vertex + 1, 0 if empty): a trail reaching the same vertex with the same edges used has the same length,
+ *		so it can add nothing new
+ *		The other arrays are the scratch of trail_bound() (seen[v] == stamp: v visited by the current bound)
+ *		best_length is this search's copy of the shared best, refreshed every TRAIL_REFRESH_STEPS steps
+ */
+typedef struct trailSearch {
+	uint64_t* used;
+	uint64_t* reach;
+	uint64_t* bridge;
+	uint64_t* memo;
+	int* vertex;
+	int* edge;
+	int* cursor;
+	int* seen;
+	int* order;
+	int* disc;
+	int* low;
+	int* parent_edge;
+	int* stack;
+	int* stack_cursor;
+	int* block;
+	int* block_weight;
+	int* block_extra;
+	int* odd;
+	int* dist;
+	int* label;
+	int* settled;
+	int* nearest;
+	int* ends;
+	int* end_dist;
+	int* matching;
+	int* matching_stamp;
+	int stamp;
+	int best_length;
+	int steps;
+} TrailSearch;
+
+/* Longest trail found so far (shared by the threads, written in a critical section) */
+typedef struct trailBest {
+	int length;
+	int start;
+	int n_edges;
+	int* edges;
+} TrailBest;
+
+
+/* Compare routes for qsort() (weight in the high 32 bits, route in the low 32 bits) */
+static int compare_route_keys(const void* a, const void* b) {
+	int64_t x = *(const int64_t*)a;
+	int64_t y = *(const int64_t*)b;
+	return (x > y) - (x < y);
+}
+
+/* Incidence lists of edges (counting sort by vertex, each edge listed at both ends), heaviest first */
+static void build_incidence(int n_vertices, int n_edges, int from[], int to[], int weight[], int* offsets, int* incident) {
+	for (int v = 0; v <= n_vertices; v++) {
+		offsets[v] = 0;
+	}
+	for (int e = 0; e < n_edges; e++) {
+		offsets[from[e] + 1]++;
+		offsets[to[e] + 1]++;
+	}
+	for (int v = 0; v < n_vertices; v++) {
+		offsets[v + 1] += offsets[v];
+	}
+	int* fill = malloc(sizeof(int) * (n_vertices > 0 ? n_vertices : 1));
+	memcpy(fill, offsets, sizeof(int) * n_vertices);
+	for (int e = 0; e < n_edges; e++) {
+		incident[fill[from[e]]++] = e;
+		incident[fill[to[e]]++] = e;
+	}
+	free(fill);
+
+	// Insertion sort of each list (lists are short)
+	for (int v = 0; v < n_vertices; v++) {
+		for (int i = offsets[v] + 1; i < offsets[v + 1]; i++) {
+			int e = incident[i];
+			int j = i;
+			while (j > offsets[v] && weight[incident[j - 1]] < weight[e]) {
+				incident[j] = incident[j - 1];
+				j--;
+			}
+			incident[j] = e;
+		}
+	}
+}
+
+/* Routes between local vertices, with their incidence lists */
+typedef struct routeLists {
+	int* from;
+	int* to;
+	int* weight;
+	int* offsets;
+	int* incident;
+} RouteLists;
+
+/* Add the edge that starts at city v with route r, and runs along cities with 2 routes until an end city */
+static void walk_chain(TrailGraph* graph, RouteLists* routes, bool end[], bool walked[], int v, int r, int* n_chain) {
+	int e = graph->n_edges++;
+	graph->from[e] = v;
+	graph->weight[e] = 0;
+	graph->chain_first[e] = *n_chain;
+	graph->chain_vertex[*n_chain] = v;
+	graph->chain_weight[(*n_chain)++] = 0;
+	while (true) {
+		walked[r] = true;
+		v = routes->from[r] == v ? routes->to[r] : routes->from[r];
+		graph->weight[e] += routes->weight[r];
+		graph->chain_vertex[*n_chain] = v;
+		graph->chain_weight[(*n_chain)++] = routes->weight[r];
+		if (end[v]) {
+			break;
+		}
+		int first = routes->incident[routes->offsets[v]];
+		r = first != r ? first : routes->incident[routes->offsets[v] + 1];
+	}
+	graph->to[e] = v;
+	graph->chain_last[e] = *n_chain - 1;
+}
+
+/* Collect the claimed routes (self-loops skipped), renumber their cities and reduce them to edges */
+static TrailGraph create_trail_graph(Graph* claimed) {
+	TrailGraph graph;
+	int V = claimed->V;
+	int* local = malloc(sizeof(int) * (V > 0 ? V : 1));
+	for (int v = 0; v < V; v++) {
+		local[v] = -1;
+	}
+
+	int n_routes = 0;
+	for (int v = 0; v < V; v++) {
+		for (EdgeNodePtr current = claimed->edges[v].head; current != NULL; current = current->next) {
+			if (current->edge.to_vertex != v) {
+				n_routes++;
+			}
+		}
+	}
+
+	// Routes, between local vertices
+	int size = n_routes > 0 ? n_routes : 1;
+	int* route_from = malloc(sizeof(int) * size);
+	int* route_to = malloc(sizeof(int) * size);
+	int* route_weight = malloc(sizeof(int) * size);
+	graph.global = malloc(sizeof(int) * 2 * size);
+	graph.n_vertices = 0;
+	n_routes = 0;
+	for (int v = 0; v < V; v++) {
+		for (EdgeNodePtr current = claimed->edges[v].head; current != NULL; current = current->next) {
+			int ends[2] = { v, current->edge.to_vertex };
+			if (ends[0] == ends[1]) {
+				continue;
+			}
+			for (int n = 0; n < 2; n++) {
+				if (local[ends[n]] == -1) {
+					local[ends[n]] = graph.n_vertices;
+					graph.global[graph.n_vertices++] = ends[n];
+				}
+			}
+			route_from[n_routes] = local[ends[0]];
+			route_to[n_routes] = local[ends[1]];
+			route_weight[n_routes++] = current->edge.weight;
+		}
+	}
+	free(local);
+	int n = graph.n_vertices;
+	int* route_offsets = malloc(sizeof(int) * ((size_t)n + 1));
+	int* route_incident = malloc(sizeof(int) * 2 * size);
+	build_incidence(n, n_routes, route_from, route_to, route_weight, route_offsets, route_incident);
+
+	// Edges: walk from each city without exactly 2 routes along the cities with 2 routes
+	//		(a cycle of cities with 2 routes each gets 1 of them as its end, so it becomes a loop)
+	RouteLists routes = { route_from, route_to, route_weight, route_offsets, route_incident };
+	graph.from = malloc(sizeof(int) * size);
+	graph.to = malloc(sizeof(int) * size);
+	graph.weight = malloc(sizeof(int) * size);
+	graph.chain_first = malloc(sizeof(int) * size);
+	graph.chain_last = malloc(sizeof(int) * size);
+	graph.chain_vertex = malloc(sizeof(int) * 2 * size);
+	graph.chain_weight = malloc(sizeof(int) * 2 * size);
+	graph.n_edges = 0;
+	bool* end = malloc(sizeof(bool) * (n > 0 ? n : 1));
+	bool* walked = calloc(size, sizeof(bool));
+	int n_chain = 0;
+	for (int v = 0; v < n; v++) {
+		end[v] = route_offsets[v + 1] - route_offsets[v] != 2;
+	}
+	for (int v = 0; v < n; v++) {
+		for (int i = route_offsets[v]; i < route_offsets[v + 1] && end[v]; i++) {
+			if (!walked[route_incident[i]]) {
+				walk_chain(&graph, &routes, end, walked, v, route_incident[i], &n_chain);
+			}
+		}
+	}
+	for (int r = 0; r < n_routes; r++) {
+		if (!walked[r]) {
+			end[route_from[r]] = true;
+			walk_chain(&graph, &routes, end, walked, route_from[r], r, &n_chain);
+		}
+	}
+	free(walked);
+	free(route_from);
+	free(route_to);
+	free(route_weight);
+	free(route_offsets);
+	free(route_incident);
+
+	// Dead ends (edges to a city with 1 route): keep the 2 heaviest at each city
+	//		graph.offsets / incident are built twice: for the edges found above, then for those kept
+	graph.offsets = malloc(sizeof(int) * ((size_t)n + 1));
+	graph.incident = malloc(sizeof(int) * 2 * size);
+	build_incidence(n, graph.n_edges, graph.from, graph.to, graph.weight, graph.offsets, graph.incident);
+	bool* dropped = calloc(size, sizeof(bool));
+	for (int v = 0; v < n; v++) {
+		int n_dead_ends = 0;
+		for (int i = graph.offsets[v]; i < graph.offsets[v + 1]; i++) {
+			int e = graph.incident[i];
+			int other = graph.from[e] == v ? graph.to[e] : graph.from[e];
+			if (other != v && graph.offsets[other + 1] - graph.offsets[other] == 1
+				&& graph.offsets[v + 1] - graph.offsets[v] > 1 && n_dead_ends++ >= 2) {
+				dropped[e] = true;
+			}
+		}
+	}
+	int kept = 0;
+	for (int e = 0; e < graph.n_edges; e++) {
+		if (dropped[e]) {
+			continue;
+		}
+		graph.from[kept] = graph.from[e];
+		graph.to[kept] = graph.to[e];
+		graph.weight[kept] = graph.weight[e];
+		graph.chain_first[kept] = graph.chain_first[e];
+		graph.chain_last[kept] = graph.chain_last[e];
+		kept++;
+	}
+	free(dropped);
+	free(end);
+	graph.n_edges = kept;
+	build_incidence(n, graph.n_edges, graph.from, graph.to, graph.weight, graph.offsets, graph.incident);
+
+	int64_t* keys = malloc(sizeof(int64_t) * size);
+	for (int e = 0; e < graph.n_edges; e++) {
+		keys[e] = ((int64_t)graph.weight[e] << 32) | e;
+	}
+	qsort(keys, graph.n_edges, sizeof(int64_t), compare_route_keys);
+	graph.by_weight = malloc(sizeof(int) * size);
+	for (int e = 0; e < graph.n_edges; e++) {
+		graph.by_weight[e] = (int)(keys[e] & 0xffffffff);
+	}
+	free(keys);
+
+	graph.n_words = (graph.n_edges + 63) / 64;
+	return graph;
+}
+
+static void destroy_trail_graph(TrailGraph* self) {
+	free(self->global);
+	free(self->from);
+	free(self->to);
+	free(self->weight);
+	free(self->chain_first);
+	free(self->chain_last);
+	free(self->chain_vertex);
+	free(self->chain_weight);
+	free(self->offsets);
+	free(self->incident);
+	free(self->by_weight);
+}
+
+static TrailSearch create_trail_search(TrailGraph* graph) {
+	TrailSearch search;
+	int words = graph->n_words > 0 ? graph->n_words : 1;
+	int vertices = graph->n_vertices > 0 ? graph->n_vertices : 1;
+	search.used = calloc(words, sizeof(uint64_t));
+	search.reach = calloc(words, sizeof(uint64_t));
+	search.bridge = calloc(words, sizeof(uint64_t));
+	search.memo = calloc((size_t)TRAIL_MEMO_SLOTS * (graph->n_words + 1), sizeof(uint64_t));
+	search.vertex = malloc(sizeof(int) * ((size_t)graph->n_edges + 1));
+	search.edge = malloc(sizeof(int) * ((size_t)graph->n_edges + 1));
+	search.cursor = malloc(sizeof(int) * ((size_t)graph->n_edges + 1));
+	search.seen = calloc(vertices, sizeof(int));
+	search.order = malloc(sizeof(int) * vertices);
+	search.disc = malloc(sizeof(int) * vertices);
+	search.low = malloc(sizeof(int) * vertices);
+	search.parent_edge = malloc(sizeof(int) * vertices);
+	search.stack = malloc(sizeof(int) * vertices);
+	search.stack_cursor = malloc(sizeof(int) * vertices);
+	search.block = malloc(sizeof(int) * vertices);
+	search.block_weight = malloc(sizeof(int) * vertices);
+	search.block_extra = malloc(sizeof(int) * vertices);
+	search.odd = malloc(sizeof(int) * vertices);
+	search.dist = malloc(sizeof(int) * vertices);
+	search.label = malloc(sizeof(int) * vertices);
+	search.settled = malloc(sizeof(int) * vertices);
+	search.nearest = malloc(sizeof(int) * vertices);
+	search.ends = malloc(sizeof(int) * TRAIL_MATCHING_LIMIT);
+	search.end_dist = malloc(sizeof(int) * TRAIL_MATCHING_LIMIT * TRAIL_MATCHING_LIMIT);
+	search.matching = malloc(sizeof(int) << TRAIL_MATCHING_LIMIT);
+	search.matching_stamp = calloc((size_t)1 << TRAIL_MATCHING_LIMIT, sizeof(int));
+	search.stamp = 0;
+	search.best_length = -1;
+	search.steps = 0;
+	return search;
+}
+
+static void destroy_trail_search(TrailSearch* self) {
+	free(self->used);
+	free(self->reach);
+	free(self->bridge);
+	free(self->memo);
+	free(self->vertex);
+	free(self->edge);
+	free(self->cursor);
+	free(self->seen);
+	free(self->order);
+	free(self->disc);
+	free(self->low);
+	free(self->parent_edge);
+	free(self->stack);
+	free(self->stack_cursor);
+	free(self->block);
+	free(self->block_weight);
+	free(self->block_extra);
+	free(self->odd);
+	free(self->dist);
+	free(self->label);
+	free(self->settled);
+	free(self->nearest);
+	free(self->ends);
+	free(self->end_dist);
+	free(self->matching);
+	free(self->matching_stamp);
+}
+
+#define BIT_IS_SET(bits, e) (((bits)[(e) >> 6] >> ((e) & 63)) & 1)
+#define SET_BIT(bits, e) ((bits)[(e) >> 6] |= (uint64_t)1 << ((e) & 63))
+#define CLEAR_BIT(bits, e) ((bits)[(e) >> 6] &= ~((uint64_t)1 << ((e) & 63)))
+
+/* Distances along unused edges between the vertices of the current bound (dijkstra over an array, the graph is
+ *		small), from the vertices with dist[] 0, label[] = the one each vertex is nearest to
+ */
+static void unused_distances(TrailGraph* graph, TrailSearch* search, int n_visited) {
+	for (int n = 0; n < n_visited; n++) {
+		int x = -1;
+		for (int i = 0; i < n_visited; i++) {
+			int y = search->order[i];
+			if (!search->settled[y] && (x == -1 || search->dist[y] < search->dist[x])) {
+				x = y;
+			}
+		}
+		search->settled[x] = true;
+		for (int j = graph->offsets[x]; j < graph->offsets[x + 1]; j++) {
+			int e = graph->incident[j];
+			int y = graph->from[e] == x ? graph->to[e] : graph->from[e];
+			if (!BIT_IS_SET(search->used, e) && search->dist[x] + graph->weight[e] < search->dist[y]) {
+				search->dist[y] = search->dist[x] + graph->weight[e];
+				search->label[y] = search->label[x];
+			}
+		}
+	}
+}
+
+/* Lightest joining in pairs of the ends in set (bit a: ends[a]), 1 left out if there is an odd number of them
+ *		The lowest end is left out or joined to another, so only some of the 2^n sets are ever reached (memoised
+ *		in matching[], valid where matching_stamp[set] == stamp)
+ */
+static int join_ends(TrailSearch* search, int n_ends, int set) {
+	if (set == 0) {
+		return 0;
+	}
+	if (search->matching_stamp[set] == search->stamp) {
+		return search->matching[set];
+	}
+
+	int a = 0;
+	while (!(set & (1 << a))) {
+		a++;
+	}
+	int n_set = 0;
+	for (int rest = set; rest != 0; rest &= rest - 1) {
+		n_set++;
+	}
+	int lightest = n_set & 1 ? join_ends(search, n_ends, set ^ (1 << a)) : INT_MAX;
+	for (int b = a + 1; b < n_ends; b++) {
+		if (set & (1 << b)) {
+			int joined = search->end_dist[a * n_ends + b] + join_ends(search, n_ends, set ^ (1 << a) ^ (1 << b));
+			if (joined < lightest) {
+				lightest = joined;
+			}
+		}
+	}
+
+	search->matching_stamp[set] = search->stamp;
+	search->matching[set] = lightest;
+	return lightest;
+}
+
+/* Most weight a trail from v can still add, the smaller of 2 bounds on the unused edges reachable from v:
+ *		Parity: all of them, less those a trail must leave out (the edges left join up in pairs the odd-degree
+ *		cities other than its ends, so there are at least half as many, each city at least as far as the nearest
+ *		other of those cities)
+ *		Bridges: a trail that crosses a bridge never comes back, so it covers at most the heaviest path of blocks
+ *		(2-edge-connected components) and bridges down the bridge tree from the block of v
+ *		Matching: the edges left out weigh at least a minimum matching of those odd-degree cities by distance (only
+ *		if the others are above target, as it is far slower)
+ */
+static int trail_bound(TrailGraph* graph, TrailSearch* search, int v, int target) {
+	search->stamp++;
+	memset(search->reach, 0, sizeof(uint64_t) * graph->n_words);
+	memset(search->bridge, 0, sizeof(uint64_t) * graph->n_words);
+
+	// Bridges (Tarjan's low links, iterative depth-first search), vertices listed in order of discovery
+	int n_visited = 0;
+	int top = 0;
+	search->seen[v] = search->stamp;
+	search->disc[v] = search->low[v] = 0;
+	search->parent_edge[v] = -1;
+	search->order[n_visited++] = v;
+	search->stack[top] = v;
+	search->stack_cursor[top++] = graph->offsets[v];
+	while (top > 0) {
+		int x = search->stack[top - 1];
+		if (search->stack_cursor[top - 1] < graph->offsets[x + 1]) {
+			int e = graph->incident[search->stack_cursor[top - 1]++];
+			if (BIT_IS_SET(search->used, e) || e == search->parent_edge[x]) {
+				continue;
+			}
+			int y = graph->from[e] == x ? graph->to[e] : graph->from[e];
+			if (search->seen[y] != search->stamp) {
+				search->seen[y] = search->stamp;
+				search->disc[y] = search->low[y] = n_visited;
+				search->parent_edge[y] = e;
+				search->order[n_visited++] = y;
+				search->stack[top] = y;
+				search->stack_cursor[top++] = graph->offsets[y];
+			}
+			else if (search->disc[y] < search->low[x]) {
+				search->low[x] = search->disc[y];
+			}
+			continue;
+		}
+
+		top--;
+		if (top > 0) {
+			int parent = search->stack[top - 1];
+			if (search->low[x] < search->low[parent]) {
+				search->low[parent] = search->low[x];
+			}
+			if (search->low[x] > search->disc[parent]) {
+				SET_BIT(search->bridge, search->parent_edge[x]);
+			}
+		}
+	}
+
+	// Blocks: vertices joined by edges other than bridges (a block starts at its first vertex discovered)
+	for (int i = 0; i < n_visited; i++) {
+		search->block[search->order[i]] = -1;
+	}
+	int n_blocks = 0;
+	for (int i = 0; i < n_visited; i++) {
+		if (search->block[search->order[i]] != -1) {
+			continue;
+		}
+		search->block_weight[n_blocks] = 0;
+		search->block_extra[n_blocks] = 0;
+		search->block[search->order[i]] = n_blocks;
+		top = 0;
+		search->stack[top++] = search->order[i];
+		while (top > 0) {
+			int x = search->stack[--top];
+			for (int j = graph->offsets[x]; j < graph->offsets[x + 1]; j++) {
+				int e = graph->incident[j];
+				int y = graph->from[e] == x ? graph->to[e] : graph->from[e];
+				if (!BIT_IS_SET(search->used, e) && !BIT_IS_SET(search->bridge, e) && search->block[y] == -1) {
+					search->block[y] = n_blocks;
+					search->stack[top++] = y;
+				}
+			}
+		}
+		n_blocks++;
+	}
+
+	// Edge weights: reachable total, per block (each edge seen from both ends, so counted twice), parity
+	int reachable = 0;
+	int n_odd = 0;
+	int v_odd = 0;
+	for (int i = 0; i < n_visited; i++) {
+		int x = search->order[i];
+		int degree = 0;
+		for (int j = graph->offsets[x]; j < graph->offsets[x + 1]; j++) {
+			int e = graph->incident[j];
+			if (BIT_IS_SET(search->used, e)) {
+				continue;
+			}
+			degree++;
+			if (!BIT_IS_SET(search->reach, e)) {
+				SET_BIT(search->reach, e);
+				reachable += graph->weight[e];
+			}
+			if (!BIT_IS_SET(search->bridge, e)) {
+				search->block_weight[search->block[x]] += graph->weight[e];
+			}
+		}
+		search->odd[x] = degree & 1;
+		n_odd += degree & 1;
+	}
+	v_odd = search->odd[v];
+
+	// Distance from each odd-degree city (and v) to the nearest other: Dijkstra from all of them at once, then
+	//		each edge between 2 of their regions joins the 2 cities it is labelled with
+	for (int i = 0; i < n_visited; i++) {
+		int x = search->order[i];
+		bool end = search->odd[x] || x == v;
+		search->dist[x] = end ? 0 : INT_MAX;
+		search->label[x] = end ? x : -1;
+		search->settled[x] = false;
+		search->nearest[x] = INT_MAX;
+	}
+	unused_distances(graph, search, n_visited);
+	for (int i = 0; i < n_visited; i++) {
+		int x = search->order[i];
+		for (int j = graph->offsets[x]; j < graph->offsets[x + 1]; j++) {
+			int e = graph->incident[j];
+			int y = graph->from[e] == x ? graph->to[e] : graph->from[e];
+			int joined = search->dist[x] + graph->weight[e] + search->dist[y];
+			if (!BIT_IS_SET(search->used, e) && search->label[x] != search->label[y] && joined < search->nearest[search->label[x]]) {
+				search->nearest[search->label[x]] = joined;
+			}
+		}
+	}
+	int nearest_total = 0;
+	int nearest_max = 0;
+	for (int i = 0; i < n_visited; i++) {
+		int x = search->order[i];
+		if (search->odd[x] && x != v) {
+			nearest_total += search->nearest[x];
+			if (search->nearest[x] > nearest_max) {
+				nearest_max = search->nearest[x];
+			}
+		}
+	}
+
+	// The cities joined are the odd-degree ones except the 2 ends: v, and an odd-degree city (the trail cannot
+	//		be extended past the other end), or v again (a closed trail), v joined too if it was even and is not
+	int left_out = 0;
+	int n_left_out = (n_odd - (v_odd ? 2 : 0)) / 2;
+	for (int i = 0; i < graph->n_edges && n_left_out > 0; i++) {
+		int e = graph->by_weight[i];
+		if (BIT_IS_SET(search->reach, e)) {
+			left_out += graph->weight[e];
+			n_left_out--;
+		}
+	}
+	int joining = nearest_total - nearest_max;
+	if (!v_odd) {
+		joining += search->nearest[v] < nearest_max ? search->nearest[v] : nearest_max;
+	}
+	if ((joining + 1) / 2 > left_out) {
+		left_out = (joining + 1) / 2;
+	}
+	int parity_bound = reachable - left_out;
+
+	// Heaviest path down the bridge tree (a block's subtree is discovered after the vertex it is entered at)
+	for (int i = n_visited - 1; i > 0; i--) {
+		int x = search->order[i];
+		int e = search->parent_edge[x];
+		if (!BIT_IS_SET(search->bridge, e)) {
+			continue;
+		}
+		int parent = graph->from[e] == x ? graph->to[e] : graph->from[e];
+		int below = graph->weight[e] + search->block_weight[search->block[x]] / 2 + search->block_extra[search->block[x]];
+		if (below > search->block_extra[search->block[parent]]) {
+			search->block_extra[search->block[parent]] = below;
+		}
+	}
+	int bridge_bound = search->block_weight[search->block[v]] / 2 + search->block_extra[search->block[v]];
+
+	int bound = parity_bound < bridge_bound ? parity_bound : bridge_bound;
+	if (bound <= target) {
+		return bound;
+	}
+
+	// Cities to join: the odd-degree ones and v (a trail from an odd-degree v takes it out, from an even one
+	//		makes it odd), less 1 of them: the other end (or v again, for a closed trail)
+	int n_ends = 0;
+	for (int i = 0; i < n_visited; i++) {
+		int x = search->order[i];
+		if (search->odd[x] != (x == v)) {
+			if (n_ends == TRAIL_MATCHING_LIMIT) {
+				return bound;
+			}
+			search->ends[n_ends++] = x;
+		}
+	}
+	if (n_ends <= 1) {
+		return bound;
+	}
+	for (int a = 0; a < n_ends; a++) {
+		for (int i = 0; i < n_visited; i++) {
+			int x = search->order[i];
+			search->dist[x] = x == search->ends[a] ? 0 : INT_MAX;
+			search->settled[x] = false;
+		}
+		unused_distances(graph, search, n_visited);
+		for (int b = 0; b < n_ends; b++) {
+			search->end_dist[a * n_ends + b] = search->dist[search->ends[b]];
+		}
+	}
+
+	int matching_bound = reachable - join_ends(search, n_ends, (1 << n_ends) - 1);
+
+	return matching_bound < bound ? matching_bound : bound;
+}
+
+/* Whether the trail has reached vertex v with these edges used before, remember it if not (the table is lossy:
+ *		a state can be replaced by a later one, and is then searched again if reached again)
+ */
+static bool searched_before(TrailGraph* graph, TrailSearch* search, int v) {
+	int words = graph->n_words;
+	uint64_t hash = (uint64_t)v * 0x9e3779b97f4a7c15ULL;
+	for (int i = 0; i < words; i++) {
+		hash = (hash ^ search->used[i]) * 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 29;
+	}
+
+	uint64_t* replaced = NULL;
+	for (int probe = 0; probe < TRAIL_MEMO_PROBES; probe++) {
+		uint64_t* slot = search->memo + ((hash + probe) & (TRAIL_MEMO_SLOTS - 1)) * (words + 1);
+		if (slot[words] == 0) {
+			replaced = slot;
+			break;
+		}
+		if (slot[words] == (uint64_t)v + 1 && memcmp(slot, search->used, sizeof(uint64_t) * words) == 0) {
+			return true;
+		}
+		if (replaced == NULL) {
+			replaced = slot;
+		}
+	}
+	memcpy(replaced, search->used, sizeof(uint64_t) * words);
+	replaced[words] = (uint64_t)v + 1;
+	return false;
+}
+
+/* Update the search's copy of the longest trail found by any thread */
+static void refresh_best(TrailBest* best, TrailSearch* search) {
+	#pragma omp critical(longest_trail)
+	{
+		search->best_length = best->length;
+	}
+}
+
+/* Keep the current trail if it is still the longest */
+static void record_trail(TrailBest* best, TrailSearch* search, int depth, int length) {
+	#pragma omp critical(longest_trail)
+	{
+		if (length > best->length) {
+			best->length = length;
+			best->start = search->vertex[0];
+			best->n_edges = depth;
+			for (int d = 1; d <= depth; d++) {
+				best->edges[d - 1] = search->edge[d];
+			}
+		}
+		search->best_length = best->length;
+	}
+}
+
+/* Depth-first search of the trails from 1 start (iterative, a trail can be as deep as the number of routes) */
+static void search_trails(TrailGraph* graph, TrailSearch* search, int start, TrailBest* best) {
+	refresh_best(best, search);
+	if (trail_bound(graph, search, start, search->best_length) <= search->best_length) {
+		return;
+	}
+
+	int depth = 0;
+	int length = 0;
+	search->vertex[0] = start;
+	search->edge[0] = -1;
+	search->cursor[0] = graph->offsets[start];
+	while (depth >= 0) {
+		int v = search->vertex[depth];
+
+		// Every route from v tried: step back
+		if (search->cursor[depth] == graph->offsets[v + 1]) {
+			if (depth > 0) {
+				CLEAR_BIT(search->used, search->edge[depth]);
+				length -= graph->weight[search->edge[depth]];
+			}
+			depth--;
+			continue;
+		}
+
+		int e = graph->incident[search->cursor[depth]++];
+		if (BIT_IS_SET(search->used, e)) {
+			continue;
+		}
+		int u = graph->from[e] == v ? graph->to[e] : graph->from[e];
+		SET_BIT(search->used, e);
+		length += graph->weight[e];
+		depth++;
+		search->vertex[depth] = u;
+		search->edge[depth] = e;
+		search->cursor[depth] = graph->offsets[u];
+
+		if (++search->steps == TRAIL_REFRESH_STEPS) {
+			search->steps = 0;
+			refresh_best(best, search);
+		}
+		if (length > search->best_length) {
+			record_trail(best, search, depth, length);
+		}
+		// Searched from here before, or cannot beat the best trail from here: skip every edge from u
+		if (searched_before(graph, search, u) || length + trail_bound(graph, search, u, search->best_length - length) <= search->best_length) {
+			search->cursor[depth] = graph->offsets[u + 1];
+		}
+	}
+}
+
+
+/* Add a city to the end of a trail, return its node */
+static EdgeNodePtr append_trail_city(EdgeList* trail, EdgeNodePtr tail, int v, int weight, Arena* arena) {
+	EdgeNodePtr node = arena != NULL ? arena_alloc(arena, sizeof * node) : malloc(sizeof * node);
+	node->edge.to_vertex = v;
+	node->edge.weight = weight;
+	node->next = NULL;
+	if (tail == NULL) {
+		trail->head = node;
+	}
+	else {
+		tail->next = node;
+	}
+	return node;
+}
+
+
+/* Longest trail (continuous route that never uses a route twice) in the routes a player has claimed
+ *		A longest trail cannot be extended, so it either ends at an odd-degree city, or is closed and uses every
+ *		route of its component (which then has no odd-degree city): those are the only starts searched
+ * Parameters:
+ *		claimed		Graph of claimed routes, each route stored once (as the solvers return them)
+ *		length		pointer to variable storing the total weight of the trail (can be NULL)
+ *		arena		Arena to allocate trail nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the trail, from one end to the other, weight = route taken to reach the
+ *		vertex (empty if there are no routes)
+ */
+EdgeList longest_trail(Graph* claimed, int* length, Arena* arena) {
+	STATS_BEGIN("longest_trail");
+	TrailGraph graph = create_trail_graph(claimed);
+	int n = graph.n_vertices;
+
+	// Components (labelled by a search from their first vertex), with their odd-degree cities as starts
+	int* component = malloc(sizeof(int) * (n > 0 ? n : 1));
+	int* starts = malloc(sizeof(int) * (n > 0 ? n : 1));
+	int n_starts = 0;
+	for (int v = 0; v < n; v++) {
+		component[v] = -1;
+	}
+	for (int root = 0; root < n; root++) {
+		if (component[root] != -1 || graph.offsets[root] == graph.offsets[root + 1]) {
+			continue;
+		}
+		int first_start = n_starts;
+		int head = 0;
+		int tail = 0;
+		int* queue = starts + n_starts;		// members are queued in place, odd ones kept as starts below
+		queue[tail++] = root;
+		component[root] = root;
+		while (head < tail) {
+			int x = queue[head++];
+			for (int i = graph.offsets[x]; i < graph.offsets[x + 1]; i++) {
+				int e = graph.incident[i];
+				int y = graph.from[e] == x ? graph.to[e] : graph.from[e];
+				if (component[y] == -1) {
+					component[y] = root;
+					queue[tail++] = y;
+				}
+			}
+		}
+		for (int i = 0; i < tail; i++) {
+			int x = queue[i];
+			if ((graph.offsets[x + 1] - graph.offsets[x]) & 1) {
+				starts[n_starts++] = x;
+			}
+		}
+		if (n_starts == first_start) {
+			starts[n_starts++] = root;
+		}
+	}
+
+	TrailBest best;
+	best.length = -1;
+	best.start = -1;
+	best.n_edges = 0;
+	best.edges = malloc(sizeof(int) * (graph.n_edges > 0 ? graph.n_edges : 1));
+
+	// Starts can take very different times (most are cut at once by the bound), so hand them out 1 at a time
+	//		A thread keeps its search state (and the states it has searched) from 1 start to the next
+	#pragma omp parallel
+	{
+		TrailSearch search = create_trail_search(&graph);
+		#pragma omp for schedule(dynamic, 1)
+		for (int i = 0; i < n_starts; i++) {
+			search_trails(&graph, &search, starts[i], &best);
+		}
+		destroy_trail_search(&search);
+	}
+
+	// Trail as a list of cities, from the start along the routes of each recorded edge (either way along it)
+	EdgeList trail = { NULL };
+	if (best.start != -1) {
+		EdgeNodePtr tail = append_trail_city(&trail, NULL, graph.global[best.start], 0, arena);
+		int v = best.start;
+		for (int d = 0; d < best.n_edges; d++) {
+			int e = best.edges[d];
+			if (graph.from[e] == v) {
+				for (int c = graph.chain_first[e] + 1; c <= graph.chain_last[e]; c++) {
+					tail = append_trail_city(&trail, tail, graph.global[graph.chain_vertex[c]], graph.chain_weight[c], arena);
+				}
+				v = graph.to[e];
+			}
+			else {
+				for (int c = graph.chain_last[e] - 1; c >= graph.chain_first[e]; c--) {
+					tail = append_trail_city(&trail, tail, graph.global[graph.chain_vertex[c]], graph.chain_weight[c + 1], arena);
+				}
+				v = graph.from[e];
+			}
+		}
+	}
+	if (length != NULL) {
+		*length = best.length > 0 ? best.length : 0;
+	}
+
+	/* Free memory */
+	free(component);
+	free(starts);
+	free(best.edges);
+	destroy_trail_graph(&graph);
+
+	STATS_END("longest_trail");
+	return trail;
+}
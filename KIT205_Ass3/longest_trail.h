@@ -0,0 +1,22 @@
+#ifndef LONGEST_TRAIL_H
+#define LONGEST_TRAIL_H
+
+#include "graph.h"
+
+
+/* Longest trail (continuous route that never uses a route twice) in the routes a player has claimed
+ *		Depth-first search from every city that can end a longest trail (odd-degree cities, or any city of a
+ *		component without them), 1 start per task handed out dynamically to the OpenMP threads
+ *		Routes used so far are a bitset, and a branch is cut once it reaches a city with the same routes used as a
+ *		branch searched before, or the routes still reachable from its end cannot beat the longest trail found by
+ *		any thread: less those any trail must leave out (joining in pairs the odd-degree cities beyond its 2 ends),
+ *		or only counting 1 branch past each bridge
+ * Parameters:
+ *		claimed		Graph of claimed routes, each route stored once (as the solvers return them)
+ *		length		pointer to variable storing the total weight of the trail (can be NULL)
+ *		arena		Arena to allocate trail nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the trail, from one end to the other, weight = route taken to reach the
+ *		vertex (empty if there are no routes)
+ */
+EdgeList longest_trail(Graph* claimed, int* length, Arena* arena);
+#endif
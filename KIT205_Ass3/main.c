@@ -1,51 +1,519 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
 #include "graph.h"
+#include "pqueue.h"
+#include "mst.h"
+#include "dense.h"
+#include "pathcache.h"
+#include "hierarchy.h"
+#include "steiner_exact.h"
+#include "steiner.h"
+#include "steiner_multistart.h"
+#include "steiner_local.h"
+#include "steiner_incremental.h"
+#include "longest_trail.h"
+#include "ticket_select.h"
+#include "batch.h"
+#include "simulate.h"
+#include "parser.h"
+#include "mapfile.h"
+#include "mapgen.h"
+#include "bench.h"
+#include "stats.h"
+#include "workspace.h"
+
+
+/* Batch mode: solve every ticket set that follows the map (in parallel), print costs in input order
+ * Parameters:
+ *		map			CSRGraph instance
+ *		input		Parser positioned after the map
+ * Return: exit code
+ */
+static int run_batch(CSRGraph* map, Parser* input) {
+	// Read ticket sets until end of input
+	int capacity = 16;
+	int n_sets = 0;
+	TicketSet* sets = malloc(sizeof(TicketSet) * capacity);
+	while (read_ticket_set(&sets[n_sets], input, map->V)) {
+		n_sets++;
+		if (n_sets == capacity) {
+			capacity *= 2;
+			sets = realloc(sets, sizeof(TicketSet) * capacity);
+		}
+	}
+
+	if (input->failed) {
+		for (int s = 0; s < n_sets; s++) {
+			destroy_ticket_set(&sets[s]);
+		}
+		free(sets);
+		return 1;
+	}
+
+	BatchResult* results = malloc(sizeof(BatchResult) * (n_sets > 0 ? n_sets : 1));
+	solve_batch(map, sets, n_sets, results);
+
+	for (int s = 0; s < n_sets; s++) {
+		printf("Ticket set %d: shortest paths cost = %d, Steiner tree cost = %d\n",
+			s, results[s].shortest_paths_cost, results[s].steiner_tree_cost);
+	}
+
+	/* Free memory */
+	for (int s = 0; s < n_sets; s++) {
+		destroy_ticket_set(&sets[s]);
+	}
+	free(sets);
+	free(results);
+
+	return 0;
+}
+
+/* Print the solver counters and timers as JSON and / or write the trace of the run (--stats, --trace)
+ * Parameters:
+ *		print		true to print counters and timers
+ *		trace_path	Chrome trace file to write (NULL for none)
+ * Return: void
+ */
+static void report_stats(bool print, const char* trace_path) {
+	if (print) {
+		stats_print_json(stdout);
+	}
+	if (trace_path != NULL) {
+		stats_write_trace(trace_path);
+	}
+	stats_reset();
+}
+
+/* Simulation mode: play many games on the map at once, print throughput and results by seat
+ * Parameters:
+ *		map			CSRGraph instance
+ *		spec		GameSpec
+ *		seed		random seed
+ * Return: exit code
+ */
+static int run_simulation(CSRGraph* map, GameSpec* spec, uint64_t seed) {
+	SimulationResult result = simulate_games(map, spec, seed);
+	double seconds = result.elapsed_ms / 1000.0;
+
+	printf("Simulated %d games of %d players on a map of %d cities in %.1f ms\n",
+		result.n_games, result.n_players, map->V, result.elapsed_ms);
+	printf("Throughput: %.1f games/s, %.1f turns/s\n", seconds > 0 ? result.n_games / seconds : 0.0,
+		seconds > 0 ? result.n_turns / seconds : 0.0);
+	printf("Turns: %lld (%lld routes claimed, %lld tickets drawn)\n", result.n_turns, result.n_claims, result.n_draws);
+	printf("Tickets completed: %lld of %lld\n", result.tickets_completed, result.tickets_dealt);
+	for (int p = 0; p < result.n_players; p++) {
+		printf("Seat %d: %d wins, average score = %.1f\n",
+			p, result.wins[p], (double)result.total_score[p] / result.n_games);
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	/* Getting options */
+	//		--pq binary|pairing		priority queue used by Prim's and Dijkstra's (default: binary)
+	//		--mst prim|kruskal|boruvka	MST algorithm for Part A (default: prim)
+	//		--dense auto|scalar|sse2|avx2	kernel of Prim's on dense maps (default: auto, the fastest the CPU supports)
+	//		--steiner auto|greedy|kmb|multi	Steiner tree solver for Solution 2 (default: auto, KMB on large maps)
+	//		--restarts N			randomised runs of --steiner multi on top of 1 per ticket city (default: 0)
+	//		--improve MS			improve Solutions 1 and 2 (and plans of --simulate) by local search, MS ms each (0: no limit)
+	//		--exact					also print the exact (minimum) Steiner tree as Solution 3
+	//		--longest				also print the longest continuous route of the Solution 2 tree (its routes claimed)
+	//		--budget N				also choose the tickets worth the most points whose tree needs at most N train tokens
+	//		--points p,p,...		points of each ticket for --budget (default: length of its shortest path)
+	//		--incremental			also grow a Steiner tree 1 ticket at a time (as tickets are drawn), print its cost after each
+	//		--batch					read any number of ticket sets after the map, print costs of each
+	//		--simulate games:players:tickets	play games on the map in parallel (tickets of the input unused), print games/s
+	//		--convert map.ttrm		write the map of the input as a binary map file and stop
+	//		--map map.ttrm			load the map from a binary map file (the input then only holds tickets)
+	//		--build-hierarchy map.ttrh	write a contraction hierarchy of the map as a hierarchy file and stop
+	//		--hierarchy map.ttrh	load a hierarchy file of the map, answer shortest path queries with it
+	//		--claim v-u				route claimed by another player after the solutions (repeatable), print repaired costs
+	//		--generate shape:V:E:tickets	write a generated map and tickets (text input format) and stop
+	//		--bench					time every solver on generated maps (--bench-map shape:V:E:tickets, repeatable)
+	//		--bench-runs N, --bench-out results.csv, --bench-baseline results.csv, --seed N
+	//		--stats					print solver counters and timers as JSON after the run (needs a TTR_STATS build)
+	//		--trace trace.json		write a Chrome trace event per solver call (needs a TTR_STATS build)
+	//		input.txt				read this file (memory-mapped) instead of stdin
+	bool improve = false;
+	double improve_ms = 0;
+	bool exact = false;
+	bool longest = false;
+	bool incremental = false;
+	int budget = -1;
+	const char* points_text = NULL;
+	bool batch = false;
+	bool simulate = false;
+	GameSpec game_spec;
+	bool bench = false;
+	bool generate = false;
+	MapSpec generate_spec;
+	BenchOptions bench_options = { NULL, 0, 10, 1, NULL, NULL };
+	bench_options.maps = malloc(sizeof(MapSpec) * argc);
+	int* claims = malloc(sizeof(int) * argc * 2);
+	int n_claims = 0;
+	const char* convert_path = NULL;
+	const char* map_path = NULL;
+	const char* build_hierarchy_path = NULL;
+	const char* hierarchy_path = NULL;
+	const char* input_path = NULL;
+	bool print_stats = false;
+	const char* trace_path = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--pq") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "binary") == 0) {
+				set_pq_kind(PQ_BINARY);
+			}
+			else if (strcmp(argv[i], "pairing") == 0) {
+				set_pq_kind(PQ_PAIRING);
+			}
+			else {
+				fprintf(stderr, "Unknown priority queue '%s' (expected binary or pairing)\n", argv[i]);
+				free(bench_options.maps);
+				free(claims);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--mst") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "prim") == 0) {
+				set_mst_kind(MST_PRIM);
+			}
+			else if (strcmp(argv[i], "kruskal") == 0) {
+				set_mst_kind(MST_KRUSKAL);
+			}
+			else if (strcmp(argv[i], "boruvka") == 0) {
+				set_mst_kind(MST_BORUVKA);
+			}
+			else {
+				fprintf(stderr, "Unknown MST algorithm '%s' (expected prim, kruskal or boruvka)\n", argv[i]);
+				free(bench_options.maps);
+				free(claims);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--dense") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "auto") == 0) {
+				set_dense_kernel(DENSE_KERNEL_AUTO);
+			}
+			else if (strcmp(argv[i], "scalar") == 0) {
+				set_dense_kernel(DENSE_KERNEL_SCALAR);
+			}
+			else if (strcmp(argv[i], "sse2") == 0) {
+				set_dense_kernel(DENSE_KERNEL_SSE2);
+			}
+			else if (strcmp(argv[i], "avx2") == 0) {
+				set_dense_kernel(DENSE_KERNEL_AVX2);
+			}
+			else {
+				fprintf(stderr, "Unknown dense kernel '%s' (expected auto, scalar, sse2 or avx2)\n", argv[i]);
+				free(bench_options.maps);
+				free(claims);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--steiner") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "auto") == 0) {
+				set_steiner_kind(STEINER_AUTO);
+			}
+			else if (strcmp(argv[i], "greedy") == 0) {
+				set_steiner_kind(STEINER_GREEDY);
+			}
+			else if (strcmp(argv[i], "kmb") == 0) {
+				set_steiner_kind(STEINER_KMB);
+			}
+			else if (strcmp(argv[i], "multi") == 0) {
+				set_steiner_kind(STEINER_MULTISTART);
+			}
+			else {
+				fprintf(stderr, "Unknown Steiner tree solver '%s' (expected auto, greedy, kmb or multi)\n", argv[i]);
+				free(bench_options.maps);
+				free(claims);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--restarts") == 0 && i + 1 < argc) {
+			set_multistart_restarts(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--improve") == 0 && i + 1 < argc) {
+			improve = true;
+			improve_ms = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--exact") == 0) {
+			exact = true;
+		}
+		else if (strcmp(argv[i], "--longest") == 0) {
+			longest = true;
+		}
+		else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+			budget = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--points") == 0 && i + 1 < argc) {
+			points_text = argv[++i];
+		}
+		else if (strcmp(argv[i], "--incremental") == 0) {
+			incremental = true;
+		}
+		else if (strcmp(argv[i], "--batch") == 0) {
+			batch = true;
+		}
+		else if (strcmp(argv[i], "--simulate") == 0 && i + 1 < argc && parse_game_spec(argv[i + 1], &game_spec)) {
+			simulate = true;
+			i++;
+		}
+		else if (strcmp(argv[i], "--claim") == 0 && i + 1 < argc) {
+			// Both cities must be numbers, with nothing after the second
+			char* start = argv[++i];
+			char* end;
+			claims[n_claims * 2] = (int)strtol(start, &end, 10);
+			bool valid = end != start && *end == '-';
+			if (valid) {
+				start = end + 1;
+				claims[n_claims * 2 + 1] = (int)strtol(start, &end, 10);
+				valid = end != start && *end == '\0';
+			}
+			if (!valid) {
+				fprintf(stderr, "Invalid route '%s' (expected v-u)\n", argv[i]);
+				free(bench_options.maps);
+				free(claims);
+				return 1;
+			}
+			n_claims++;
+		}
+		else if (strcmp(argv[i], "--convert") == 0 && i + 1 < argc) {
+			convert_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+			map_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--build-hierarchy") == 0 && i + 1 < argc) {
+			build_hierarchy_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--hierarchy") == 0 && i + 1 < argc) {
+			hierarchy_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc && parse_map_spec(argv[i + 1], &generate_spec)) {
+			generate = true;
+			i++;
+		}
+		else if (strcmp(argv[i], "--bench") == 0) {
+			bench = true;
+		}
+		else if (strcmp(argv[i], "--bench-map") == 0 && i + 1 < argc
+			&& parse_map_spec(argv[i + 1], &bench_options.maps[bench_options.n_maps])) {
+			bench_options.n_maps++;
+			bench = true;
+			i++;
+		}
+		else if (strcmp(argv[i], "--bench-runs") == 0 && i + 1 < argc) {
+			bench_options.runs = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--bench-out") == 0 && i + 1 < argc) {
+			bench_options.output_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--bench-baseline") == 0 && i + 1 < argc) {
+			bench_options.baseline_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			bench_options.seed = strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--stats") == 0) {
+			print_stats = true;
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+			trace_path = argv[++i];
+		}
+		else if (argv[i][0] != '-' && input_path == NULL) {
+			input_path = argv[i];
+		}
+		else {
+			fprintf(stderr, "Usage: %s [--pq binary|pairing] [--mst prim|kruskal|boruvka] [--dense auto|scalar|sse2|avx2] [--steiner auto|greedy|kmb|multi [--restarts N]] [--improve MS] [--exact] [--longest] [--budget N [--points p,p,...]] [--incremental] [--claim v-u ...] [--batch] [--simulate games:players:tickets [--seed N]] [--convert map.ttrm] [--map map.ttrm] [--build-hierarchy map.ttrh] [--hierarchy map.ttrh] [--stats] [--trace trace.json] [input.txt] (or < input.txt)\n"
+				"       %s --generate shape:V:E:tickets [--seed N] > input.txt\n"
+				"       %s --bench [--bench-map shape:V:E:tickets ...] [--bench-runs N] [--bench-out results.csv] [--bench-baseline results.csv]\n"
+				"       (shape is grid, planar or random, E = 0 for the default number of routes)\n", argv[0], argv[0], argv[0]);
+			free(bench_options.maps);
+			free(claims);
+			return 1;
+		}
+	}
+
+	if ((print_stats || trace_path != NULL) && !stats_enabled()) {
+		fprintf(stderr, "Solver stats are not compiled in (build with TTR_STATS defined), --stats and --trace are ignored\n");
+		print_stats = false;
+		trace_path = NULL;
+	}
+	stats_trace(trace_path != NULL);
+
+	if (bench) {
+		int status = run_benchmarks(&bench_options);
+		free_all_workspaces();
+		free(bench_options.maps);
+		free(claims);
+		return status;
+	}
+	free(bench_options.maps);
+
+	if (generate) {
+		free(claims);
+		Graph G = generate_map(&generate_spec, bench_options.seed);
+		TicketSet tickets = generate_tickets(G.V, generate_spec.n_tickets, bench_options.seed + 1000);
+		write_map(&G, &tickets, stdout);
+		destroy_ticket_set(&tickets);
+		destroy_graph(&G);
+		return 0;
+	}
 
-int main() {
 	/* Getting input */
-	Graph G = create_graph();
+	Parser input;
+	if (!open_parser(&input, input_path)) {
+		free(claims);
+		return 1;
+	}
+
+	// Map: from a binary map file, or the text at the start of the input
+	//		Either way it is only used in CSR form
+	CSRGraph map;
+	if (map_path != NULL) {
+		if (!load_map_file(&map, map_path)) {
+			close_parser(&input);
+			free(claims);
+			return 1;
+		}
+	}
+	else {
+		Graph G = create_graph(&input);
+		if (input.failed) {
+			destroy_graph(&G);
+			close_parser(&input);
+			free(claims);
+			return 1;
+		}
+
+		/* Print Graph G - FOR TESTING */
+		//print_graph(&G);
+		//print_in_degrees(&G);
+		//printf("\n");
+
+		/* Build CSR form of the map once, all algorithms below run on it */
+		map = create_csr_graph(&G);
+		destroy_graph(&G);
+	}
+
+	if (convert_path != NULL) {
+		bool saved = save_map_file(&map, convert_path);
+		destroy_csr_graph(&map);
+		close_parser(&input);
+		free(claims);
+		return saved ? 0 : 1;
+	}
+
+	if (build_hierarchy_path != NULL) {
+		ContractionHierarchy hierarchy = build_hierarchy(&map);
+		bool saved = save_hierarchy_file(&hierarchy, &map, build_hierarchy_path);
+		free_all_workspaces();
+		report_stats(print_stats, trace_path);
+		destroy_hierarchy(&hierarchy);
+		destroy_csr_graph(&map);
+		close_parser(&input);
+		free(claims);
+		return saved ? 0 : 1;
+	}
+
+	if (simulate) {
+		game_spec.improve_plans = improve;
+		game_spec.improve_ms = improve_ms;
+		int status = run_simulation(&map, &game_spec, bench_options.seed);
+		free_all_workspaces();
+		report_stats(print_stats, trace_path);
+		destroy_csr_graph(&map);
+		close_parser(&input);
+		free(claims);
+		return status;
+	}
+
+	if (batch) {
+		int status = run_batch(&map, &input);
+		free_all_workspaces();
+		report_stats(print_stats, trace_path);
+		destroy_csr_graph(&map);
+		close_parser(&input);
+		free(claims);
+		return status;
+	}
 
 	// Getting tickets input
-	int n_tickets;
-	scanf_s("%d", &n_tickets);
-	int* from_cities = malloc(sizeof(int) * n_tickets);
-	int* to_cities = malloc(sizeof(int) * n_tickets);
-	for (int n = 0; n < n_tickets; n++) {
-		scanf_s("%d,%d", &from_cities[n], &to_cities[n]);
+	TicketSet tickets;
+	if (!read_ticket_set(&tickets, &input, map.V)) {
+		parser_error(&input, "expected tickets after the map");
+		destroy_csr_graph(&map);
+		close_parser(&input);
+		free(claims);
+		return 1;
 	}
+	close_parser(&input);
+	int n_tickets = tickets.n_tickets;
+	int* from_cities = tickets.from_cities;
+	int* to_cities = tickets.to_cities;
 
 	//printf("%d\n", n_tickets);
 
-	/* Print Graph G - FOR TESTING */
-	//print_graph(&G);
-	//print_in_degrees(&G);
-	//printf("\n");
-	
+	/* Shortest path trees of ticket cities, computed once and shared by both solutions */
+	PathCache cache = create_path_cache(&map);
+
+	// Contraction hierarchy of the map (optional): answers the queries the cache has no tree for
+	ContractionHierarchy hierarchy = { 0 };
+	HierarchyQuery hierarchy_query = { 0 };
+	if (hierarchy_path != NULL) {
+		if (!load_hierarchy_file(&hierarchy, &map, hierarchy_path)) {
+			destroy_path_cache(&cache);
+			destroy_ticket_set(&tickets);
+			destroy_csr_graph(&map);
+			free(claims);
+			return 1;
+		}
+		hierarchy_query = create_hierarchy_query(&hierarchy);
+		attach_hierarchy(&cache, &hierarchy_query);
+	}
+
 
 	// PART A: Minimum spanning tree ---------------------------------
-	printf("Part A: Prim's Minimum spanning tree -----------------------------\n");
-	Graph MST = prims_mst(&G);
+	printf("Part A: %s Minimum spanning tree -----------------------------\n", mst_kind_name(get_mst_kind()));
+	Graph MST = csr_mst(&map);
 	//print_graph(&MST);
 
 	/* Print all edges of MST and total cost */
 	//		Each vertex in this version of MST will only have 1 edge to it (excluding the last vertex)
+	//		A disconnected map gives a forest: the root of each tree (its highest vertex) has no edge
 	printf("Edges of MST:\n");
-	for (int v = 0; v < MST.V - 1; v++) {
-		printf("%d-%d(%d)", v, MST.edges[v].head->edge.to_vertex, MST.edges[v].head->edge.weight);
-		if (v != MST.V - 2) {
-			printf(", ");
+	bool first_edge = true;
+	for (int v = 0; v < MST.V; v++) {
+		if (MST.edges[v].head == NULL) {
+			continue;
 		}
+		printf("%s%d-%d(%d)", first_edge ? "" : ", ", v, MST.edges[v].head->edge.to_vertex, MST.edges[v].head->edge.weight);
+		first_edge = false;
 	}
 	printf("\nTotal cost of MST = %d\n\n", graph_weight(&MST));
 
 
 	// PART B: Steiner tree problem -----------------------------------
 	printf("\nPart B: Steiner tree problem -------------------------------------\n");
+	// Merge from and to_cities into 1 array
+	int* terminals = malloc(sizeof(int) * (n_tickets > 0 ? n_tickets * 2 : 1));
+	for (int n = 0; n < n_tickets; n++) {
+		terminals[n] = from_cities[n];
+		terminals[n + n_tickets] = to_cities[n];
+	}
+
 	/* Solution 1 */
 	printf("Solution 1: Shortest paths combination\n");
-	Graph shortest_G = shortest_paths(&G, from_cities, to_cities, n_tickets);
+	Graph shortest_G = cached_shortest_paths(&cache, from_cities, to_cities, n_tickets);
 	//print_graph(&shortest_G);
+	int shortest_saved = improve ? improve_steiner_tree(&map, &shortest_G, terminals, n_tickets * 2, improve_ms) : 0;
 
 	printf("Edges of shortest paths:\n");
 	for (int v = 0; v < shortest_G.V; v++) {
@@ -56,18 +524,16 @@ int main() {
 		}
 	}
 	printf("\b\b "); // Remove last comma
-	printf("\nTotal cost of MST = %d\n\n", graph_weight(&shortest_G));
+	printf("\nTotal cost of MST = %d\n", graph_weight(&shortest_G));
+	if (improve) {
+		printf("Local search saved %d train tokens\n", shortest_saved);
+	}
+	printf("\n");
 
 
 
 	/* Solution 2 */
 	printf("Solution 2: Steiner tree\n");
-	// Merge from and to_cities into 1 array
-	int* terminals = malloc(sizeof(int) * n_tickets * 2);
-	for (int n = 0; n < n_tickets; n++) {
-		terminals[n] = from_cities[n];
-		terminals[n + n_tickets] = to_cities[n];
-	}
 
 	// Print array of terminal vertices - FOR TESTING
 	/*
@@ -76,8 +542,9 @@ int main() {
 	}
 	*/
 
-	Graph steiner_t = steiner_tree(&G, terminals, n_tickets * 2);
+	Graph steiner_t = solve_steiner_tree(&cache, terminals, n_tickets * 2);
 	//print_graph(&steiner_t);
+	int steiner_saved = improve ? improve_steiner_tree(&map, &steiner_t, terminals, n_tickets * 2, improve_ms) : 0;
 	printf("Edges of Steiner Tree:\n");
 	for (int v = 0; v < steiner_t.V; v++) {
 		EdgeNodePtr current = steiner_t.edges[v].head;
@@ -87,11 +554,148 @@ int main() {
 		}
 	}
 	printf("\b\b "); // Remove last comma
-	printf("\nTotal cost of MST = %d\n\n", graph_weight(&steiner_t));
+	printf("\nTotal cost of MST = %d\n", graph_weight(&steiner_t));
+	if (improve) {
+		printf("Local search saved %d train tokens\n", steiner_saved);
+	}
+	printf("\n");
+
+
+	/* Solution 2, tickets drawn 1 at a time (optional) */
+	if (incremental) {
+		printf("Solution 2 (incremental): tickets drawn one at a time\n");
+		SteinerState state = create_steiner_state(&map, NULL, NULL, 0);
+		for (int n = 0; n < n_tickets; n++) {
+			if (!steiner_add_ticket(&state, from_cities[n], to_cities[n])) {
+				printf("Ticket %d-%d cannot be connected\n", from_cities[n], to_cities[n]);
+				continue;
+			}
+			printf("Ticket %d-%d drawn: total cost = %d\n", from_cities[n], to_cities[n], state.cost);
+		}
+		printf("\n");
+		destroy_steiner_state(&state);
+	}
+
+
+	/* Solution 3 (optional) */
+	if (exact) {
+		printf("Solution 3: Exact Steiner tree\n");
+		Graph exact_t = exact_steiner_tree(&map, terminals, n_tickets * 2);
+		printf("Edges of exact Steiner Tree:\n");
+		for (int v = 0; v < exact_t.V; v++) {
+			EdgeNodePtr current = exact_t.edges[v].head;
+			while (current != NULL) {
+				printf("%d-%d(%d), ", v, current->edge.to_vertex, current->edge.weight);
+				current = current->next;
+			}
+		}
+		printf("\b\b "); // Remove last comma
+		int exact_cost = graph_weight(&exact_t);
+		printf("\nTotal cost of MST = %d\n", exact_cost);
+		if (exact_cost > 0) {
+			printf("Solution 2 uses %.1f%% more train tokens\n\n", 100.0 * (graph_weight(&steiner_t) - exact_cost) / exact_cost);
+		}
+		destroy_graph(&exact_t);
+	}
+
+	/* Longest continuous route of the Solution 2 tree (optional) */
+	if (longest) {
+		printf("Longest continuous route of Steiner Tree:\n");
+		int trail_length;
+		EdgeList trail = longest_trail(&steiner_t, &trail_length, NULL);
+		for (EdgeNodePtr current = trail.head; current != NULL; current = current->next) {
+			printf("%d", current->edge.to_vertex);
+			if (current->next != NULL) {
+				printf("-");
+			}
+		}
+		printf("\nTotal length of route = %d\n\n", trail_length);
+		destroy_path(&trail);
+	}
+
+	/* Tickets to keep within a budget of train tokens (optional) */
+	if (budget >= 0) {
+		// Points of each ticket, as a comma-separated list (NULL: ticket lengths)
+		int* points = NULL;
+		bool points_valid = true;
+		if (points_text != NULL) {
+			points = malloc(sizeof(int) * (n_tickets > 0 ? n_tickets : 1));
+			const char* text = points_text;
+			for (int n = 0; n < n_tickets && points_valid; n++) {
+				char* end;
+				points[n] = (int)strtol(text, &end, 10);
+				points_valid = end != text && (*end == ',' ? n < n_tickets - 1 : *end == '\0' && n == n_tickets - 1);
+				text = end + 1;
+			}
+		}
 
+		if (!points_valid) {
+			fprintf(stderr, "Invalid points '%s' (expected %d comma-separated values)\n\n", points_text, n_tickets);
+		}
+		else {
+			printf("Ticket selection: budget of %d train tokens\n", budget);
+			TicketSelection selection = select_tickets(&cache, &tickets, points, budget);
+			printf("Tickets kept: ");
+			if (selection.n_selected == 0) {
+				printf("none, ");
+			}
+			for (int n = 0; n < n_tickets; n++) {
+				if (selection.selected[n]) {
+					printf("%d-%d, ", from_cities[n], to_cities[n]);
+				}
+			}
+			printf("\b\b \n"); // Remove last comma
+			printf("Edges of Steiner Tree:\n");
+			for (int v = 0; v < selection.tree.V; v++) {
+				EdgeNodePtr current = selection.tree.edges[v].head;
+				while (current != NULL) {
+					printf("%d-%d(%d), ", v, current->edge.to_vertex, current->edge.weight);
+					current = current->next;
+				}
+			}
+			printf("\b\b "); // Remove last comma
+			printf("\nTotal cost = %d, points = %d (%d of %d tickets kept)\n\n", selection.cost, selection.score,
+				selection.n_selected, n_tickets);
+			destroy_ticket_selection(&selection);
+		}
+		free(points);
+	}
+
+	/* Routes claimed by other players (optional): cached trees are repaired, not recomputed */
+	if (n_claims > 0) {
+		printf("Routes claimed by other players\n");
+		for (int c = 0; c < n_claims; c++) {
+			int v = claims[c * 2];
+			int u = claims[c * 2 + 1];
+			if (cache_remove_route(&cache, v, u) == -1) {
+				printf("Route %d-%d does not exist\n", v, u);
+				continue;
+			}
+			Graph claimed_paths = cached_shortest_paths(&cache, from_cities, to_cities, n_tickets);
+			Graph claimed_t = solve_steiner_tree(&cache, terminals, n_tickets * 2);
+			printf("Route %d-%d claimed: shortest paths cost = %d, Steiner tree cost = %d\n",
+				v, u, graph_weight(&claimed_paths), graph_weight(&claimed_t));
+			destroy_graph(&claimed_paths);
+			destroy_graph(&claimed_t);
+		}
+		printf("\n");
+	}
 
 	printf("\n\n----End----\n");
-	destroy_graph(&G);
+	report_stats(print_stats, trace_path);
+	destroy_graph(&MST);
+	destroy_graph(&shortest_G);
+	destroy_graph(&steiner_t);
+	free(terminals);
+	destroy_ticket_set(&tickets);
+	destroy_path_cache(&cache);
+	if (hierarchy_path != NULL) {
+		destroy_hierarchy_query(&hierarchy_query);
+		destroy_hierarchy(&hierarchy);
+	}
+	destroy_csr_graph(&map);
+	free_all_workspaces();
+	free(claims);
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,379 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include "graph.h"
+#include "hierarchy.h"
+#include "mapfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+/* Memory-map a whole file
+ *		Pages are private copy-on-write, so the memory can be written without changing the file
+ * Parameters:
+ *		path		file path
+ *		memory		pointer to variable storing the mapped memory (NULL for an empty file)
+ *		length		pointer to variable storing the file size
+ * Return: true if the file was mapped (or is empty)
+ */
+bool map_file(const char* path, void** memory, size_t* length) {
+	*memory = NULL;
+	*length = 0;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	*length = (size_t)size.QuadPart;
+	if (*length > 0) {
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if (mapping != NULL) {
+			*memory = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+
+	struct stat info;
+	fstat(fd, &info);
+	*length = (size_t)info.st_size;
+	if (*length > 0) {
+		*memory = mmap(NULL, *length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (*memory == MAP_FAILED) {
+			*memory = NULL;
+		}
+	}
+	close(fd);
+#endif
+
+	return *length == 0 || *memory != NULL;
+}
+
+/* Unmap memory returned by map_file()
+ * Parameters:
+ *		memory		mapped memory
+ *		length		file size
+ * Return: void
+ */
+void unmap_file(void* memory, size_t length) {
+	if (memory == NULL) {
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(memory);
+#else
+	munmap(memory, length);
+#endif
+}
+
+
+/* FNV-1a hash of an array of ints, continuing from hash */
+static uint32_t fnv1a(uint32_t hash, const int* data, size_t count) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < count * sizeof(int); i++) {
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/* Checksum of the CSR arrays of a map */
+static uint32_t map_checksum(CSRGraph* map) {
+	uint32_t hash = 2166136261u;
+	hash = fnv1a(hash, map->offsets, (size_t)map->V + 1);
+	hash = fnv1a(hash, map->to_vertex, (size_t)map->E);
+	hash = fnv1a(hash, map->weight, (size_t)map->E);
+	return hash;
+}
+
+/* Checksum of the arrays of a hierarchy */
+static uint32_t hierarchy_checksum(ContractionHierarchy* hierarchy) {
+	uint32_t hash = 2166136261u;
+	hash = fnv1a(hash, hierarchy->rank, (size_t)hierarchy->V);
+	hash = fnv1a(hash, hierarchy->up.offsets, (size_t)hierarchy->V + 1);
+	hash = fnv1a(hash, hierarchy->up.to_vertex, (size_t)hierarchy->up.E);
+	hash = fnv1a(hash, hierarchy->up.weight, (size_t)hierarchy->up.E);
+	hash = fnv1a(hash, hierarchy->middle, (size_t)hierarchy->up.E);
+	return hash;
+}
+
+/* Check the arrays of a loaded CSR graph, so a damaged file cannot make a search read out of bounds (O(V + E))
+ *		Offsets start at 0, never decrease and end at E, every to-vertex is a vertex, and no weight is negative
+ */
+static bool csr_arrays_valid(CSRGraph* map) {
+	if (map->offsets[0] != 0 || map->offsets[map->V] != map->E) {
+		return false;
+	}
+	for (int v = 0; v < map->V; v++) {
+		if (map->offsets[v] > map->offsets[v + 1]) {
+			return false;
+		}
+	}
+	for (int e = 0; e < map->E; e++) {
+		if (map->to_vertex[e] < 0 || map->to_vertex[e] >= map->V || map->weight[e] < 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Check the arrays of a loaded hierarchy: its up graph (rows sorted by to-vertex), ranks in 0 .. V - 1 and
+ *		middle vertices -1 or a vertex
+ *		Each shortcut must skip a vertex ranked below both its ends, with up edges from it to both ends, so
+ *		unpacking a shortcut always finds its 2 halves and ends (O(V + E log E))
+ */
+static bool hierarchy_arrays_valid(ContractionHierarchy* hierarchy) {
+	CSRGraph* up = &hierarchy->up;
+	if (!csr_arrays_valid(up)) {
+		return false;
+	}
+	for (int v = 0; v < hierarchy->V; v++) {
+		if (hierarchy->rank[v] < 0 || hierarchy->rank[v] >= hierarchy->V) {
+			return false;
+		}
+		for (int e = up->offsets[v] + 1; e < up->offsets[v + 1]; e++) {
+			if (up->to_vertex[e - 1] >= up->to_vertex[e]) {
+				return false;
+			}
+		}
+	}
+	for (int v = 0; v < hierarchy->V; v++) {
+		for (int e = up->offsets[v]; e < up->offsets[v + 1]; e++) {
+			int middle = hierarchy->middle[e];
+			if (middle == -1) {
+				continue;
+			}
+			int u = up->to_vertex[e];
+			if (middle < 0 || middle >= hierarchy->V
+				|| hierarchy->rank[middle] >= hierarchy->rank[v] || hierarchy->rank[middle] >= hierarchy->rank[u]
+				|| !csr_edge_exists(up, middle, v) || !csr_edge_exists(up, middle, u)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+/* Write a map to a binary map file
+ * Parameters:
+ *		map			CSRGraph instance
+ *		path		file path
+ * Return: true if the file was written
+ */
+bool save_map_file(CSRGraph* map, const char* path) {
+	FILE* file = NULL;
+#ifdef _MSC_VER
+	fopen_s(&file, path, "wb");
+#else
+	file = fopen(path, "wb");
+#endif
+	if (file == NULL) {
+		fprintf(stderr, "Cannot write map file '%s'\n", path);
+		return false;
+	}
+
+	MapFileHeader header;
+	memcpy(header.magic, MAP_FILE_MAGIC, 4);
+	header.version = MAP_FILE_VERSION;
+	header.V = map->V;
+	header.E = map->E;
+	header.checksum = map_checksum(map);
+	header.reserved = 0;
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(map->offsets, sizeof(int), (size_t)map->V + 1, file) == (size_t)map->V + 1
+		&& fwrite(map->to_vertex, sizeof(int), (size_t)map->E, file) == (size_t)map->E
+		&& fwrite(map->weight, sizeof(int), (size_t)map->E, file) == (size_t)map->E;
+	ok = fclose(file) == 0 && ok;
+
+	if (!ok) {
+		fprintf(stderr, "Cannot write map file '%s'\n", path);
+	}
+	return ok;
+}
+
+/* Load a binary map file by memory-mapping it (no parsing, arrays are used in place)
+ *		destroy_csr_graph() unmaps the file
+ * Parameters:
+ *		map			pointer to CSRGraph to fill in
+ *		path		file path
+ * Return: true if the file was loaded, its header and checksum are valid and its arrays are in range
+ */
+bool load_map_file(CSRGraph* map, const char* path) {
+	void* mapping;
+	size_t length;
+	if (!map_file(path, &mapping, &length)) {
+		fprintf(stderr, "Cannot open map file '%s'\n", path);
+		return false;
+	}
+	char* memory = mapping;
+
+	MapFileHeader* header = (MapFileHeader*)memory;
+	const char* problem = NULL;
+	if (length < sizeof(MapFileHeader) || memcmp(header->magic, MAP_FILE_MAGIC, 4) != 0) {
+		problem = "not a binary map file";
+	}
+	else if (header->version != MAP_FILE_VERSION) {
+		problem = "unsupported version";
+	}
+	else if (header->V < 1 || header->E < 0
+		|| length != sizeof(MapFileHeader) + sizeof(int) * ((size_t)header->V + 1 + 2 * (size_t)header->E)) {
+		problem = "wrong size";
+	}
+
+	if (problem == NULL) {
+		// Arrays follow the header in the mapping
+		map->V = header->V;
+		map->E = header->E;
+		map->offsets = (int*)(memory + sizeof(MapFileHeader));
+		map->to_vertex = map->offsets + map->V + 1;
+		map->weight = map->to_vertex + map->E;
+		map->mapping = memory;
+		map->mapping_length = length;
+		map->n_landmarks = 0;
+		map->landmark_dist = NULL;
+
+		if (map_checksum(map) != header->checksum) {
+			problem = "checksum mismatch";
+		}
+		else if (!csr_arrays_valid(map)) {
+			problem = "bad offsets, routes or weights";
+		}
+	}
+
+	if (problem != NULL) {
+		fprintf(stderr, "Cannot load map file '%s': %s\n", path, problem);
+		unmap_file(memory, length);
+		return false;
+	}
+	return true;
+}
+
+
+/* Write a contraction hierarchy to a hierarchy file
+ * Parameters:
+ *		hierarchy	ContractionHierarchy instance
+ *		map			CSRGraph the hierarchy was built for
+ *		path		file path
+ * Return: true if the file was written
+ */
+bool save_hierarchy_file(ContractionHierarchy* hierarchy, CSRGraph* map, const char* path) {
+	FILE* file = NULL;
+#ifdef _MSC_VER
+	fopen_s(&file, path, "wb");
+#else
+	file = fopen(path, "wb");
+#endif
+	if (file == NULL) {
+		fprintf(stderr, "Cannot write hierarchy file '%s'\n", path);
+		return false;
+	}
+
+	HierarchyFileHeader header;
+	memcpy(header.magic, HIERARCHY_FILE_MAGIC, 4);
+	header.version = HIERARCHY_FILE_VERSION;
+	header.V = hierarchy->V;
+	header.E = hierarchy->up.E;
+	header.map_checksum = map_checksum(map);
+	header.checksum = hierarchy_checksum(hierarchy);
+
+	size_t V = (size_t)hierarchy->V;
+	size_t E = (size_t)hierarchy->up.E;
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(hierarchy->rank, sizeof(int), V, file) == V
+		&& fwrite(hierarchy->up.offsets, sizeof(int), V + 1, file) == V + 1
+		&& fwrite(hierarchy->up.to_vertex, sizeof(int), E, file) == E
+		&& fwrite(hierarchy->up.weight, sizeof(int), E, file) == E
+		&& fwrite(hierarchy->middle, sizeof(int), E, file) == E;
+	ok = fclose(file) == 0 && ok;
+
+	if (!ok) {
+		fprintf(stderr, "Cannot write hierarchy file '%s'\n", path);
+	}
+	return ok;
+}
+
+/* Load a hierarchy file by memory-mapping it (arrays are used in place)
+ *		destroy_hierarchy() unmaps the file
+ * Parameters:
+ *		hierarchy	pointer to ContractionHierarchy to fill in
+ *		map			CSRGraph the hierarchy must have been built for
+ *		path		file path
+ * Return: true if the file was loaded, its header and checksum are valid, its arrays are in range, every shortcut
+ *		unpacks into up edges and it was built for this map
+ */
+bool load_hierarchy_file(ContractionHierarchy* hierarchy, CSRGraph* map, const char* path) {
+	void* mapping;
+	size_t length;
+	if (!map_file(path, &mapping, &length)) {
+		fprintf(stderr, "Cannot open hierarchy file '%s'\n", path);
+		return false;
+	}
+	char* memory = mapping;
+
+	HierarchyFileHeader* header = (HierarchyFileHeader*)memory;
+	const char* problem = NULL;
+	if (length < sizeof(HierarchyFileHeader) || memcmp(header->magic, HIERARCHY_FILE_MAGIC, 4) != 0) {
+		problem = "not a hierarchy file";
+	}
+	else if (header->version != HIERARCHY_FILE_VERSION) {
+		problem = "unsupported version";
+	}
+	else if (header->V < 1 || header->E < 0
+		|| length != sizeof(HierarchyFileHeader) + sizeof(int) * (2 * (size_t)header->V + 1 + 3 * (size_t)header->E)) {
+		problem = "wrong size";
+	}
+	else if (header->V != map->V || header->map_checksum != map_checksum(map)) {
+		problem = "built for a different map";
+	}
+
+	if (problem == NULL) {
+		// Arrays follow the header in the mapping
+		CSRGraph* up = &hierarchy->up;
+		hierarchy->V = header->V;
+		hierarchy->rank = (int*)(memory + sizeof(HierarchyFileHeader));
+		up->V = header->V;
+		up->E = header->E;
+		up->offsets = hierarchy->rank + up->V;
+		up->to_vertex = up->offsets + up->V + 1;
+		up->weight = up->to_vertex + up->E;
+		hierarchy->middle = up->weight + up->E;
+		up->mapping = memory;
+		up->mapping_length = length;
+		up->n_landmarks = 0;
+		up->landmark_dist = NULL;
+
+		if (hierarchy_checksum(hierarchy) != header->checksum) {
+			problem = "checksum mismatch";
+		}
+		else if (!hierarchy_arrays_valid(hierarchy)) {
+			problem = "bad offsets, edges, ranks or shortcuts";
+		}
+	}
+
+	if (problem != NULL) {
+		fprintf(stderr, "Cannot load hierarchy file '%s': %s\n", path, problem);
+		unmap_file(memory, length);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,101 @@
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "graph.h"
+#include "hierarchy.h"
+
+#define MAP_FILE_MAGIC "TTRM"
+#define MAP_FILE_VERSION 1
+#define HIERARCHY_FILE_MAGIC "TTRH"
+#define HIERARCHY_FILE_VERSION 1
+
+/* Header of a binary map file, followed by the CSR arrays of the map (native int32, little endian hosts)
+ *		offsets[V + 1], to_vertex[E], weight[E]
+ *		checksum is FNV-1a over the 3 arrays
+ */
+typedef struct mapFileHeader {
+	char magic[4];
+	uint32_t version;
+	int32_t V;
+	int32_t E;
+	uint32_t checksum;
+	uint32_t reserved;
+} MapFileHeader;
+
+/* Header of a hierarchy file, followed by the arrays of the hierarchy (native int32, little endian hosts)
+ *		rank[V], offsets[V + 1], to_vertex[E], weight[E], middle[E] (E = number of up edges)
+ *		map_checksum is the checksum of the map it was built for (see MapFileHeader), checksum is FNV-1a over the 5 arrays
+ */
+typedef struct hierarchyFileHeader {
+	char magic[4];
+	uint32_t version;
+	int32_t V;
+	int32_t E;
+	uint32_t map_checksum;
+	uint32_t checksum;
+} HierarchyFileHeader;
+
+
+/* Memory-map a whole file
+ *		Pages are private copy-on-write, so the memory can be written without changing the file
+ * Parameters:
+ *		path		file path
+ *		memory		pointer to variable storing the mapped memory (NULL for an empty file)
+ *		length		pointer to variable storing the file size
+ * Return: true if the file was mapped (or is empty)
+ */
+bool map_file(const char* path, void** memory, size_t* length);
+
+
+/* Unmap memory returned by map_file()
+ * Parameters:
+ *		memory		mapped memory
+ *		length		file size
+ * Return: void
+ */
+void unmap_file(void* memory, size_t length);
+
+
+/* Write a map to a binary map file
+ * Parameters:
+ *		map			CSRGraph instance
+ *		path		file path
+ * Return: true if the file was written
+ */
+bool save_map_file(CSRGraph* map, const char* path);
+
+
+/* Load a binary map file by memory-mapping it (no parsing, arrays are used in place)
+ *		destroy_csr_graph() unmaps the file
+ * Parameters:
+ *		map			pointer to CSRGraph to fill in
+ *		path		file path
+ * Return: true if the file was loaded, its header and checksum are valid and its arrays are in range
+ */
+bool load_map_file(CSRGraph* map, const char* path);
+
+
+/* Write a contraction hierarchy to a hierarchy file
+ * Parameters:
+ *		hierarchy	ContractionHierarchy instance
+ *		map			CSRGraph the hierarchy was built for
+ *		path		file path
+ * Return: true if the file was written
+ */
+bool save_hierarchy_file(ContractionHierarchy* hierarchy, CSRGraph* map, const char* path);
+
+
+/* Load a hierarchy file by memory-mapping it (arrays are used in place)
+ *		destroy_hierarchy() unmaps the file
+ * Parameters:
+ *		hierarchy	pointer to ContractionHierarchy to fill in
+ *		map			CSRGraph the hierarchy must have been built for
+ *		path		file path
+ * Return: true if the file was loaded, its header and checksum are valid, its arrays are in range, every shortcut
+ *		unpacks into up edges and it was built for this map
+ */
+bool load_hierarchy_file(ContractionHierarchy* hierarchy, CSRGraph* map, const char* path);
+#endif
@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "graph.h"
+#include "batch.h"
+#include "mapgen.h"
+
+// Default number of routes per city when a spec leaves E as 0
+#define DEFAULT_GRID_DEGREE 2
+#define DEFAULT_PLANAR_DEGREE 3
+#define DEFAULT_RANDOM_DEGREE 2
+
+
+/* Next number of a SplitMix64 generator (own generator, so maps are the same on every platform) */
+static uint64_t next_random(uint64_t* state) {
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+/* Random integer in [0, n) */
+static int random_below(uint64_t* state, int n) {
+	return (int)(next_random(state) % (uint64_t)n);
+}
+
+/* Random double in [0, 1) */
+static double random_unit(uint64_t* state) {
+	return (double)(next_random(state) >> 11) / 9007199254740992.0;
+}
+
+/* Add an undirected route (both directions) */
+static void add_route(Graph* self, int u, int v, int weight) {
+	add_edge(self, u, v, weight);
+	add_edge(self, v, u, weight);
+}
+
+
+/* Read a map description written as "shape:V:E:tickets" (e.g. "grid:10000:0:20")
+ * Parameters:
+ *		text		description
+ *		spec		pointer to MapSpec to fill in
+ * Return: true if the description is valid
+ */
+bool parse_map_spec(const char* text, MapSpec* spec) {
+	const char* names[] = { "grid", "planar", "random" };
+	const MapShape shapes[] = { MAP_GRID, MAP_PLANAR, MAP_RANDOM };
+
+	bool found = false;
+	for (int s = 0; s < 3 && !found; s++) {
+		size_t length = strlen(names[s]);
+		if (strncmp(text, names[s], length) == 0 && text[length] == ':') {
+			spec->shape = shapes[s];
+			text += length;
+			found = true;
+		}
+	}
+	if (!found) {
+		return false;
+	}
+
+	// V, E and number of tickets (E and tickets can be left out)
+	long values[3] = { 0, 0, 10 };
+	for (int n = 0; n < 3 && *text == ':'; n++) {
+		char* end;
+		values[n] = strtol(text + 1, &end, 10);
+		if (end == text + 1) {
+			return false;
+		}
+		text = end;
+	}
+
+	spec->V = (int)values[0];
+	spec->E = (int)values[1];
+	spec->n_tickets = (int)values[2];
+	return *text == '\0' && values[0] >= 1 && values[0] <= 100000000 && values[1] >= 0 && values[2] >= 0;
+}
+
+/* Name of a map shape
+ * Parameters:
+ *		shape		MapShape
+ * Return: "grid", "planar" or "random"
+ */
+const char* map_shape_name(MapShape shape) {
+	switch (shape) {
+	case MAP_GRID:
+		return "grid";
+	case MAP_PLANAR:
+		return "planar";
+	default:
+		return "random";
+	}
+}
+
+
+/* Generate a grid or planar map
+ *		Vertex r * width + c sits at row r, column c (the last row may be partial)
+ *		Every row plus column 0 form a spanning tree, the other routes are picked at random up to E
+ */
+static void generate_grid(Graph* self, MapSpec* spec, uint64_t* state) {
+	int V = self->V;
+	int width = (int)ceil(sqrt((double)V));
+	bool planar = spec->shape == MAP_PLANAR;
+
+	// Jittered positions (weights of planar maps are distances)
+	double* x = malloc(sizeof(double) * V);
+	double* y = malloc(sizeof(double) * V);
+	for (int v = 0; v < V; v++) {
+		x[v] = v % width + (planar ? random_unit(state) * 0.7 - 0.35 : 0);
+		y[v] = v / width + (planar ? random_unit(state) * 0.7 - 0.35 : 0);
+	}
+
+	// Spanning tree: along every row, and down column 0
+	for (int v = 0; v < V; v++) {
+		if (v % width + 1 < width && v + 1 < V) {
+			int weight = planar ? 0 : 1 + random_below(state, 6);
+			add_route(self, v, v + 1, weight);
+		}
+		if (v % width == 0 && v + width < V) {
+			int weight = planar ? 0 : 1 + random_below(state, 6);
+			add_route(self, v, v + width, weight);
+		}
+	}
+
+	// Candidate routes: down from other columns, and 1 diagonal per cell if planar
+	int capacity = 2 * V;
+	int n_candidates = 0;
+	int* from = malloc(sizeof(int) * capacity);
+	int* to = malloc(sizeof(int) * capacity);
+	for (int v = 0; v < V; v++) {
+		if (v % width != 0 && v + width < V) {
+			from[n_candidates] = v;
+			to[n_candidates++] = v + width;
+		}
+		if (planar && v % width + 1 < width && v + width < V) {
+			if (random_below(state, 2) == 0 && v + width + 1 < V) {
+				from[n_candidates] = v;
+				to[n_candidates++] = v + width + 1;
+			}
+			else {
+				from[n_candidates] = v + 1;
+				to[n_candidates++] = v + width;
+			}
+		}
+	}
+
+	// Pick E - (V - 1) of them (partial shuffle)
+	int default_E = (planar ? DEFAULT_PLANAR_DEGREE : DEFAULT_GRID_DEGREE) * V;
+	int n_extra = (spec->E > 0 ? spec->E : default_E) - (V - 1);
+	if (n_extra > n_candidates) {
+		n_extra = n_candidates;
+	}
+	for (int n = 0; n < n_extra; n++) {
+		int pick = n + random_below(state, n_candidates - n);
+		int temp_from = from[n], temp_to = to[n];
+		from[n] = from[pick];
+		to[n] = to[pick];
+		from[pick] = temp_from;
+		to[pick] = temp_to;
+
+		int weight = planar ? 0 : 1 + random_below(state, 6);
+		add_route(self, from[n], to[n], weight);
+	}
+
+	// Planar weights: distance scaled so neighbouring cities are 1-6 apart
+	if (planar) {
+		for (int v = 0; v < V; v++) {
+			for (EdgeNodePtr current = self->edges[v].head; current != NULL; current = current->next) {
+				int u = current->edge.to_vertex;
+				double distance = sqrt((x[u] - x[v]) * (x[u] - x[v]) + (y[u] - y[v]) * (y[u] - y[v]));
+				int weight = (int)(distance * 3 + 0.5);
+				current->edge.weight = weight > 0 ? weight : 1;
+			}
+		}
+	}
+
+	free(x);
+	free(y);
+	free(from);
+	free(to);
+}
+
+/* Generate a random sparse map: a random spanning tree, then random routes up to E */
+static void generate_random(Graph* self, MapSpec* spec, uint64_t* state) {
+	int V = self->V;
+	for (int v = 1; v < V; v++) {
+		add_route(self, v, random_below(state, v), 1 + random_below(state, 6));
+	}
+
+	long long max_extra = (long long)V * (V - 1) / 2 - (V - 1);
+	long long n_extra = (long long)(spec->E > 0 ? spec->E : DEFAULT_RANDOM_DEGREE * V) - (V - 1);
+	if (n_extra > max_extra) {
+		n_extra = max_extra;
+	}
+
+	// Random pairs, skipping existing routes (gives up on nearly complete maps)
+	long long attempts = 20 * n_extra + 1000;
+	while (n_extra > 0 && attempts-- > 0) {
+		int u = random_below(state, V);
+		int v = random_below(state, V);
+		if (u != v && !edge_exists(self, u, v)) {
+			add_route(self, u, v, 1 + random_below(state, 6));
+			n_extra--;
+		}
+	}
+}
+
+/* Generate a connected map (same result for the same spec and seed on every platform)
+ * Parameters:
+ *		spec		MapSpec
+ *		seed		random seed
+ * Return: Graph (undirected, each route stored in both directions)
+ */
+Graph generate_map(MapSpec* spec, uint64_t seed) {
+	Graph G = create_empty_graph(spec->V);
+	uint64_t state = seed;
+
+	if (spec->shape == MAP_RANDOM) {
+		generate_random(&G, spec, &state);
+	}
+	else {
+		generate_grid(&G, spec, &state);
+	}
+	return G;
+}
+
+/* Generate random tickets between different cities
+ * Parameters:
+ *		V			number of vertices in the map
+ *		n_tickets	number of tickets
+ *		seed		random seed
+ * Return: TicketSet
+ */
+TicketSet generate_tickets(int V, int n_tickets, uint64_t seed) {
+	uint64_t state = seed;
+	TicketSet tickets;
+	tickets.n_tickets = n_tickets;
+	tickets.from_cities = malloc(sizeof(int) * (n_tickets > 0 ? n_tickets : 1));
+	tickets.to_cities = malloc(sizeof(int) * (n_tickets > 0 ? n_tickets : 1));
+
+	for (int n = 0; n < n_tickets; n++) {
+		tickets.from_cities[n] = random_below(&state, V);
+		tickets.to_cities[n] = random_below(&state, V);
+		while (V > 1 && tickets.to_cities[n] == tickets.from_cities[n]) {
+			tickets.to_cities[n] = random_below(&state, V);
+		}
+	}
+	return tickets;
+}
+
+/* Write a map and tickets in the text input format
+ * Parameters:
+ *		map			Graph instance
+ *		tickets		TicketSet instance
+ *		output		file to write to
+ * Return: void
+ */
+void write_map(Graph* map, TicketSet* tickets, FILE* output) {
+	fprintf(output, "%d\n", map->V);
+
+	// Each route once, from the lower vertex
+	for (int v = 0; v < map->V; v++) {
+		int n_routes = 0;
+		for (EdgeNodePtr current = map->edges[v].head; current != NULL; current = current->next) {
+			n_routes += current->edge.to_vertex > v;
+		}
+
+		fprintf(output, "%d\n", n_routes);
+		const char* separator = "";
+		for (EdgeNodePtr current = map->edges[v].head; current != NULL; current = current->next) {
+			if (current->edge.to_vertex > v) {
+				fprintf(output, "%s%d,%d", separator, current->edge.to_vertex, current->edge.weight);
+				separator = " ";
+			}
+		}
+		fprintf(output, "\n");
+	}
+
+	fprintf(output, "%d\n", tickets->n_tickets);
+	for (int n = 0; n < tickets->n_tickets; n++) {
+		fprintf(output, "%s%d,%d", n > 0 ? " " : "", tickets->from_cities[n], tickets->to_cities[n]);
+	}
+	fprintf(output, "\n");
+}
@@ -0,0 +1,76 @@
+#ifndef MAPGEN_H
+#define MAPGEN_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "graph.h"
+#include "batch.h"
+
+/* Shapes of generated maps
+ *		MAP_GRID		square grid, random weights 1-6
+ *		MAP_PLANAR		jittered grid with one diagonal per cell (a planar triangulation), weights from distances
+ *		MAP_RANDOM		random spanning tree plus random extra edges, random weights 1-6
+ */
+typedef enum mapShape {
+	MAP_GRID,
+	MAP_PLANAR,
+	MAP_RANDOM
+} MapShape;
+
+/* Description of a generated map and its tickets
+ *		E is the number of (undirected) routes, 0 for the default of the shape
+ */
+typedef struct mapSpec {
+	MapShape shape;
+	int V;
+	int E;
+	int n_tickets;
+} MapSpec;
+
+
+/* Read a map description written as "shape:V:E:tickets" (e.g. "grid:10000:0:20")
+ * Parameters:
+ *		text		description
+ *		spec		pointer to MapSpec to fill in
+ * Return: true if the description is valid
+ */
+bool parse_map_spec(const char* text, MapSpec* spec);
+
+
+/* Name of a map shape
+ * Parameters:
+ *		shape		MapShape
+ * Return: "grid", "planar" or "random"
+ */
+const char* map_shape_name(MapShape shape);
+
+
+/* Generate a connected map (same result for the same spec and seed on every platform)
+ * Parameters:
+ *		spec		MapSpec
+ *		seed		random seed
+ * Return: Graph (undirected, each route stored in both directions)
+ */
+Graph generate_map(MapSpec* spec, uint64_t seed);
+
+
+/* Generate random tickets between different cities
+ * Parameters:
+ *		V			number of vertices in the map
+ *		n_tickets	number of tickets
+ *		seed		random seed
+ * Return: TicketSet
+ */
+TicketSet generate_tickets(int V, int n_tickets, uint64_t seed);
+
+
+/* Write a map and tickets in the text input format
+ * Parameters:
+ *		map			Graph instance
+ *		tickets		TicketSet instance
+ *		output		file to write to
+ * Return: void
+ */
+void write_map(Graph* map, TicketSet* tickets, FILE* output);
+#endif
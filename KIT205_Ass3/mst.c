@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "graph.h"
+#include "mst.h"
+#include "dense.h"
+#include "stats.h"
+
+// MST algorithm used by csr_mst()
+static MSTKind mst_kind = MST_PRIM;
+
+/* An undirected edge (u < v) */
+typedef struct mstEdge {
+	int weight;
+	int u;
+	int v;
+} MSTEdge;
+
+
+/* Set the MST algorithm used by csr_mst()
+ * Parameters:
+ *		kind		MST_PRIM, MST_KRUSKAL or MST_BORUVKA
+ * Return: void
+ */
+void set_mst_kind(MSTKind kind) {
+	mst_kind = kind;
+}
+
+/* Get the MST algorithm used by csr_mst()
+ * No parameters
+ * Return: MSTKind
+ */
+MSTKind get_mst_kind() {
+	return mst_kind;
+}
+
+/* Name of an MST algorithm (for output)
+ * Parameters:
+ *		kind		MSTKind
+ * Return: "Prim's", "Kruskal's" or "Boruvka's"
+ */
+const char* mst_kind_name(MSTKind kind) {
+	switch (kind) {
+	case MST_KRUSKAL:
+		return "Kruskal's";
+	case MST_BORUVKA:
+		return "Boruvka's";
+	default:
+		return "Prim's";
+	}
+}
+
+/* Run the selected MST algorithm on a CSR graph ----------------------
+ *		Rooted at the last vertex: each other vertex has exactly 1 edge, to its parent
+ *		(a disconnected graph gives a forest, each tree rooted at its highest vertex)
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: MST (Graph)
+ */
+Graph csr_mst(CSRGraph* self) {
+	switch (mst_kind) {
+	case MST_KRUSKAL:
+		return csr_kruskal_mst(self);
+	case MST_BORUVKA:
+		return csr_boruvka_mst(self);
+	default:
+		break;
+	}
+
+	// Prim's on a dense map: an O(V^2) vectorised search for the closest vertex beats the priority queue
+	return csr_is_dense(self) ? csr_dense_prims_mst(self) : csr_prims_mst(self);
+}
+
+
+/* Edge order: by weight, then by vertices (a strict order, so Kruskal's and Boruvka's pick the same tree) */
+static bool lighter(int weight_a, int u_a, int v_a, int weight_b, int u_b, int v_b) {
+	if (weight_a != weight_b) {
+		return weight_a < weight_b;
+	}
+	if (u_a != u_b) {
+		return u_a < u_b;
+	}
+	return v_a < v_b;
+}
+
+/* Check if CSR edge a (from vertex from_a) comes before CSR edge b (from vertex from_b) in the order of lighter() */
+static bool lighter_csr_edge(CSRGraph* self, int from_a, int a, int from_b, int b) {
+	int to_a = self->to_vertex[a];
+	int to_b = self->to_vertex[b];
+	return lighter(self->weight[a], from_a < to_a ? from_a : to_a, from_a < to_a ? to_a : from_a,
+		self->weight[b], from_b < to_b ? from_b : to_b, from_b < to_b ? to_b : from_b);
+}
+
+/* Compare edges for qsort() */
+static int compare_edges(const void* a, const void* b) {
+	const MSTEdge* x = a;
+	const MSTEdge* y = b;
+	if (lighter(x->weight, x->u, x->v, y->weight, y->u, y->v)) {
+		return -1;
+	}
+	return lighter(y->weight, y->u, y->v, x->weight, x->u, x->v) ? 1 : 0;
+}
+
+/* Root of the set of v in a union-find forest (with path compression) */
+static int find_set(int parent[], int v) {
+	int root = v;
+	while (parent[root] != root) {
+		root = parent[root];
+	}
+	while (parent[v] != root) {
+		int next = parent[v];
+		parent[v] = root;
+		v = next;
+	}
+	return root;
+}
+
+/* Merge the sets of u and v (union by rank)
+ * Return: false if they were already in the same set
+ */
+static bool union_sets(int parent[], int rank[], int u, int v) {
+	int root_u = find_set(parent, u);
+	int root_v = find_set(parent, v);
+	if (root_u == root_v) {
+		return false;
+	}
+
+	if (rank[root_u] < rank[root_v]) {
+		parent[root_u] = root_v;
+	}
+	else if (rank[root_u] > rank[root_v]) {
+		parent[root_v] = root_u;
+	}
+	else {
+		parent[root_v] = root_u;
+		rank[root_u]++;
+	}
+	return true;
+}
+
+/* Build an MST Graph in the shape of csr_prims_mst() from a set of tree edges
+ *		Each tree is rooted at its highest vertex, and every other vertex gets 1 edge, to its parent
+ * Parameters:
+ *		V			number of vertices
+ *		tree		tree edges
+ *		n_edges		number of tree edges
+ * Return: MST (Graph)
+ */
+static Graph orient_forest(int V, MSTEdge tree[], int n_edges) {
+	Graph MST_G = create_empty_graph(V);
+
+	// Adjacency of the forest (CSR form)
+	int* offsets = calloc(V + 1, sizeof(int));
+	int* to_vertex = malloc(sizeof(int) * (2 * n_edges + 1));
+	int* weight = malloc(sizeof(int) * (2 * n_edges + 1));
+	for (int n = 0; n < n_edges; n++) {
+		offsets[tree[n].u + 1]++;
+		offsets[tree[n].v + 1]++;
+	}
+	for (int v = 0; v < V; v++) {
+		offsets[v + 1] += offsets[v];
+	}
+	int* next = malloc(sizeof(int) * (V > 0 ? V : 1));
+	for (int v = 0; v < V; v++) {
+		next[v] = offsets[v];
+	}
+	for (int n = 0; n < n_edges; n++) {
+		to_vertex[next[tree[n].u]] = tree[n].v;
+		weight[next[tree[n].u]++] = tree[n].weight;
+		to_vertex[next[tree[n].v]] = tree[n].u;
+		weight[next[tree[n].v]++] = tree[n].weight;
+	}
+
+	// Breadth-first search from each root, highest first (next is reused as the queue)
+	bool* visited = calloc(V > 0 ? V : 1, sizeof(bool));
+	int* queue = next;
+	for (int root = V - 1; root >= 0; root--) {
+		if (visited[root]) {
+			continue;
+		}
+		visited[root] = true;
+		int head = 0, tail = 0;
+		queue[tail++] = root;
+		while (head < tail) {
+			int v = queue[head++];
+			for (int e = offsets[v]; e < offsets[v + 1]; e++) {
+				int u = to_vertex[e];
+				if (!visited[u]) {
+					visited[u] = true;
+					add_edge(&MST_G, u, v, weight[e]);
+					queue[tail++] = u;
+				}
+			}
+		}
+	}
+
+	free(offsets);
+	free(to_vertex);
+	free(weight);
+	free(next);
+	free(visited);
+	return MST_G;
+}
+
+
+/* Run Kruskal's minimal spanning tree algorithm on a CSR graph --------
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: MST (Graph, same shape as csr_prims_mst())
+ */
+Graph csr_kruskal_mst(CSRGraph* self) {
+	STATS_BEGIN("kruskal_mst");
+	int V = self->V;
+
+	// Each undirected edge once, sorted
+	int n_edges = 0;
+	MSTEdge* edges = malloc(sizeof(MSTEdge) * (self->E / 2 + 1));
+	for (int v = 0; v < V; v++) {
+		for (int e = self->offsets[v]; e < self->offsets[v + 1]; e++) {
+			if (v < self->to_vertex[e]) {
+				edges[n_edges].weight = self->weight[e];
+				edges[n_edges].u = v;
+				edges[n_edges++].v = self->to_vertex[e];
+			}
+		}
+	}
+	qsort(edges, n_edges, sizeof(MSTEdge), compare_edges);
+
+	// Take edges in order while they join 2 different trees
+	int* parent = malloc(sizeof(int) * (V > 0 ? V : 1));
+	int* rank = calloc(V > 0 ? V : 1, sizeof(int));
+	for (int v = 0; v < V; v++) {
+		parent[v] = v;
+	}
+
+	int n_tree = 0;
+	MSTEdge* tree = malloc(sizeof(MSTEdge) * (V > 0 ? V : 1));
+	for (int n = 0; n < n_edges && n_tree < V - 1; n++) {
+		if (union_sets(parent, rank, edges[n].u, edges[n].v)) {
+			tree[n_tree++] = edges[n];
+		}
+	}
+
+	Graph MST_G = orient_forest(V, tree, n_tree);
+
+	/* Free Memory of dynamic arrays */
+	free(edges);
+	free(parent);
+	free(rank);
+	free(tree);
+
+	STATS_END("kruskal_mst");
+	return MST_G;
+}
+
+/* Run Boruvka's minimal spanning tree algorithm on a CSR graph (OpenMP)
+ *		Each round finds the cheapest edge out of every component (the edge scan runs in parallel), then adds them all
+ *		The number of components at least halves each round, so there are at most log2(V) rounds
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: MST (Graph, same shape as csr_prims_mst())
+ */
+Graph csr_boruvka_mst(CSRGraph* self) {
+	STATS_BEGIN("boruvka_mst");
+	int V = self->V;
+	int size = V > 0 ? V : 1;
+
+	int* parent = malloc(sizeof(int) * size);
+	int* rank = calloc(size, sizeof(int));
+	int* component = malloc(sizeof(int) * size);
+	int* best = malloc(sizeof(int) * size);				// cheapest edge (CSR index) from each vertex to another component
+	int* cheapest = malloc(sizeof(int) * size);			// cheapest edge (CSR index) out of each component
+	int* cheapest_from = malloc(sizeof(int) * size);	// vertex that edge starts at
+	for (int v = 0; v < V; v++) {
+		parent[v] = v;
+	}
+
+	int n_tree = 0;
+	MSTEdge* tree = malloc(sizeof(MSTEdge) * size);
+	bool merged = true;
+	while (merged && n_tree < V - 1) {
+		// Component of each vertex (parent is only read here, so no compression)
+		#pragma omp parallel for schedule(static)
+		for (int v = 0; v < V; v++) {
+			int root = v;
+			while (parent[root] != root) {
+				root = parent[root];
+			}
+			component[v] = root;
+		}
+
+		// Cheapest edge from each vertex to another component
+		#pragma omp parallel for schedule(dynamic, 1024)
+		for (int v = 0; v < V; v++) {
+			best[v] = -1;
+			for (int e = self->offsets[v]; e < self->offsets[v + 1]; e++) {
+				int u = self->to_vertex[e];
+				if (component[u] == component[v]) {
+					continue;
+				}
+				if (best[v] == -1 || lighter_csr_edge(self, v, e, v, best[v])) {
+					best[v] = e;
+				}
+			}
+		}
+
+		// Cheapest of those for each component
+		for (int v = 0; v < V; v++) {
+			cheapest[v] = -1;
+		}
+		for (int v = 0; v < V; v++) {
+			int e = best[v];
+			if (e == -1) {
+				continue;
+			}
+			int c = component[v];
+			if (cheapest[c] == -1 || lighter_csr_edge(self, v, e, cheapest_from[c], cheapest[c])) {
+				cheapest[c] = e;
+				cheapest_from[c] = v;
+			}
+		}
+
+		// Add them (2 components may pick the same edge, union_sets() skips the second)
+		merged = false;
+		for (int c = 0; c < V; c++) {
+			int e = cheapest[c];
+			if (e == -1) {
+				continue;
+			}
+			int v = cheapest_from[c];
+			int u = self->to_vertex[e];
+			if (union_sets(parent, rank, v, u)) {
+				tree[n_tree].weight = self->weight[e];
+				tree[n_tree].u = v < u ? v : u;
+				tree[n_tree++].v = v < u ? u : v;
+				merged = true;
+			}
+		}
+	}
+
+	Graph MST_G = orient_forest(V, tree, n_tree);
+
+	/* Free Memory of dynamic arrays */
+	free(parent);
+	free(rank);
+	free(component);
+	free(best);
+	free(cheapest);
+	free(cheapest_from);
+	free(tree);
+
+	STATS_END("boruvka_mst");
+	return MST_G;
+}
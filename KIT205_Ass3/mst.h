@@ -0,0 +1,67 @@
+#ifndef MST_H
+#define MST_H
+
+#include "graph.h"
+
+/* Minimum spanning tree algorithms
+ *		MST_PRIM		Prim's algorithm (priority queue, see csr_prims_mst(), or a vectorised key array on dense maps,
+ *						see csr_dense_prims_mst())
+ *		MST_KRUSKAL		Kruskal's algorithm (sorted edge array and union-find)
+ *		MST_BORUVKA		Boruvka's algorithm (cheapest edge of every component found in parallel, for very large maps)
+ *		All return the same shape of Graph (see csr_mst())
+ */
+typedef enum mstKind {
+	MST_PRIM,
+	MST_KRUSKAL,
+	MST_BORUVKA
+} MSTKind;
+
+
+/* Set the MST algorithm used by csr_mst()
+ * Parameters:
+ *		kind		MST_PRIM, MST_KRUSKAL or MST_BORUVKA
+ * Return: void
+ */
+void set_mst_kind(MSTKind kind);
+
+
+/* Get the MST algorithm used by csr_mst()
+ * No parameters
+ * Return: MSTKind
+ */
+MSTKind get_mst_kind();
+
+
+/* Name of an MST algorithm (for output)
+ * Parameters:
+ *		kind		MSTKind
+ * Return: "Prim's", "Kruskal's" or "Boruvka's"
+ */
+const char* mst_kind_name(MSTKind kind);
+
+
+/* Run the selected MST algorithm on a CSR graph ----------------------
+ *		Rooted at the last vertex: each other vertex has exactly 1 edge, to its parent
+ *		(a disconnected graph gives a forest, each tree rooted at its highest vertex)
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: MST (Graph)
+ */
+Graph csr_mst(CSRGraph* self);
+
+
+/* Run Kruskal's minimal spanning tree algorithm on a CSR graph --------
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: MST (Graph, same shape as csr_prims_mst())
+ */
+Graph csr_kruskal_mst(CSRGraph* self);
+
+
+/* Run Boruvka's minimal spanning tree algorithm on a CSR graph (OpenMP)
+ * Parameters:
+ *		self		CSRGraph instance
+ * Return: MST (Graph, same shape as csr_prims_mst())
+ */
+Graph csr_boruvka_mst(CSRGraph* self);
+#endif
@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include "parser.h"
+#include "mapfile.h"
+
+
+/* Read all of stdin into a malloc'd buffer
+ * Parameters:
+ *		self		Parser instance
+ * Return: true if stdin was read
+ */
+static bool read_stdin(Parser* self) {
+	size_t capacity = 1 << 16;
+	size_t length = 0;
+	char* buffer = malloc(capacity);
+
+	size_t n_read;
+	while ((n_read = fread(buffer + length, 1, capacity - length, stdin)) > 0) {
+		length += n_read;
+		if (length == capacity) {
+			capacity *= 2;
+			buffer = realloc(buffer, capacity);
+		}
+	}
+
+	self->buffer = buffer;
+	self->length = length;
+	self->mapped = false;
+	return true;
+}
+
+/* Open an input for parsing
+ *		path == NULL reads all of stdin into memory, otherwise the file is memory-mapped
+ * Parameters:
+ *		self		pointer to Parser to initialise
+ *		path		file path, or NULL for stdin
+ * Return: true if the input was opened
+ */
+bool open_parser(Parser* self, const char* path) {
+	self->name = path != NULL ? path : "stdin";
+	self->pos = 0;
+	self->line = 1;
+	self->failed = false;
+
+	bool opened;
+	if (path != NULL) {
+		void* memory;
+		opened = map_file(path, &memory, &self->length);
+		self->buffer = memory;
+		self->mapped = true;
+	}
+	else {
+		opened = read_stdin(self);
+	}
+	if (!opened) {
+		fprintf(stderr, "Cannot open input file '%s'\n", path);
+		self->failed = true;
+		return false;
+	}
+
+	// Skip UTF-8 byte order mark
+	if (self->length >= 3 && memcmp(self->buffer, "\xEF\xBB\xBF", 3) == 0) {
+		self->pos = 3;
+	}
+	return true;
+}
+
+/* Close an input (unmap / free the buffer)
+ * Parameters:
+ *		self		Parser instance
+ * Return: void
+ */
+void close_parser(Parser* self) {
+	if (self->buffer == NULL) {
+		return;
+	}
+
+	if (self->mapped) {
+		unmap_file((void*)self->buffer, self->length);
+	}
+	else {
+		free((void*)self->buffer);
+	}
+	self->buffer = NULL;
+}
+
+
+/* Skip spaces, tabs and line breaks (counting lines) */
+static void skip_whitespace(Parser* self) {
+	while (self->pos < self->length) {
+		char c = self->buffer[self->pos];
+		if (c == '\n') {
+			self->line++;
+		}
+		else if (c != ' ' && c != '\t' && c != '\r') {
+			break;
+		}
+		self->pos++;
+	}
+}
+
+/* Check if only whitespace is left in the input
+ * Parameters:
+ *		self		Parser instance
+ * Return: true / false
+ */
+bool parser_at_end(Parser* self) {
+	skip_whitespace(self);
+	return self->pos >= self->length;
+}
+
+/* Report an error at the current line (only the first error is printed)
+ * Parameters:
+ *		self		Parser instance
+ *		message		description of the problem
+ * Return: void
+ */
+void parser_error(Parser* self, const char* message) {
+	if (!self->failed) {
+		fprintf(stderr, "%s:%d: %s\n", self->name, self->line, message);
+	}
+	self->failed = true;
+}
+
+/* Read digits of an integer at the current position (no whitespace skipped)
+ * Return: true if an integer that fits in an int was read
+ */
+static bool read_number(Parser* self, int* value) {
+	bool negative = false;
+	if (self->pos < self->length && self->buffer[self->pos] == '-') {
+		negative = true;
+		self->pos++;
+	}
+
+	if (self->pos >= self->length || self->buffer[self->pos] < '0' || self->buffer[self->pos] > '9') {
+		return false;
+	}
+
+	long long number = 0;
+	while (self->pos < self->length && self->buffer[self->pos] >= '0' && self->buffer[self->pos] <= '9') {
+		number = number * 10 + (self->buffer[self->pos] - '0');
+		if (number > INT_MAX) {
+			return false;
+		}
+		self->pos++;
+	}
+
+	*value = negative ? (int)-number : (int)number;
+	return true;
+}
+
+/* Read the next integer
+ * Parameters:
+ *		self		Parser instance
+ *		value		pointer to variable storing the integer
+ *		what		description of the value, for the error message
+ * Return: true if an integer was read (false also makes self->failed true)
+ */
+bool parse_int(Parser* self, int* value, const char* what) {
+	char message[128];
+	if (self->failed) {
+		return false;
+	}
+
+	skip_whitespace(self);
+	if (!read_number(self, value)) {
+		snprintf(message, sizeof(message), "expected %s", what);
+		parser_error(self, message);
+		return false;
+	}
+	return true;
+}
+
+/* Read the next pair of integers written as "x,y"
+ * Parameters:
+ *		self		Parser instance
+ *		x			pointer to variable storing the first integer
+ *		y			pointer to variable storing the second integer
+ *		what		description of the pair, for the error message
+ * Return: true if a pair was read (false also makes self->failed true)
+ */
+bool parse_pair(Parser* self, int* x, int* y, const char* what) {
+	char message[128];
+	if (self->failed) {
+		return false;
+	}
+
+	skip_whitespace(self);
+	bool ok = read_number(self, x);
+	if (ok && self->pos < self->length && self->buffer[self->pos] == ',') {
+		self->pos++;
+		ok = read_number(self, y);
+	}
+	else {
+		ok = false;
+	}
+
+	if (!ok) {
+		snprintf(message, sizeof(message), "expected %s", what);
+		parser_error(self, message);
+		return false;
+	}
+	return true;
+}
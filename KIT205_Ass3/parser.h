@@ -0,0 +1,75 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Tokenizer over a whole input held in memory (read from stdin, or a memory-mapped file)
+ *		Errors are reported once, with the line number, and make failed true (checked by callers)
+ */
+typedef struct parser {
+	const char* name;
+	const char* buffer;
+	size_t length;
+	size_t pos;
+	int line;
+	bool failed;
+	bool mapped;
+} Parser;
+
+
+/* Open an input for parsing
+ *		path == NULL reads all of stdin into memory, otherwise the file is memory-mapped
+ * Parameters:
+ *		self		pointer to Parser to initialise
+ *		path		file path, or NULL for stdin
+ * Return: true if the input was opened
+ */
+bool open_parser(Parser* self, const char* path);
+
+
+/* Close an input (unmap / free the buffer)
+ * Parameters:
+ *		self		Parser instance
+ * Return: void
+ */
+void close_parser(Parser* self);
+
+
+/* Check if only whitespace is left in the input
+ * Parameters:
+ *		self		Parser instance
+ * Return: true / false
+ */
+bool parser_at_end(Parser* self);
+
+
+/* Read the next integer
+ * Parameters:
+ *		self		Parser instance
+ *		value		pointer to variable storing the integer
+ *		what		description of the value, for the error message
+ * Return: true if an integer was read (false also makes self->failed true)
+ */
+bool parse_int(Parser* self, int* value, const char* what);
+
+
+/* Read the next pair of integers written as "x,y"
+ * Parameters:
+ *		self		Parser instance
+ *		x			pointer to variable storing the first integer
+ *		y			pointer to variable storing the second integer
+ *		what		description of the pair, for the error message
+ * Return: true if a pair was read (false also makes self->failed true)
+ */
+bool parse_pair(Parser* self, int* x, int* y, const char* what);
+
+
+/* Report an error at the current line (only the first error is printed)
+ * Parameters:
+ *		self		Parser instance
+ *		message		description of the problem
+ * Return: void
+ */
+void parser_error(Parser* self, const char* message);
+#endif
@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "graph.h"
+#include "pathcache.h"
+#include "stats.h"
+
+
+/* Create an empty path cache for a map
+ * Parameters:
+ *		map			CSRGraph instance (must outlive the cache)
+ * Return: PathCache
+ */
+PathCache create_path_cache(CSRGraph* map) {
+	PathCache cache;
+	cache.map = map;
+	cache.n_trees = 0;
+	cache.sources = malloc(sizeof(int) * (map->V > 0 ? map->V : 1));
+	cache.repair_stack = NULL;
+	cache.hierarchy = NULL;
+	cache.dist = malloc(sizeof(int*) * map->V);
+	cache.pred_v = malloc(sizeof(int*) * map->V);
+	for (int v = 0; v < map->V; v++) {
+		cache.dist[v] = NULL;
+		cache.pred_v[v] = NULL;
+	}
+	return cache;
+}
+
+/* Destroy a path cache (free all memory)
+ * Parameters:
+ *		self		PathCache instance
+ * Return: void
+ */
+void destroy_path_cache(PathCache* self) {
+	for (int v = 0; v < self->map->V; v++) {
+		free(self->dist[v]);
+		free(self->pred_v[v]);
+	}
+	free(self->dist);
+	free(self->pred_v);
+	free(self->sources);
+	if (self->repair_stack != NULL) {
+		destroy_pqueue(&self->repair_queue);
+		free(self->repair_stack);
+	}
+}
+
+/* Compute the shortest path tree of a source if it is not cached yet
+ * Parameters:
+ *		self		PathCache instance
+ *		source		source vertex
+ * Return: void
+ */
+static void cache_tree(PathCache* self, int source) {
+	if (self->dist[source] != NULL) {
+		return;
+	}
+
+	self->dist[source] = malloc(sizeof(int) * self->map->V);
+	self->pred_v[source] = malloc(sizeof(int) * self->map->V);
+	csr_shortest_path_tree(self->map, source, self->dist[source], self->pred_v[source]);
+	self->sources[self->n_trees++] = source;
+	STATS_COUNT(STAT_PATH_TREES, 1);
+	STATS_COUNT(STAT_ALLOCATIONS, 2);
+}
+
+/* Answer lookups from sources without a cached tree with a contraction hierarchy of the map
+ *		A query only searches a few hundred vertices, against the whole map for a tree, so it pays off
+ *		whenever a source is only used for a few lookups (e.g. the distance network of kmb_steiner_tree())
+ *		The hierarchy query is not shared between threads, and it is detached by update_path_cache()
+ * Parameters:
+ *		self		PathCache instance
+ *		hierarchy	HierarchyQuery on a hierarchy of the map (NULL to detach)
+ * Return: void
+ */
+void attach_hierarchy(PathCache* self, HierarchyQuery* hierarchy) {
+	self->hierarchy = hierarchy;
+}
+
+/* Compute shortest path trees for a set of sources that are not cached yet
+ *		Trees are independent, so they are computed in parallel (OpenMP)
+ *		After this, lookups from these sources only read the cache (safe to share between threads)
+ * Parameters:
+ *		self		PathCache instance
+ *		sources[]	array of source vertices
+ *		n_sources	number of sources
+ * Return: void
+ */
+void warm_path_cache(PathCache* self, int sources[], int n_sources) {
+	STATS_BEGIN("warm_path_cache");
+
+	// Sources still missing from the cache (duplicates removed)
+	int* missing = malloc(sizeof(int) * (n_sources > 0 ? n_sources : 1));
+	int n_missing = 0;
+	for (int i = 0; i < n_sources; i++) {
+		int source = sources[i];
+		if (self->dist[source] == NULL) {
+			self->dist[source] = malloc(sizeof(int) * self->map->V);
+			self->pred_v[source] = malloc(sizeof(int) * self->map->V);
+			missing[n_missing++] = source;
+		}
+	}
+
+	// Only write to the cache if something is missing (solvers call this on a shared, warm cache)
+	if (n_missing > 0) {
+		#pragma omp parallel for schedule(dynamic)
+		for (int i = 0; i < n_missing; i++) {
+			csr_shortest_path_tree(self->map, missing[i], self->dist[missing[i]], self->pred_v[missing[i]]);
+		}
+		for (int i = 0; i < n_missing; i++) {
+			self->sources[self->n_trees++] = missing[i];
+		}
+	}
+	free(missing);
+	STATS_COUNT(STAT_PATH_TREES, n_missing);
+	STATS_COUNT(STAT_ALLOCATIONS, 1 + 2 * (long long)n_missing);
+	STATS_END("warm_path_cache");
+}
+
+/* Shortest distance between 2 vertices (computes the tree of source if not cached, unless a hierarchy is attached)
+ * Parameters:
+ *		self			PathCache instance
+ *		source			source vertex
+ *		destination		destination vertex
+ * Return: distance (INT_MAX if unreachable)
+ */
+int cached_distance(PathCache* self, int source, int destination) {
+	if (self->dist[source] == NULL && self->hierarchy != NULL) {
+		return hierarchy_distance(self->hierarchy, source, destination);
+	}
+	cache_tree(self, source);
+	return self->dist[source][destination];
+}
+
+/* Shortest path between 2 vertices (computes the tree of source if not cached, unless a hierarchy is attached)
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			PathCache instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (can be NULL)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path, from source to destination
+ */
+EdgeList cached_path(PathCache* self, int source, int destination, int* distance, Arena* arena) {
+	if (self->dist[source] == NULL && self->hierarchy != NULL) {
+		return hierarchy_path(self->hierarchy, source, destination, distance, arena);
+	}
+	cache_tree(self, source);
+	if (distance != NULL) {
+		*distance = self->dist[source][destination];
+	}
+	return trace_path(self->pred_v[source], destination, arena);
+}
+
+
+/* Create a graph that combines edges from tickets, using cached shortest paths
+ * Parameters:
+ *		self			PathCache instance
+ *		from_cities[]	array of source vertices in tickets
+ *		to_citites[]	array of destination vertices in tickets
+ *		n_tickets		number of tickets
+ * Return: Graph containing shortest path edges
+ */
+Graph cached_shortest_paths(PathCache* self, int from_cities[], int to_cities[], int n_tickets) {
+	STATS_BEGIN("cached_shortest_paths");
+
+	// Initialise graph with all vertices (but no edges)
+	Graph shortest_G = create_empty_graph(self->map->V);
+
+	// Path nodes, reset after each ticket
+	Arena* scratch = create_arena(sizeof(struct edgeNode) * 64);
+
+	for (int n = 0; n < n_tickets; n++) {
+		EdgeList path = cached_path(self, from_cities[n], to_cities[n], NULL, scratch);
+		add_path_edges(&shortest_G, self->map, path);
+		arena_reset(scratch);
+	}
+
+	destroy_arena(scratch);
+
+	STATS_END("cached_shortest_paths");
+	return shortest_G;
+}
+
+
+/* Steiner tree with set of terminal vertices, using cached shortest path trees of the terminals
+ *		Same greedy as steiner_tree(): repeatedly connect the terminal closest to the tree
+ *		The tree of terminal t gives its distance to every tree vertex, so no search is needed per round
+ * Parameters:
+ *		self			PathCache instance
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ * Return: steiner tree (Graph)
+ */
+Graph cached_steiner_tree(PathCache* self, int terminals[], int n_terminals) {
+	STATS_BEGIN("cached_steiner_tree");
+	int V = self->map->V;
+
+	// Initialise graph with all vertices (but no edges)
+	Graph steiner_t = create_empty_graph(V);
+
+	// No tickets: nothing to connect
+	if (n_terminals == 0) {
+		STATS_END("cached_steiner_tree");
+		return steiner_t;
+	}
+
+	warm_path_cache(self, terminals, n_terminals);
+
+	// Vertices in tree (flag + list, so each round only looks at tree vertices)
+	bool* inTree = malloc(sizeof(bool) * V);
+	int* tree_vertices = malloc(sizeof(int) * V);
+	int n_tree = 0;
+
+	// Terminals not yet connected (duplicates removed)
+	bool* isTerm = malloc(sizeof(bool) * V);
+	int* remaining = malloc(sizeof(int) * n_terminals);
+	int n_remaining = 0;
+
+	for (int v = 0; v < V; v++) {
+		inTree[v] = false;
+		isTerm[v] = false;
+	}
+
+	// Add first terminal vertex to tree
+	inTree[terminals[0]] = true;
+	tree_vertices[n_tree++] = terminals[0];
+
+	for (int i = 1; i < n_terminals; i++) {
+		if (!isTerm[terminals[i]] && terminals[i] != terminals[0]) {
+			isTerm[terminals[i]] = true;
+			remaining[n_remaining++] = terminals[i];
+		}
+	}
+
+	// Path nodes of each round, reset once the path is in the tree
+	Arena* scratch = create_arena(sizeof(struct edgeNode) * 64);
+
+	while (n_remaining > 0) {
+		// Find closest terminal not in tree to a vertex in tree
+		int closest_distance = INT_MAX;
+		int closest_term = -1;
+		int closest_tree_v = -1;
+		for (int i = 0; i < n_remaining; i++) {
+			int* dist = self->dist[remaining[i]];
+			for (int j = 0; j < n_tree; j++) {
+				if (dist[tree_vertices[j]] < closest_distance) {
+					closest_distance = dist[tree_vertices[j]];
+					closest_term = i;
+					closest_tree_v = tree_vertices[j];
+				}
+			}
+		}
+
+		// Remaining terminals are unreachable
+		if (closest_term == -1) {
+			break;
+		}
+
+		// Path from the tree vertex back to the terminal (along the terminal's shortest path tree)
+		EdgeList shortest_path = trace_path(self->pred_v[remaining[closest_term]], closest_tree_v, scratch);
+		add_path_edges(&steiner_t, self->map, shortest_path);
+
+		// Set inTree value to true (terminals passed on the way are connected too)
+		EdgeNodePtr current = shortest_path.head;
+		while (current != NULL) {
+			int v = current->edge.to_vertex;
+			if (!inTree[v]) {
+				inTree[v] = true;
+				tree_vertices[n_tree++] = v;
+			}
+			current = current->next;
+		}
+		arena_reset(scratch);
+
+		// Remove connected terminals from remaining
+		int kept = 0;
+		for (int i = 0; i < n_remaining; i++) {
+			if (!inTree[remaining[i]]) {
+				remaining[kept++] = remaining[i];
+			}
+		}
+		n_remaining = kept;
+	}
+
+	/* Free memory for dynamic arrays */
+	free(inTree);
+	free(tree_vertices);
+	free(isTerm);
+	free(remaining);
+	destroy_arena(scratch);
+	STATS_COUNT(STAT_ALLOCATIONS, 4);
+
+	STATS_END("cached_steiner_tree");
+	return steiner_t;
+}
+
+
+/* Repair every cached tree after the weight of route uv changed in the map
+ *		The map must already have the new weight (see csr_set_edge_weight() / csr_remove_edge())
+ *		Each tree only searches again where its distances change (see csr_repair_shortest_path_tree())
+ *		An attached hierarchy no longer matches the map, so it is detached
+ * Parameters:
+ *		self			PathCache instance
+ *		v				first city of the route
+ *		u				second city of the route
+ *		old_weight		weight before the change
+ *		new_weight		weight after the change (INT_MAX if the route was removed)
+ * Return: void
+ */
+void update_path_cache(PathCache* self, int v, int u, int old_weight, int new_weight) {
+	self->hierarchy = NULL;
+	if (self->repair_stack == NULL) {
+		self->repair_queue = create_pqueue(self->map->V, get_pq_kind());
+		self->repair_stack = malloc(sizeof(int) * (self->map->V > 0 ? self->map->V : 1));
+	}
+
+	for (int i = 0; i < self->n_trees; i++) {
+		int source = self->sources[i];
+		csr_repair_shortest_path_tree(self->map, self->dist[source], self->pred_v[source], v, u, old_weight, new_weight,
+			&self->repair_queue, self->repair_stack);
+	}
+}
+
+/* Remove a route from the map (e.g. claimed by another player) and repair the cache
+ * Parameters:
+ *		self		PathCache instance
+ *		v			first city of the route
+ *		u			second city of the route
+ * Return: old weight of the route, -1 if there is no such route
+ */
+int cache_remove_route(PathCache* self, int v, int u) {
+	int old_weight = csr_remove_edge(self->map, v, u);
+	if (old_weight != -1) {
+		update_path_cache(self, v, u, old_weight, INT_MAX);
+	}
+	return old_weight;
+}
+
+/* Change the weight of a route in the map and repair the cache
+ * Parameters:
+ *		self		PathCache instance
+ *		v			first city of the route
+ *		u			second city of the route
+ *		weight		new weight
+ * Return: old weight of the route, -1 if there is no such route
+ */
+int cache_set_route_weight(PathCache* self, int v, int u, int weight) {
+	int old_weight = csr_set_edge_weight(self->map, v, u, weight);
+	if (old_weight != -1) {
+		update_path_cache(self, v, u, old_weight, weight);
+	}
+	return old_weight;
+}
@@ -0,0 +1,145 @@
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include "graph.h"
+#include "hierarchy.h"
+
+/* Cache of shortest path trees, keyed by source vertex
+ *		dist[s] / pred_v[s] are the Dijkstra arrays from source s (NULL until s is first used)
+ *		sources[] lists the n_trees sources cached so far
+ *		The cache stays valid for every ticket set on the same map
+ *		When a route is claimed or reweighted, update_path_cache() repairs each tree instead of dropping it
+ *		(repair_queue / repair_stack are created on the first update)
+ *		hierarchy (NULL unless attached) answers lookups from sources without a tree, instead of computing the tree
+ */
+typedef struct pathCache {
+	CSRGraph* map;
+	int** dist;
+	int** pred_v;
+	int* sources;
+	int n_trees;
+	PQueue repair_queue;
+	int* repair_stack;
+	HierarchyQuery* hierarchy;
+} PathCache;
+
+
+/* Create an empty path cache for a map
+ * Parameters:
+ *		map			CSRGraph instance (must outlive the cache)
+ * Return: PathCache
+ */
+PathCache create_path_cache(CSRGraph* map);
+
+
+/* Destroy a path cache (free all memory)
+ * Parameters:
+ *		self		PathCache instance
+ * Return: void
+ */
+void destroy_path_cache(PathCache* self);
+
+
+/* Answer lookups from sources without a cached tree with a contraction hierarchy of the map
+ *		A query only searches a few hundred vertices, against the whole map for a tree, so it pays off
+ *		whenever a source is only used for a few lookups (e.g. the distance network of kmb_steiner_tree())
+ *		The hierarchy query is not shared between threads, and it is detached by update_path_cache()
+ * Parameters:
+ *		self		PathCache instance
+ *		hierarchy	HierarchyQuery on a hierarchy of the map (NULL to detach)
+ * Return: void
+ */
+void attach_hierarchy(PathCache* self, HierarchyQuery* hierarchy);
+
+
+/* Compute shortest path trees for a set of sources that are not cached yet
+ *		Trees are independent, so they are computed in parallel (OpenMP)
+ *		After this, lookups from these sources only read the cache (safe to share between threads)
+ * Parameters:
+ *		self		PathCache instance
+ *		sources[]	array of source vertices
+ *		n_sources	number of sources
+ * Return: void
+ */
+void warm_path_cache(PathCache* self, int sources[], int n_sources);
+
+
+/* Shortest distance between 2 vertices (computes the tree of source if not cached, unless a hierarchy is attached)
+ * Parameters:
+ *		self			PathCache instance
+ *		source			source vertex
+ *		destination		destination vertex
+ * Return: distance (INT_MAX if unreachable)
+ */
+int cached_distance(PathCache* self, int source, int destination);
+
+
+/* Shortest path between 2 vertices (computes the tree of source if not cached, unless a hierarchy is attached)
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			PathCache instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (can be NULL)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path, from source to destination
+ */
+EdgeList cached_path(PathCache* self, int source, int destination, int* distance, Arena* arena);
+
+
+/* Create a graph that combines edges from tickets, using cached shortest paths
+ * Parameters:
+ *		self			PathCache instance
+ *		from_cities[]	array of source vertices in tickets
+ *		to_citites[]	array of destination vertices in tickets
+ *		n_tickets		number of tickets
+ * Return: Graph containing shortest path edges
+ */
+Graph cached_shortest_paths(PathCache* self, int from_cities[], int to_cities[], int n_tickets);
+
+
+/* Steiner tree with set of terminal vertices, using cached shortest path trees of the terminals
+ *		Same greedy as steiner_tree(): repeatedly connect the terminal closest to the tree
+ * Parameters:
+ *		self			PathCache instance
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ * Return: steiner tree (Graph), no edges if there are no terminals
+ */
+Graph cached_steiner_tree(PathCache* self, int terminals[], int n_terminals);
+
+
+/* Repair every cached tree after the weight of route uv changed in the map
+ *		The map must already have the new weight (see csr_set_edge_weight() / csr_remove_edge())
+ *		An attached hierarchy no longer matches the map, so it is detached
+ * Parameters:
+ *		self			PathCache instance
+ *		v				first city of the route
+ *		u				second city of the route
+ *		old_weight		weight before the change
+ *		new_weight		weight after the change (INT_MAX if the route was removed)
+ * Return: void
+ */
+void update_path_cache(PathCache* self, int v, int u, int old_weight, int new_weight);
+
+
+/* Remove a route from the map (e.g. claimed by another player) and repair the cache
+ * Parameters:
+ *		self		PathCache instance
+ *		v			first city of the route
+ *		u			second city of the route
+ * Return: old weight of the route, -1 if there is no such route
+ */
+int cache_remove_route(PathCache* self, int v, int u);
+
+
+/* Change the weight of a route in the map and repair the cache
+ * Parameters:
+ *		self		PathCache instance
+ *		v			first city of the route
+ *		u			second city of the route
+ *		weight		new weight
+ * Return: old weight of the route, -1 if there is no such route
+ */
+int cache_set_route_weight(PathCache* self, int v, int u, int weight);
+#endif
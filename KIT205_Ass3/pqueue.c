@@ -0,0 +1,361 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "pqueue.h"
+#include "stats.h"
+
+// Implementation used by the graph algorithms (chosen once, e.g. from command line)
+static PQKind pq_kind = PQ_BINARY;
+
+
+/* Set the priority queue implementation used by the graph algorithms
+ * Parameters:
+ *		kind		PQ_BINARY or PQ_PAIRING
+ * Return: void
+ */
+void set_pq_kind(PQKind kind) {
+	pq_kind = kind;
+}
+
+/* Get the priority queue implementation used by the graph algorithms
+ * No parameters
+ * Return: PQKind
+ */
+PQKind get_pq_kind() {
+	return pq_kind;
+}
+
+
+/* Create an empty priority queue
+ * Parameters:
+ *		capacity	number of items (items are 0 .. capacity-1)
+ *		kind		PQ_BINARY or PQ_PAIRING
+ * Return: PQueue
+ */
+PQueue create_pqueue(int capacity, PQKind kind) {
+	PQueue Q;
+	Q.kind = kind;
+	Q.capacity = capacity;
+	Q.size = 0;
+	Q.key = malloc(sizeof(int) * capacity);
+	Q.queued = malloc(sizeof(bool) * capacity);
+	Q.heap = NULL;
+	Q.pos = NULL;
+	Q.root = -1;
+	Q.child = NULL;
+	Q.sibling = NULL;
+	Q.prev = NULL;
+
+	if (kind == PQ_BINARY) {
+		Q.heap = malloc(sizeof(int) * capacity);
+		Q.pos = malloc(sizeof(int) * capacity);
+	}
+	else {
+		Q.child = malloc(sizeof(int) * capacity);
+		Q.sibling = malloc(sizeof(int) * capacity);
+		Q.prev = malloc(sizeof(int) * capacity);
+	}
+
+	for (int i = 0; i < capacity; i++) {
+		Q.queued[i] = false;
+	}
+	STATS_COUNT(STAT_ALLOCATIONS, 4);
+
+	return Q;
+}
+
+/* Destroy a priority queue (free all memory)
+ * Parameters:
+ *		self		PQueue instance
+ * Return: void
+ */
+void destroy_pqueue(PQueue* self) {
+	free(self->key);
+	free(self->queued);
+	free(self->heap);
+	free(self->pos);
+	free(self->child);
+	free(self->sibling);
+	free(self->prev);
+}
+
+/* Check if the priority queue is empty
+ * Parameters:
+ *		self		PQueue instance
+ * Return: true / false
+ */
+bool pq_is_empty(PQueue* self) {
+	return self->size == 0;
+}
+
+/* Check if an item is currently in the priority queue
+ * Parameters:
+ *		self		PQueue instance
+ *		item		item to check
+ * Return: true / false
+ */
+bool pq_contains(PQueue* self, int item) {
+	return self->queued[item];
+}
+
+
+/* Binary heap ----------------------------------------------------- */
+
+/* Swap 2 entries of the heap array (and update their positions) */
+static void heap_swap(PQueue* self, int i, int j) {
+	int item_i = self->heap[i];
+	int item_j = self->heap[j];
+	self->heap[i] = item_j;
+	self->heap[j] = item_i;
+	self->pos[item_j] = i;
+	self->pos[item_i] = j;
+}
+
+/* Move entry at index i up until its parent is not larger */
+static void heap_sift_up(PQueue* self, int i) {
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (self->key[self->heap[parent]] <= self->key[self->heap[i]]) {
+			break;
+		}
+		heap_swap(self, i, parent);
+		i = parent;
+	}
+}
+
+/* Move entry at index i down until both children are not smaller */
+static void heap_sift_down(PQueue* self, int i) {
+	while (true) {
+		int smallest = i;
+		int left = 2 * i + 1;
+		int right = left + 1;
+		if (left < self->size && self->key[self->heap[left]] < self->key[self->heap[smallest]]) {
+			smallest = left;
+		}
+		if (right < self->size && self->key[self->heap[right]] < self->key[self->heap[smallest]]) {
+			smallest = right;
+		}
+		if (smallest == i) {
+			break;
+		}
+		heap_swap(self, i, smallest);
+		i = smallest;
+	}
+}
+
+
+/* Pairing heap ---------------------------------------------------- */
+
+/* Meld 2 detached trees (roots a and b), the larger root becomes leftmost child of the smaller
+ * Return: root of melded tree
+ */
+static int pairing_meld(PQueue* self, int a, int b) {
+	if (a == -1) {
+		return b;
+	}
+	if (b == -1) {
+		return a;
+	}
+	if (self->key[b] < self->key[a]) {
+		int temp = a;
+		a = b;
+		b = temp;
+	}
+
+	self->sibling[b] = self->child[a];
+	if (self->child[a] != -1) {
+		self->prev[self->child[a]] = b;
+	}
+	self->prev[b] = a;
+	self->child[a] = b;
+	self->sibling[a] = -1;
+	self->prev[a] = -1;
+	return a;
+}
+
+/* Combine a list of sibling trees into 1 tree (two-pass pairing)
+ *		Pass 1: meld pairs left to right, stacking the results (linked by sibling)
+ *		Pass 2: meld the stacked trees right to left
+ * Return: root of combined tree
+ */
+static int pairing_combine(PQueue* self, int first) {
+	int stack = -1;
+	while (first != -1) {
+		int a = first;
+		int b = self->sibling[a];
+		if (b == -1) {
+			first = -1;
+		}
+		else {
+			first = self->sibling[b];
+			self->sibling[b] = -1;
+			self->prev[b] = -1;
+		}
+		self->sibling[a] = -1;
+		self->prev[a] = -1;
+
+		int melded = pairing_meld(self, a, b);
+		self->sibling[melded] = stack;
+		stack = melded;
+	}
+
+	int result = -1;
+	while (stack != -1) {
+		int next = self->sibling[stack];
+		self->sibling[stack] = -1;
+		result = pairing_meld(self, result, stack);
+		stack = next;
+	}
+	return result;
+}
+
+
+/* Insert an item that is not in the priority queue
+ * Parameters:
+ *		self		PQueue instance
+ *		item		item to insert
+ *		key			priority of the item (smaller comes out first)
+ * Return: void
+ */
+void pq_insert(PQueue* self, int item, int key) {
+	if (item < 0 || item >= self->capacity || self->queued[item]) {
+		fprintf(stderr, "Item %d cannot be inserted\n", item);
+		return;
+	}
+
+	self->key[item] = key;
+	self->queued[item] = true;
+	self->size++;
+
+	if (self->kind == PQ_BINARY) {
+		self->heap[self->size - 1] = item;
+		self->pos[item] = self->size - 1;
+		heap_sift_up(self, self->size - 1);
+	}
+	else {
+		self->child[item] = -1;
+		self->sibling[item] = -1;
+		self->prev[item] = -1;
+		self->root = pairing_meld(self, self->root, item);
+	}
+}
+
+/* Lower the key of an item that is in the priority queue
+ * Parameters:
+ *		self		PQueue instance
+ *		item		item to update
+ *		key			new key (must not be larger than the current key)
+ * Return: void
+ */
+void pq_decrease_key(PQueue* self, int item, int key) {
+	if (item < 0 || item >= self->capacity || !self->queued[item] || key > self->key[item]) {
+		fprintf(stderr, "Key of item %d cannot be decreased\n", item);
+		return;
+	}
+
+	self->key[item] = key;
+
+	if (self->kind == PQ_BINARY) {
+		heap_sift_up(self, self->pos[item]);
+	}
+	else if (item != self->root) {
+		// Cut item (with its subtree) from its parent, then meld it with the root
+		int prev = self->prev[item];
+		if (self->child[prev] == item) {
+			self->child[prev] = self->sibling[item];
+		}
+		else {
+			self->sibling[prev] = self->sibling[item];
+		}
+		if (self->sibling[item] != -1) {
+			self->prev[self->sibling[item]] = prev;
+		}
+		self->sibling[item] = -1;
+		self->prev[item] = -1;
+		self->root = pairing_meld(self, self->root, item);
+	}
+}
+
+/* Remove the item with the smallest key
+ *		Also change value of pre-created key (passed by reference)
+ * Parameters:
+ *		self		PQueue instance
+ *		key			pointer to variable storing key of removed item (can be NULL)
+ * Return: removed item (-1 if queue is empty)
+ */
+int pq_pop_min(PQueue* self, int* key) {
+	if (self->size == 0) {
+		return -1;
+	}
+
+	int item;
+	if (self->kind == PQ_BINARY) {
+		item = self->heap[0];
+		heap_swap(self, 0, self->size - 1);
+		self->size--;
+		heap_sift_down(self, 0);
+	}
+	else {
+		item = self->root;
+		self->root = pairing_combine(self, self->child[item]);
+		self->child[item] = -1;
+		self->size--;
+	}
+
+	self->queued[item] = false;
+	if (key != NULL) {
+		*key = self->key[item];
+	}
+	return item;
+}
+
+/* Look at the item with the smallest key without removing it
+ *		Also change value of pre-created key (passed by reference)
+ * Parameters:
+ *		self		PQueue instance
+ *		key			pointer to variable storing key of the item (can be NULL)
+ * Return: item (-1 if queue is empty)
+ */
+int pq_peek_min(PQueue* self, int* key) {
+	if (self->size == 0) {
+		return -1;
+	}
+
+	int item = self->kind == PQ_BINARY ? self->heap[0] : self->root;
+	if (key != NULL) {
+		*key = self->key[item];
+	}
+	return item;
+}
+
+/* Remove every item (time proportional to the number of items, not the capacity)
+ * Parameters:
+ *		self		PQueue instance
+ * Return: void
+ */
+void pq_clear(PQueue* self) {
+	if (self->kind == PQ_BINARY) {
+		for (int i = 0; i < self->size; i++) {
+			self->queued[self->heap[i]] = false;
+		}
+	}
+	else {
+		// Walk the tree as 1 list: the children of each item are spliced in before its next sibling
+		int item = self->root;
+		while (item != -1) {
+			self->queued[item] = false;
+			int next = self->sibling[item];
+			if (self->child[item] != -1) {
+				int last = self->child[item];
+				while (self->sibling[last] != -1) {
+					last = self->sibling[last];
+				}
+				self->sibling[last] = next;
+				next = self->child[item];
+			}
+			item = next;
+		}
+		self->root = -1;
+	}
+	self->size = 0;
+}
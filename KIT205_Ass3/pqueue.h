@@ -0,0 +1,133 @@
+#ifndef PQUEUE_H
+#define PQUEUE_H
+
+#include <stdbool.h>
+
+/* Implementations of the priority queue
+ *		PQ_BINARY		binary heap (array based)
+ *		PQ_PAIRING		pairing heap (array based, no allocation per node)
+ */
+typedef enum pqKind {
+	PQ_BINARY,
+	PQ_PAIRING
+} PQKind;
+
+/* Indexed min-priority queue of items 0 .. capacity-1 (e.g. vertices), each with an int key
+ *		Binary heap uses heap[] and pos[]
+ *		Pairing heap uses root, child[], sibling[] and prev[] (prev = parent for leftmost child)
+ */
+typedef struct pqueue {
+	PQKind kind;
+	int capacity;
+	int size;
+	int* key;
+	bool* queued;
+
+	// Binary heap
+	int* heap;
+	int* pos;
+
+	// Pairing heap
+	int root;
+	int* child;
+	int* sibling;
+	int* prev;
+} PQueue;
+
+
+/* Set the priority queue implementation used by the graph algorithms
+ * Parameters:
+ *		kind		PQ_BINARY or PQ_PAIRING
+ * Return: void
+ */
+void set_pq_kind(PQKind kind);
+
+
+/* Get the priority queue implementation used by the graph algorithms
+ * No parameters
+ * Return: PQKind
+ */
+PQKind get_pq_kind();
+
+
+/* Create an empty priority queue
+ * Parameters:
+ *		capacity	number of items (items are 0 .. capacity-1)
+ *		kind		PQ_BINARY or PQ_PAIRING
+ * Return: PQueue
+ */
+PQueue create_pqueue(int capacity, PQKind kind);
+
+
+/* Destroy a priority queue (free all memory)
+ * Parameters:
+ *		self		PQueue instance
+ * Return: void
+ */
+void destroy_pqueue(PQueue* self);
+
+
+/* Check if the priority queue is empty
+ * Parameters:
+ *		self		PQueue instance
+ * Return: true / false
+ */
+bool pq_is_empty(PQueue* self);
+
+
+/* Check if an item is currently in the priority queue
+ * Parameters:
+ *		self		PQueue instance
+ *		item		item to check
+ * Return: true / false
+ */
+bool pq_contains(PQueue* self, int item);
+
+
+/* Insert an item that is not in the priority queue
+ * Parameters:
+ *		self		PQueue instance
+ *		item		item to insert
+ *		key			priority of the item (smaller comes out first)
+ * Return: void
+ */
+void pq_insert(PQueue* self, int item, int key);
+
+
+/* Lower the key of an item that is in the priority queue
+ * Parameters:
+ *		self		PQueue instance
+ *		item		item to update
+ *		key			new key (must not be larger than the current key)
+ * Return: void
+ */
+void pq_decrease_key(PQueue* self, int item, int key);
+
+
+/* Remove the item with the smallest key
+ *		Also change value of pre-created key (passed by reference)
+ * Parameters:
+ *		self		PQueue instance
+ *		key			pointer to variable storing key of removed item (can be NULL)
+ * Return: removed item (-1 if queue is empty)
+ */
+int pq_pop_min(PQueue* self, int* key);
+
+
+/* Look at the item with the smallest key without removing it
+ *		Also change value of pre-created key (passed by reference)
+ * Parameters:
+ *		self		PQueue instance
+ *		key			pointer to variable storing key of the item (can be NULL)
+ * Return: item (-1 if queue is empty)
+ */
+int pq_peek_min(PQueue* self, int* key);
+
+
+/* Remove every item (time proportional to the number of items, not the capacity)
+ * Parameters:
+ *		self		PQueue instance
+ * Return: void
+ */
+void pq_clear(PQueue* self);
+#endif
@@ -0,0 +1,341 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "graph.h"
+#include "pqueue.h"
+#include "routesearch.h"
+#include "stats.h"
+
+
+/* Pick landmarks of a map and store their distances in it (map->landmark_dist), for alt_search()
+ *		Farthest-point selection: each landmark is the vertex farthest from those already picked
+ *		Called once per map, later weight changes drop them again (see csr_set_edge_weight())
+ * Parameters:
+ *		map				CSRGraph instance
+ *		n_landmarks		number of landmarks (0 for LANDMARK_DEFAULT_COUNT)
+ * Return: void
+ */
+void build_landmarks(CSRGraph* map, int n_landmarks) {
+	int V = map->V;
+	if (n_landmarks <= 0) {
+		n_landmarks = LANDMARK_DEFAULT_COUNT;
+	}
+	if (n_landmarks > V) {
+		n_landmarks = V;
+	}
+
+	free(map->landmark_dist);
+	map->landmark_dist = NULL;
+	map->n_landmarks = 0;
+	if (V == 0) {
+		return;
+	}
+	map->landmark_dist = malloc(sizeof(int) * (size_t)n_landmarks * V);
+	map->n_landmarks = n_landmarks;
+
+	// Distance from each vertex to the closest landmark picked so far (INT_MAX: unreachable, so picked first)
+	int* closest = malloc(sizeof(int) * V);
+	int* pred_v = malloc(sizeof(int) * V);
+
+	// First landmark: farthest from vertex 0
+	csr_shortest_path_tree(map, 0, closest, pred_v);
+	for (int i = 0; i < n_landmarks; i++) {
+		int landmark = 0;
+		for (int v = 1; v < V; v++) {
+			if (closest[v] > closest[landmark]) {
+				landmark = v;
+			}
+		}
+
+		int* dist = map->landmark_dist + (size_t)i * V;
+		csr_shortest_path_tree(map, landmark, dist, pred_v);
+		for (int v = 0; v < V; v++) {
+			if (i == 0 || dist[v] < closest[v]) {
+				closest[v] = dist[v];
+			}
+		}
+	}
+
+	free(closest);
+	free(pred_v);
+}
+
+/* Create the state of point-to-point searches on a map
+ * Parameters:
+ *		map			CSRGraph instance (must outlive the search)
+ * Return: RouteSearch
+ */
+RouteSearch create_route_search(CSRGraph* map) {
+	RouteSearch search;
+	search.map = map;
+	search.potential = malloc(sizeof(int) * map->V);
+	search.touched = malloc(sizeof(int) * map->V);
+	search.n_touched = 0;
+	search.n_settled = 0;
+	STATS_COUNT(STAT_ALLOCATIONS, 8);
+	for (int side = 0; side < 2; side++) {
+		search.dist[side] = malloc(sizeof(int) * map->V);
+		search.pred_v[side] = malloc(sizeof(int) * map->V);
+		search.settled[side] = malloc(sizeof(bool) * map->V);
+		search.queue[side] = create_pqueue(map->V, get_pq_kind());
+		for (int v = 0; v < map->V; v++) {
+			search.dist[side][v] = INT_MAX;
+			search.pred_v[side][v] = -1;
+			search.settled[side][v] = false;
+		}
+	}
+	for (int v = 0; v < map->V; v++) {
+		search.potential[v] = -1;
+	}
+	return search;
+}
+
+/* Destroy the state of point-to-point searches (free all memory)
+ * Parameters:
+ *		self		RouteSearch instance
+ * Return: void
+ */
+void destroy_route_search(RouteSearch* self) {
+	for (int side = 0; side < 2; side++) {
+		free(self->dist[side]);
+		free(self->pred_v[side]);
+		free(self->settled[side]);
+		destroy_pqueue(&self->queue[side]);
+	}
+	free(self->potential);
+	free(self->touched);
+}
+
+/* Reset the vertices reached by the last query */
+static void reset_search(RouteSearch* self) {
+	for (int i = 0; i < self->n_touched; i++) {
+		int v = self->touched[i];
+		for (int side = 0; side < 2; side++) {
+			self->dist[side][v] = INT_MAX;
+			self->pred_v[side][v] = -1;
+			self->settled[side][v] = false;
+		}
+		self->potential[v] = -1;
+	}
+	self->n_touched = 0;
+	self->n_settled = 0;
+	pq_clear(&self->queue[0]);
+	pq_clear(&self->queue[1]);
+}
+
+/* Set the distance of v on 1 side of the search, and queue it with a key */
+static void reach(RouteSearch* self, int side, int v, int distance, int pred, int key) {
+	if (self->dist[0][v] == INT_MAX && self->dist[1][v] == INT_MAX) {
+		self->touched[self->n_touched++] = v;
+	}
+	self->dist[side][v] = distance;
+	self->pred_v[side][v] = pred;
+
+	PQueue* queue = &self->queue[side];
+	if (pq_contains(queue, v)) {
+		pq_decrease_key(queue, v, key);
+	}
+	else {
+		pq_insert(queue, v, key);
+	}
+}
+
+/* Path of a single vertex (source = destination) */
+static EdgeList single_vertex_path(RouteSearch* self, int v, int* distance, Arena* arena) {
+	if (distance != NULL) {
+		*distance = 0;
+	}
+	return trace_path(self->pred_v[0], v, arena);
+}
+
+/* Bidirectional Dijkstra's algorithm
+ *		Searches from both cities at once (always expanding the closer frontier), and stops once the frontiers
+ *		are further apart than the shortest path found where they met
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			RouteSearch instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (can be NULL, INT_MAX if unreachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path, from source to destination (empty if unreachable)
+ */
+EdgeList bidirectional_search(RouteSearch* self, int source, int destination, int* distance, Arena* arena) {
+	CSRGraph* map = self->map;
+	reset_search(self);
+	if (source == destination) {
+		return single_vertex_path(self, source, distance, arena);
+	}
+
+	reach(self, 0, source, 0, -1, 0);
+	reach(self, 1, destination, 0, -1, 0);
+
+	// Shortest path found so far: forward search to meet_from, edge, backward search from meet_to
+	long long best = INT_MAX;
+	int meet_from = -1;
+	int meet_to = -1;
+	STATS_LOCAL(n_relaxed);
+
+	while (!pq_is_empty(&self->queue[0]) && !pq_is_empty(&self->queue[1])) {
+		int forward_key;
+		int backward_key;
+		pq_peek_min(&self->queue[0], &forward_key);
+		pq_peek_min(&self->queue[1], &backward_key);
+
+		// Any path through unvisited vertices is at least this long
+		if ((long long)forward_key + backward_key >= best) {
+			break;
+		}
+
+		// Expand the closer frontier
+		int side = forward_key <= backward_key ? 0 : 1;
+		int* dist = self->dist[side];
+		int* other_dist = self->dist[1 - side];
+		int u = pq_pop_min(&self->queue[side], NULL);
+		self->settled[side][u] = true;
+		self->n_settled++;
+
+		for (int e = map->offsets[u]; e < map->offsets[u + 1]; e++) {
+			int v = map->to_vertex[e];
+			if (v == u) {
+				continue;
+			}
+			STATS_INC(n_relaxed);
+			int alt = dist[u] + map->weight[e];
+			if (!self->settled[side][v] && alt < dist[v]) {
+				reach(self, side, v, alt, u, alt);
+			}
+
+			// Frontiers meet at edge uv
+			if (other_dist[v] != INT_MAX && (long long)alt + other_dist[v] < best) {
+				best = (long long)alt + other_dist[v];
+				meet_from = side == 0 ? u : v;
+				meet_to = side == 0 ? v : u;
+			}
+		}
+	}
+	STATS_COUNT(STAT_SEARCHES, 1);
+	STATS_COUNT(STAT_SETTLED, self->n_settled);
+	STATS_COUNT(STAT_RELAXED, n_relaxed);
+
+	if (distance != NULL) {
+		*distance = (int)best;
+	}
+	if (meet_from == -1) {
+		EdgeList empty = { NULL };
+		return empty;
+	}
+
+	// Source --> meet_from (forward predecessors), then meet_to --> destination (backward predecessors)
+	EdgeList path = trace_path(self->pred_v[0], meet_from, arena);
+	EdgeNodePtr tail = path.head;
+	while (tail->next != NULL) {
+		tail = tail->next;
+	}
+	for (int v = meet_to; v != -1; v = self->pred_v[1][v]) {
+		EdgeNodePtr node = arena != NULL ? arena_alloc(arena, sizeof * node) : malloc(sizeof * node);
+		node->edge.to_vertex = v;
+		node->edge.weight = 0;
+		node->next = NULL;
+		tail->next = node;
+		tail = node;
+	}
+	return path;
+}
+
+/* Lower bound on the distance from v to the destination (landmark triangle inequality) */
+static int lower_bound(RouteSearch* self, int v, int destination) {
+	if (self->potential[v] != -1) {
+		return self->potential[v];
+	}
+
+	CSRGraph* map = self->map;
+	int bound = 0;
+	for (int i = 0; i < map->n_landmarks; i++) {
+		int* dist = map->landmark_dist + (size_t)i * map->V;
+		if (dist[v] == INT_MAX || dist[destination] == INT_MAX) {
+			continue;
+		}
+		int difference = dist[v] > dist[destination] ? dist[v] - dist[destination] : dist[destination] - dist[v];
+		if (difference > bound) {
+			bound = difference;
+		}
+	}
+	self->potential[v] = bound;
+	return bound;
+}
+
+/* A* search with landmark lower bounds (ALT)
+ *		Lower bound from v to the destination t is max |d(L, t) - d(L, v)| over the landmarks L (triangle inequality),
+ *		so vertices leading away from t are visited late or never
+ *		Falls back to bidirectional_search() if the map has no landmarks
+ * Parameters:
+ *		self			RouteSearch instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (can be NULL, INT_MAX if unreachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path, from source to destination (empty if unreachable)
+ */
+EdgeList alt_search(RouteSearch* self, int source, int destination, int* distance, Arena* arena) {
+	CSRGraph* map = self->map;
+	if (map->landmark_dist == NULL) {
+		return bidirectional_search(self, source, destination, distance, arena);
+	}
+
+	reset_search(self);
+	int* dist = self->dist[0];
+	reach(self, 0, source, 0, -1, lower_bound(self, source, destination));
+
+	// The bound is consistent, so a vertex's distance is final once it is visited (as in Dijkstra's)
+	bool found = false;
+	STATS_LOCAL(n_relaxed);
+	while (!pq_is_empty(&self->queue[0])) {
+		int u = pq_pop_min(&self->queue[0], NULL);
+		if (u == destination) {
+			found = true;
+			break;
+		}
+		self->settled[0][u] = true;
+		self->n_settled++;
+
+		for (int e = map->offsets[u]; e < map->offsets[u + 1]; e++) {
+			int v = map->to_vertex[e];
+			int alt = dist[u] + map->weight[e];
+			STATS_INC(n_relaxed);
+			if (!self->settled[0][v] && alt < dist[v]) {
+				reach(self, 0, v, alt, u, alt + lower_bound(self, v, destination));
+			}
+		}
+	}
+	STATS_COUNT(STAT_SEARCHES, 1);
+	STATS_COUNT(STAT_SETTLED, self->n_settled);
+	STATS_COUNT(STAT_RELAXED, n_relaxed);
+
+	if (distance != NULL) {
+		*distance = found ? dist[destination] : INT_MAX;
+	}
+	if (!found) {
+		EdgeList empty = { NULL };
+		return empty;
+	}
+	return trace_path(self->pred_v[0], destination, arena);
+}
+
+/* Shortest path between 2 vertices, with the best search the map allows
+ *		alt_search() if landmarks have been built for the map, bidirectional_search() otherwise
+ * Parameters:
+ *		self			RouteSearch instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (can be NULL, INT_MAX if unreachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path, from source to destination (empty if unreachable)
+ */
+EdgeList route_search(RouteSearch* self, int source, int destination, int* distance, Arena* arena) {
+	if (self->map->landmark_dist != NULL) {
+		return alt_search(self, source, destination, distance, arena);
+	}
+	return bidirectional_search(self, source, destination, distance, arena);
+}
@@ -0,0 +1,98 @@
+#ifndef ROUTESEARCH_H
+#define ROUTESEARCH_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "pqueue.h"
+
+// Landmarks picked by build_landmarks() when asked for 0 (each costs 1 shortest path tree and V ints)
+#define LANDMARK_DEFAULT_COUNT 8
+
+/* Reusable state of point-to-point searches on 1 map
+ *		Index 0 is the forward search (from the source), 1 the backward search (from the destination)
+ *		potential[v] is the A* lower bound from v to the destination (-1 until needed)
+ *		Only vertices a query reached are listed in touched[] and reset by the next one, so a query never costs O(V)
+ *		n_settled counts the vertices visited by the last query
+ */
+typedef struct routeSearch {
+	CSRGraph* map;
+	int* dist[2];
+	int* pred_v[2];
+	bool* settled[2];
+	int* potential;
+	PQueue queue[2];
+	int* touched;
+	int n_touched;
+	int n_settled;
+} RouteSearch;
+
+
+/* Pick landmarks of a map and store their distances in it (map->landmark_dist), for alt_search()
+ *		Farthest-point selection: each landmark is the vertex farthest from those already picked
+ *		Called once per map, later weight changes drop them again (see csr_set_edge_weight())
+ * Parameters:
+ *		map				CSRGraph instance
+ *		n_landmarks		number of landmarks (0 for LANDMARK_DEFAULT_COUNT)
+ * Return: void
+ */
+void build_landmarks(CSRGraph* map, int n_landmarks);
+
+
+/* Create the state of point-to-point searches on a map
+ * Parameters:
+ *		map			CSRGraph instance (must outlive the search)
+ * Return: RouteSearch
+ */
+RouteSearch create_route_search(CSRGraph* map);
+
+
+/* Destroy the state of point-to-point searches (free all memory)
+ * Parameters:
+ *		self		RouteSearch instance
+ * Return: void
+ */
+void destroy_route_search(RouteSearch* self);
+
+
+/* Bidirectional Dijkstra's algorithm
+ *		Searches from both cities at once (always expanding the closer frontier), and stops once the frontiers
+ *		are further apart than the shortest path found where they met
+ *		Also change value of pre-created distance (passed by reference)
+ * Parameters:
+ *		self			RouteSearch instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (can be NULL, INT_MAX if unreachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path, from source to destination (empty if unreachable)
+ */
+EdgeList bidirectional_search(RouteSearch* self, int source, int destination, int* distance, Arena* arena);
+
+
+/* A* search with landmark lower bounds (ALT)
+ *		Lower bound from v to the destination t is max |d(L, t) - d(L, v)| over the landmarks L (triangle inequality),
+ *		so vertices leading away from t are visited late or never
+ *		Falls back to bidirectional_search() if the map has no landmarks
+ * Parameters:
+ *		self			RouteSearch instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (can be NULL, INT_MAX if unreachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path, from source to destination (empty if unreachable)
+ */
+EdgeList alt_search(RouteSearch* self, int source, int destination, int* distance, Arena* arena);
+
+
+/* Shortest path between 2 vertices, with the best search the map allows
+ *		alt_search() if landmarks have been built for the map, bidirectional_search() otherwise
+ * Parameters:
+ *		self			RouteSearch instance
+ *		source			source vertex
+ *		destination		destination vertex
+ *		distance		pointer to variable storing distance of the shortest path (can be NULL, INT_MAX if unreachable)
+ *		arena			Arena to allocate path nodes from (NULL to use malloc, free with destroy_path())
+ * Return: linked list of vertices in the path, from source to destination (empty if unreachable)
+ */
+EdgeList route_search(RouteSearch* self, int source, int destination, int* distance, Arena* arena);
+#endif
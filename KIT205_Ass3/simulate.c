@@ -0,0 +1,378 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include "graph.h"
+#include "routesearch.h"
+#include "longest_trail.h"
+#include "batch.h"
+#include "mapgen.h"
+#include "steiner_local.h"
+#include "stats.h"
+#include "simulate.h"
+
+/* A player in the current game */
+typedef struct player {
+	CSRGraph view;		// map as this player sees it: own routes weigh 0, routes claimed by others removed
+	Graph claimed;		// routes claimed, each stored once (from lower to higher city)
+	int* component;		// union-find parent of each city, over the claimed routes
+	int* tickets;		// tickets held (indices into the deck)
+	int n_tickets;
+	int trains;
+	int score;
+} Player;
+
+/* Buffers of 1 thread, reused by every game it plays */
+typedef struct gameScratch {
+	Player players[MAX_GAME_PLAYERS];
+	RouteSearch search;		// on the shared map, for ticket values
+	Arena* arena;			// path nodes, reset after each use
+	int* terminals;			// ticket cities of a player
+} GameScratch;
+
+/* The current game */
+typedef struct game {
+	CSRGraph* map;
+	Player* players;
+	int n_players;
+	TicketSet deck;
+	int* value;				// points of each ticket of the deck (length of its shortest path)
+	int next_ticket;		// top of the deck
+	GameScratch* scratch;
+	GameSpec* spec;
+} Game;
+
+/* Totals of 1 game */
+typedef struct gameResult {
+	int n_turns;
+	int n_claims;
+	int n_draws;
+	int tickets_dealt;
+	int tickets_completed;
+	int score[MAX_GAME_PLAYERS];
+} GameResult;
+
+
+/* Read a game description written as "games:players:tickets" (players and tickets can be left out)
+ * Parameters:
+ *		text		description
+ *		spec		pointer to GameSpec to fill in
+ * Return: true if the description is valid
+ */
+bool parse_game_spec(const char* text, GameSpec* spec) {
+	// Games, players and tickets per player (players and tickets can be left out)
+	long values[3] = { 0, 4, 3 };
+	const char* current = text;
+	for (int n = 0; n < 3; n++) {
+		char* end;
+		values[n] = strtol(current, &end, 10);
+		if (end == current) {
+			return false;
+		}
+		current = end;
+		if (*current != ':') {
+			break;
+		}
+		current++;
+	}
+
+	spec->n_games = (int)values[0];
+	spec->n_players = (int)values[1];
+	spec->n_tickets = (int)values[2];
+	spec->improve_plans = false;
+	spec->improve_ms = 0;
+	return *current == '\0' && values[0] >= 1 && values[0] <= 100000000 && values[1] >= 2
+		&& values[1] <= MAX_GAME_PLAYERS && values[2] >= 1 && values[2] <= 1000;
+}
+
+
+/* Create the buffers of 1 thread (views are copies of the map's routes, sharing its offsets) */
+static GameScratch create_game_scratch(CSRGraph* map, GameSpec* spec) {
+	GameScratch scratch;
+	int deck_size = spec->n_players * spec->n_tickets * 2;
+	for (int p = 0; p < spec->n_players; p++) {
+		Player* player = &scratch.players[p];
+		player->view = *map;
+		player->view.to_vertex = malloc(sizeof(int) * (map->E > 0 ? map->E : 1));
+		player->view.weight = malloc(sizeof(int) * (map->E > 0 ? map->E : 1));
+		player->view.mapping = NULL;
+		player->view.mapping_length = 0;
+		player->view.n_landmarks = 0;
+		player->view.landmark_dist = NULL;
+		player->component = malloc(sizeof(int) * map->V);
+		player->tickets = malloc(sizeof(int) * deck_size);
+	}
+	scratch.search = create_route_search(map);
+	scratch.arena = create_arena(sizeof(struct edgeNode) * 64);
+	scratch.terminals = malloc(sizeof(int) * deck_size * 2);
+	return scratch;
+}
+
+/* Destroy the buffers of 1 thread (offsets of the views belong to the map) */
+static void destroy_game_scratch(GameScratch* self, GameSpec* spec) {
+	for (int p = 0; p < spec->n_players; p++) {
+		free(self->players[p].view.to_vertex);
+		free(self->players[p].view.weight);
+		free(self->players[p].component);
+		free(self->players[p].tickets);
+	}
+	destroy_route_search(&self->search);
+	destroy_arena(self->arena);
+	free(self->terminals);
+}
+
+
+/* Representative of the component of city v (path halving) */
+static int find_component(int component[], int v) {
+	while (component[v] != v) {
+		component[v] = component[component[v]];
+		v = component[v];
+	}
+	return v;
+}
+
+/* Points for claiming a route of a given length */
+static int route_points(int weight) {
+	static const int points[] = { 0, 1, 2, 4, 7, 10, 15 };
+	return weight <= 6 ? points[weight > 0 ? weight : 0] : 15 + 3 * (weight - 6);
+}
+
+/* Check if both cities of a ticket are joined by the player's routes */
+static bool ticket_completed(Game* self, Player* player, int ticket) {
+	return find_component(player->component, self->deck.from_cities[ticket])
+		== find_component(player->component, self->deck.to_cities[ticket]);
+}
+
+/* Give the top ticket of the deck to a player */
+static void draw_ticket(Game* self, Player* player) {
+	int ticket = self->next_ticket++;
+	player->tickets[player->n_tickets++] = ticket;
+
+	// Value: length of the shortest path on the map before any route was claimed
+	int distance;
+	route_search(&self->scratch->search, self->deck.from_cities[ticket], self->deck.to_cities[ticket], &distance,
+		self->scratch->arena);
+	arena_reset(self->scratch->arena);
+	self->value[ticket] = distance != INT_MAX ? distance : 0;
+}
+
+/* Claim route vu for a player: it weighs 0 in its view, and is removed from the view of every other player */
+static void claim_route(Game* self, int seat, int v, int u, int weight) {
+	for (int p = 0; p < self->n_players; p++) {
+		if (p == seat) {
+			csr_set_edge_weight(&self->players[p].view, v, u, 0);
+		}
+		else {
+			csr_remove_edge(&self->players[p].view, v, u);
+		}
+	}
+
+	Player* player = &self->players[seat];
+	add_edge(&player->claimed, v < u ? v : u, v < u ? u : v, weight);
+	player->component[find_component(player->component, v)] = find_component(player->component, u);
+	player->trains -= weight;
+	player->score += route_points(weight);
+}
+
+/* Play 1 turn: claim the longest affordable route of the plan, or draw a ticket once all are fulfilled
+ * Return: 1 for a claim, 2 for a draw, 0 for a pass
+ */
+static int play_turn(Game* self, int seat) {
+	Player* player = &self->players[seat];
+	int* terminals = self->scratch->terminals;
+	bool completed = true;
+	for (int i = 0; i < player->n_tickets; i++) {
+		int ticket = player->tickets[i];
+		terminals[2 * i] = self->deck.from_cities[ticket];
+		terminals[2 * i + 1] = self->deck.to_cities[ticket];
+		completed = completed && ticket_completed(self, player, ticket);
+	}
+
+	if (!completed) {
+		// Plan on the player's view: routes it owns are free, routes of others do not exist
+		Graph plan = csr_steiner_tree(&player->view, terminals, player->n_tickets * 2);
+		if (self->spec->improve_plans) {
+			improve_steiner_tree(&player->view, &plan, terminals, player->n_tickets * 2, self->spec->improve_ms);
+		}
+		int best_v = -1;
+		int best_u = -1;
+		int best_weight = 0;
+		for (int v = 0; v < plan.V; v++) {
+			for (EdgeNodePtr current = plan.edges[v].head; current != NULL; current = current->next) {
+				int weight = current->edge.weight;
+				if (weight > best_weight && weight <= player->trains) {
+					best_v = v;
+					best_u = current->edge.to_vertex;
+					best_weight = weight;
+				}
+			}
+		}
+		destroy_graph(&plan);
+
+		if (best_v != -1) {
+			claim_route(self, seat, best_v, best_u, best_weight);
+			return 1;
+		}
+		return 0;
+	}
+
+	if (self->next_ticket < self->deck.n_tickets) {
+		draw_ticket(self, player);
+		return 2;
+	}
+	return 0;
+}
+
+/* Play 1 game from start to end with the buffers of the calling thread */
+static GameResult play_game(CSRGraph* map, GameSpec* spec, uint64_t seed, GameScratch* scratch) {
+	STATS_BEGIN("simulate_game");
+	GameResult result;
+	memset(&result, 0, sizeof(result));
+
+	Game game;
+	game.map = map;
+	game.players = scratch->players;
+	game.n_players = spec->n_players;
+	game.deck = generate_tickets(map->V, spec->n_players * spec->n_tickets * 2, seed);
+	game.value = malloc(sizeof(int) * game.deck.n_tickets);
+	game.next_ticket = 0;
+	game.scratch = scratch;
+	game.spec = spec;
+
+	// Fresh views of the map, and the first tickets of each player
+	for (int p = 0; p < game.n_players; p++) {
+		Player* player = &game.players[p];
+		memcpy(player->view.to_vertex, map->to_vertex, sizeof(int) * map->E);
+		memcpy(player->view.weight, map->weight, sizeof(int) * map->E);
+		player->claimed = create_empty_graph(map->V);
+		for (int v = 0; v < map->V; v++) {
+			player->component[v] = v;
+		}
+		player->n_tickets = 0;
+		player->trains = GAME_TRAINS;
+		player->score = 0;
+		for (int n = 0; n < spec->n_tickets; n++) {
+			draw_ticket(&game, player);
+		}
+	}
+
+	// Turns in seat order, until the final round is over or every player passed in turn
+	int passes = 0;
+	int final_turns = -1;
+	for (int seat = 0; passes < game.n_players && final_turns != 0; seat = (seat + 1) % game.n_players) {
+		int move = play_turn(&game, seat);
+		result.n_turns++;
+		result.n_claims += move == 1;
+		result.n_draws += move == 2;
+		passes = move == 0 ? passes + 1 : 0;
+
+		if (final_turns > 0) {
+			final_turns--;
+		}
+		else if (final_turns == -1 && game.players[seat].trains <= GAME_FINAL_TRAINS) {
+			final_turns = game.n_players;
+		}
+	}
+
+	// Scores: tickets, then the longest continuous route bonus
+	int lengths[MAX_GAME_PLAYERS];
+	int longest = 0;
+	for (int p = 0; p < game.n_players; p++) {
+		Player* player = &game.players[p];
+		for (int i = 0; i < player->n_tickets; i++) {
+			int ticket = player->tickets[i];
+			bool completed = ticket_completed(&game, player, ticket);
+			player->score += completed ? game.value[ticket] : -game.value[ticket];
+			result.tickets_completed += completed;
+		}
+		result.tickets_dealt += player->n_tickets;
+
+		longest_trail(&player->claimed, &lengths[p], scratch->arena);
+		arena_reset(scratch->arena);
+		if (lengths[p] > longest) {
+			longest = lengths[p];
+		}
+	}
+	for (int p = 0; p < game.n_players; p++) {
+		Player* player = &game.players[p];
+		if (longest > 0 && lengths[p] == longest) {
+			player->score += GAME_LONGEST_BONUS;
+		}
+		result.score[p] = player->score;
+		destroy_graph(&player->claimed);
+	}
+
+	/* Free memory */
+	destroy_ticket_set(&game.deck);
+	free(game.value);
+
+	STATS_END("simulate_game");
+	return result;
+}
+
+
+/* Play many games on a map at once (headless), every player following the same greedy strategy
+ *		Each turn a player plans the Steiner tree of its tickets (csr_steiner_tree()) on its own view of the map, in
+ *		which its routes weigh 0 and routes claimed by others are removed, and claims the longest route of the plan
+ *		it can pay for (the plan is first improved by local search if spec->improve_plans is set). Once its tickets
+ *		are all fulfilled it draws another ticket, and it passes if it can do neither
+ *		Scores: routes by length (1, 2, 4, 7, 10, 15 for 1-6 trains), tickets +/- their shortest path length,
+ *		GAME_LONGEST_BONUS for the longest continuous route. The game ends after the final round, or when every
+ *		player passes in turn
+ *		Games are handed out dynamically to the OpenMP threads, each reusing its own views and search buffers.
+ *		The map itself is only read, and each game is seeded on its own, so results do not depend on the threads
+ * Parameters:
+ *		map			CSRGraph instance
+ *		spec		GameSpec (players 2 .. MAX_GAME_PLAYERS)
+ *		seed		random seed (game g deals its tickets from seed + g)
+ * Return: SimulationResult
+ */
+SimulationResult simulate_games(CSRGraph* map, GameSpec* spec, uint64_t seed) {
+	SimulationResult total;
+	memset(&total, 0, sizeof(total));
+	total.n_games = spec->n_games;
+	total.n_players = spec->n_players;
+
+	GameResult* results = malloc(sizeof(GameResult) * spec->n_games);
+	double start = stats_now();
+
+	#pragma omp parallel
+	{
+		GameScratch scratch = create_game_scratch(map, spec);
+
+		// A game lasts until a player runs low on train tokens or all pass, so a thread takes the next one when it is done
+		#pragma omp for schedule(dynamic)
+		for (int g = 0; g < spec->n_games; g++) {
+			results[g] = play_game(map, spec, seed + (uint64_t)g, &scratch);
+		}
+
+		destroy_game_scratch(&scratch, spec);
+	}
+	total.elapsed_ms = stats_now() - start;
+
+	// Totals in game order
+	for (int g = 0; g < spec->n_games; g++) {
+		GameResult* result = &results[g];
+		total.n_turns += result->n_turns;
+		total.n_claims += result->n_claims;
+		total.n_draws += result->n_draws;
+		total.tickets_dealt += result->tickets_dealt;
+		total.tickets_completed += result->tickets_completed;
+
+		int best = INT_MIN;
+		for (int p = 0; p < spec->n_players; p++) {
+			total.total_score[p] += result->score[p];
+			if (result->score[p] > best) {
+				best = result->score[p];
+			}
+		}
+		for (int p = 0; p < spec->n_players; p++) {
+			total.wins[p] += result->score[p] == best;
+		}
+	}
+
+	free(results);
+	return total;
+}
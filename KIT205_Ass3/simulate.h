@@ -0,0 +1,75 @@
+#ifndef SIMULATE_H
+#define SIMULATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "graph.h"
+
+// Seats at 1 game
+#define MAX_GAME_PLAYERS 8
+
+// Train tokens of each player at the start of a game (as on the board game)
+#define GAME_TRAINS 45
+
+// A player with this many train tokens or fewer starts the final round (every player gets 1 more turn)
+#define GAME_FINAL_TRAINS 2
+
+// Points for the longest continuous route (each player tied for it gets them)
+#define GAME_LONGEST_BONUS 10
+
+/* Games to simulate, written as "games:players:tickets" (e.g. "1000:4:3")
+ *		n_tickets is the number of tickets dealt to each player, and the deck holds as many again per player
+ *		If improve_plans is set, every plan is improved by improve_steiner_tree() within improve_ms (0: no limit)
+ */
+typedef struct gameSpec {
+	int n_games;
+	int n_players;
+	int n_tickets;
+	bool improve_plans;
+	double improve_ms;
+} GameSpec;
+
+/* Totals over all simulated games
+ *		wins[p] counts the games seat p won (or tied for first), total_score[p] sums its final scores
+ */
+typedef struct simulationResult {
+	int n_games;
+	int n_players;
+	long long n_turns;
+	long long n_claims;
+	long long n_draws;
+	long long tickets_dealt;
+	long long tickets_completed;
+	int wins[MAX_GAME_PLAYERS];
+	long long total_score[MAX_GAME_PLAYERS];
+	double elapsed_ms;
+} SimulationResult;
+
+
+/* Read a game description written as "games:players:tickets" (players and tickets can be left out)
+ * Parameters:
+ *		text		description
+ *		spec		pointer to GameSpec to fill in
+ * Return: true if the description is valid
+ */
+bool parse_game_spec(const char* text, GameSpec* spec);
+
+
+/* Play many games on a map at once (headless), every player following the same greedy strategy
+ *		Each turn a player plans the Steiner tree of its tickets (csr_steiner_tree()) on its own view of the map, in
+ *		which its routes weigh 0 and routes claimed by others are removed, and claims the longest route of the plan
+ *		it can pay for (the plan is first improved by local search if spec->improve_plans is set). Once its tickets
+ *		are all fulfilled it draws another ticket, and it passes if it can do neither
+ *		Scores: routes by length (1, 2, 4, 7, 10, 15 for 1-6 trains), tickets +/- their shortest path length,
+ *		GAME_LONGEST_BONUS for the longest continuous route. The game ends after the final round, or when every
+ *		player passes in turn
+ *		Games are handed out dynamically to the OpenMP threads, each reusing its own views and search buffers.
+ *		The map itself is only read, and each game is seeded on its own, so results do not depend on the threads
+ * Parameters:
+ *		map			CSRGraph instance
+ *		spec		GameSpec (players 2 .. MAX_GAME_PLAYERS)
+ *		seed		random seed (game g deals its tickets from seed + g)
+ * Return: SimulationResult
+ */
+SimulationResult simulate_games(CSRGraph* map, GameSpec* spec, uint64_t seed);
+#endif
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "stats.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Solvers timed (distinct names passed to stats_record())
+#define STATS_MAX_TIMERS 64
+
+/* Calls of 1 solver */
+typedef struct statsTimer {
+	const char* name;
+	long long calls;
+	double total_ms;
+} StatsTimer;
+
+/* 1 call of a solver, for the trace */
+typedef struct statsEvent {
+	const char* name;
+	double start_ms;
+	double duration_ms;
+	int thread;
+} StatsEvent;
+
+static const char* counter_names[STAT_COUNTERS] = {
+	"searches", "vertices_settled", "edges_relaxed", "path_trees", "allocations"
+};
+static long long counters[STAT_COUNTERS];
+static StatsTimer timers[STATS_MAX_TIMERS];
+static int n_timers = 0;
+static bool tracing = false;
+static StatsEvent* events = NULL;
+static int n_events = 0;
+static int events_capacity = 0;
+
+
+/* Check if the instrumentation was compiled in (TTR_STATS defined)
+ * No parameters
+ * Return: true / false
+ */
+bool stats_enabled() {
+#ifdef TTR_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+/* Add to a counter (safe from any thread)
+ * Parameters:
+ *		counter		StatsCounter
+ *		n			amount to add
+ * Return: void
+ */
+void stats_count(StatsCounter counter, long long n) {
+	#pragma omp atomic
+	counters[counter] += n;
+}
+
+/* Current time, for stats_record() (or to time a whole run, as the benchmarks do)
+ * No parameters
+ * Return: time in ms (from an arbitrary start)
+ */
+double stats_now() {
+	struct timespec time;
+	timespec_get(&time, TIME_UTC);
+	return time.tv_sec * 1000.0 + time.tv_nsec / 1000000.0;
+}
+
+/* Record 1 call of a solver: its timer, and a trace event if tracing (safe from any thread)
+ * Parameters:
+ *		name		name of the solver (string literal, kept by pointer)
+ *		start		stats_now() when the call started
+ * Return: void
+ */
+void stats_record(const char* name, double start) {
+	double duration = stats_now() - start;
+	int thread = 0;
+#ifdef _OPENMP
+	thread = omp_get_thread_num();
+#endif
+
+	#pragma omp critical(stats)
+	{
+		int t = 0;
+		while (t < n_timers && strcmp(timers[t].name, name) != 0) {
+			t++;
+		}
+		if (t == n_timers && n_timers < STATS_MAX_TIMERS) {
+			timers[n_timers].name = name;
+			timers[n_timers].calls = 0;
+			timers[n_timers].total_ms = 0;
+			n_timers++;
+		}
+		if (t < n_timers) {
+			timers[t].calls++;
+			timers[t].total_ms += duration;
+		}
+
+		if (tracing) {
+			if (n_events == events_capacity) {
+				events_capacity = events_capacity > 0 ? events_capacity * 2 : 1024;
+				events = realloc(events, sizeof(StatsEvent) * events_capacity);
+			}
+			events[n_events].name = name;
+			events[n_events].start_ms = start;
+			events[n_events].duration_ms = duration;
+			events[n_events].thread = thread;
+			n_events++;
+		}
+	}
+}
+
+/* Start or stop keeping a trace event for every call recorded
+ * Parameters:
+ *		on			true to keep trace events
+ * Return: void
+ */
+void stats_trace(bool on) {
+	tracing = on;
+}
+
+/* Clear all counters, timers and trace events (free all memory)
+ * No parameters
+ * Return: void
+ */
+void stats_reset() {
+	for (int c = 0; c < STAT_COUNTERS; c++) {
+		counters[c] = 0;
+	}
+	n_timers = 0;
+	free(events);
+	events = NULL;
+	n_events = 0;
+	events_capacity = 0;
+}
+
+/* Print counters and timers as JSON
+ *		{"counters": {"searches": n, ...}, "timers": {"solver": {"calls": n, "total_ms": t}, ...}}
+ * Parameters:
+ *		output		FILE to print to
+ * Return: void
+ */
+void stats_print_json(FILE* output) {
+	fprintf(output, "{\"counters\": {");
+	for (int c = 0; c < STAT_COUNTERS; c++) {
+		fprintf(output, "%s\"%s\": %lld", c > 0 ? ", " : "", counter_names[c], counters[c]);
+	}
+	fprintf(output, "}, \"timers\": {");
+	for (int t = 0; t < n_timers; t++) {
+		fprintf(output, "%s\"%s\": {\"calls\": %lld, \"total_ms\": %.3f}", t > 0 ? ", " : "", timers[t].name,
+			timers[t].calls, timers[t].total_ms);
+	}
+	fprintf(output, "}}\n");
+}
+
+/* Write the trace events as a Chrome trace (open in chrome://tracing or Perfetto)
+ *		1 complete ("X") event per call, times in microseconds from the first call, tid = OpenMP thread
+ * Parameters:
+ *		path		file path
+ * Return: true if the file was written
+ */
+bool stats_write_trace(const char* path) {
+	FILE* file = NULL;
+#ifdef _MSC_VER
+	fopen_s(&file, path, "w");
+#else
+	file = fopen(path, "w");
+#endif
+	if (file == NULL) {
+		fprintf(stderr, "Cannot write trace file '%s'\n", path);
+		return false;
+	}
+
+	double origin = 0;
+	for (int i = 0; i < n_events; i++) {
+		if (i == 0 || events[i].start_ms < origin) {
+			origin = events[i].start_ms;
+		}
+	}
+
+	fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	for (int i = 0; i < n_events; i++) {
+		fprintf(file, "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}%s\n",
+			events[i].name, events[i].thread, (events[i].start_ms - origin) * 1000.0, events[i].duration_ms * 1000.0,
+			i < n_events - 1 ? "," : "");
+	}
+	fprintf(file, "]}\n");
+	fclose(file);
+	return true;
+}
@@ -0,0 +1,106 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/* Counters of the work done inside the solvers (summed over all threads)
+ *		STAT_SEARCHES		shortest path searches (Dijkstra's, two-way, A*, hierarchy queries)
+ *		STAT_SETTLED		vertices settled by those searches
+ *		STAT_RELAXED		edges relaxed (looked at from a settled vertex)
+ *		STAT_PATH_TREES		shortest path trees computed for a path cache
+ *		STAT_ALLOCATIONS	heap allocations: search arrays and queues, arena blocks, path nodes without an arena
+ */
+typedef enum statsCounter {
+	STAT_SEARCHES,
+	STAT_SETTLED,
+	STAT_RELAXED,
+	STAT_PATH_TREES,
+	STAT_ALLOCATIONS,
+	STAT_COUNTERS
+} StatsCounter;
+
+/* Instrumentation of the hot paths, only compiled in with TTR_STATS defined (otherwise every macro is empty)
+ *		STATS_LOCAL / STATS_INC		count in a local variable inside a loop (no shared writes)
+ *		STATS_COUNT					add to a counter once, e.g. the local count when the function returns
+ *		STATS_BEGIN / STATS_END		time a solver call (1 per function, STATS_END before every return)
+ */
+#ifdef TTR_STATS
+#define STATS_LOCAL(name) long long name = 0
+#define STATS_INC(name) (name)++
+#define STATS_COUNT(counter, n) stats_count(counter, n)
+#define STATS_BEGIN(name) double stats_start = stats_now()
+#define STATS_END(name) stats_record(name, stats_start)
+#else
+#define STATS_LOCAL(name)
+#define STATS_INC(name)
+#define STATS_COUNT(counter, n)
+#define STATS_BEGIN(name)
+#define STATS_END(name)
+#endif
+
+
+/* Check if the instrumentation was compiled in (TTR_STATS defined)
+ * No parameters
+ * Return: true / false
+ */
+bool stats_enabled();
+
+
+/* Add to a counter (safe from any thread)
+ * Parameters:
+ *		counter		StatsCounter
+ *		n			amount to add
+ * Return: void
+ */
+void stats_count(StatsCounter counter, long long n);
+
+
+/* Current time, for stats_record() (or to time a whole run, as the benchmarks do)
+ * No parameters
+ * Return: time in ms (from an arbitrary start)
+ */
+double stats_now();
+
+
+/* Record 1 call of a solver: its timer, and a trace event if tracing (safe from any thread)
+ * Parameters:
+ *		name		name of the solver (string literal, kept by pointer)
+ *		start		stats_now() when the call started
+ * Return: void
+ */
+void stats_record(const char* name, double start);
+
+
+/* Start or stop keeping a trace event for every call recorded
+ * Parameters:
+ *		on			true to keep trace events
+ * Return: void
+ */
+void stats_trace(bool on);
+
+
+/* Clear all counters, timers and trace events (free all memory)
+ * No parameters
+ * Return: void
+ */
+void stats_reset();
+
+
+/* Print counters and timers as JSON
+ *		{"counters": {"searches": n, ...}, "timers": {"solver": {"calls": n, "total_ms": t}, ...}}
+ * Parameters:
+ *		output		FILE to print to
+ * Return: void
+ */
+void stats_print_json(FILE* output);
+
+
+/* Write the trace events as a Chrome trace (open in chrome://tracing or Perfetto)
+ *		1 complete ("X") event per call, times in microseconds from the first call, tid = OpenMP thread
+ * Parameters:
+ *		path		file path
+ * Return: true if the file was written
+ */
+bool stats_write_trace(const char* path);
+#endif
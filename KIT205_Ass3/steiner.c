@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "graph.h"
+#include "pathcache.h"
+#include "steiner.h"
+#include "steiner_kmb.h"
+#include "steiner_multistart.h"
+
+// Steiner tree solver used by solve_steiner_tree()
+static SteinerKind steiner_kind = STEINER_AUTO;
+
+
+/* Set the Steiner tree solver used by solve_steiner_tree()
+ * Parameters:
+ *		kind		STEINER_AUTO, STEINER_GREEDY, STEINER_KMB or STEINER_MULTISTART
+ * Return: void
+ */
+void set_steiner_kind(SteinerKind kind) {
+	steiner_kind = kind;
+}
+
+/* Get the Steiner tree solver used by solve_steiner_tree()
+ * No parameters
+ * Return: SteinerKind
+ */
+SteinerKind get_steiner_kind() {
+	return steiner_kind;
+}
+
+/* Steiner tree with set of terminal vertices, using the selected solver
+ * Parameters:
+ *		cache			PathCache of the map
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ * Return: steiner tree (Graph)
+ */
+Graph solve_steiner_tree(PathCache* cache, int terminals[], int n_terminals) {
+	if (steiner_kind == STEINER_MULTISTART) {
+		return multistart_steiner_tree(cache, terminals, n_terminals, get_multistart_restarts());
+	}
+	bool kmb = steiner_kind == STEINER_KMB
+		|| (steiner_kind == STEINER_AUTO && cache->map->V >= KMB_DEFAULT_MIN_VERTICES);
+	return kmb ? kmb_steiner_tree(cache, terminals, n_terminals) : cached_steiner_tree(cache, terminals, n_terminals);
+}
@@ -0,0 +1,47 @@
+#ifndef STEINER_H
+#define STEINER_H
+
+#include "graph.h"
+#include "pathcache.h"
+
+// Maps with at least this many vertices use the KMB solver for Solution 2 (STEINER_AUTO)
+#define KMB_DEFAULT_MIN_VERTICES 1000
+
+/* Steiner tree solvers for Solution 2
+ *		STEINER_AUTO		greedy on small maps, KMB from KMB_DEFAULT_MIN_VERTICES vertices
+ *		STEINER_GREEDY		cached_steiner_tree() (connect the closest terminal, repeatedly)
+ *		STEINER_KMB			kmb_steiner_tree() (distance network 2-approximation)
+ *		STEINER_MULTISTART	multistart_steiner_tree() (greedy from every terminal in parallel, cheapest kept)
+ */
+typedef enum steinerKind {
+	STEINER_AUTO,
+	STEINER_GREEDY,
+	STEINER_KMB,
+	STEINER_MULTISTART
+} SteinerKind;
+
+
+/* Set the Steiner tree solver used by solve_steiner_tree()
+ * Parameters:
+ *		kind		STEINER_AUTO, STEINER_GREEDY, STEINER_KMB or STEINER_MULTISTART
+ * Return: void
+ */
+void set_steiner_kind(SteinerKind kind);
+
+
+/* Get the Steiner tree solver used by solve_steiner_tree()
+ * No parameters
+ * Return: SteinerKind
+ */
+SteinerKind get_steiner_kind();
+
+
+/* Steiner tree with set of terminal vertices, using the selected solver
+ * Parameters:
+ *		cache			PathCache of the map
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ * Return: steiner tree (Graph)
+ */
+Graph solve_steiner_tree(PathCache* cache, int terminals[], int n_terminals);
+#endif
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "graph.h"
+#include "pqueue.h"
+#include "steiner_exact.h"
+#include "stats.h"
+
+/* Back pointer of a table entry (1 int per entry)
+ *		NO_BACK			entry is a terminal of a single-terminal subset (or unreachable)
+ *		>= 0			entry was reached along an edge from this vertex (same subset)
+ *		<= -2			entry merges 2 subsets at the same vertex, split = -(back + 1)
+ */
+#define NO_BACK -1
+#define SPLIT_BACK(split) (-(split) - 1)
+
+
+/* Grow trees of 1 subset along edges (Dijkstra seeded with the merged costs)
+ * Parameters:
+ *		self		CSRGraph instance
+ *		cost[]		costs of the subset at each vertex (V entries)
+ *		back[]		back pointers of the subset at each vertex (V entries)
+ *		queue		empty PQueue with V items (left empty)
+ * Return: void
+ */
+static void grow_subset(CSRGraph* self, int cost[], int back[], PQueue* queue) {
+	for (int v = 0; v < self->V; v++) {
+		if (cost[v] != INT_MAX) {
+			pq_insert(queue, v, cost[v]);
+		}
+	}
+
+	while (!pq_is_empty(queue)) {
+		int min_index = pq_pop_min(queue, NULL);
+
+		for (int e = self->offsets[min_index]; e < self->offsets[min_index + 1]; e++) {
+			int considered_v = self->to_vertex[e];
+			if (cost[min_index] + self->weight[e] < cost[considered_v]) {
+				cost[considered_v] = cost[min_index] + self->weight[e];
+				back[considered_v] = min_index;
+
+				if (pq_contains(queue, considered_v)) {
+					pq_decrease_key(queue, considered_v, cost[considered_v]);
+				}
+				else {
+					pq_insert(queue, considered_v, cost[considered_v]);
+				}
+			}
+		}
+	}
+}
+
+
+/* Exact (minimum cost) Steiner tree with set of terminal vertices in a CSR graph
+ *		The last distinct terminal is the root, subsets are over the other k-1 terminals
+ * Parameters:
+ *		self			CSRGraph instance
+ *		terminals[]		array containing all terminal vertices (duplicates allowed)
+ *		n_terminals		number of terminals (at most MAX_EXACT_TERMINALS distinct)
+ * Return: steiner tree (Graph), empty graph if there are too many terminals
+ */
+Graph exact_steiner_tree(CSRGraph* self, int terminals[], int n_terminals) {
+	STATS_BEGIN("exact_steiner_tree");
+	int V = self->V;
+
+	// Initialise graph with all vertices (but no edges)
+	Graph steiner_t = create_empty_graph(V);
+
+	// Remove duplicate terminals
+	int* distinct = malloc(sizeof(int) * (n_terminals > 0 ? n_terminals : 1));
+	int k = 0;
+	for (int i = 0; i < n_terminals; i++) {
+		bool seen = false;
+		for (int j = 0; j < k; j++) {
+			if (distinct[j] == terminals[i]) {
+				seen = true;
+			}
+		}
+		if (!seen) {
+			distinct[k++] = terminals[i];
+		}
+	}
+
+	if (k > MAX_EXACT_TERMINALS) {
+		fprintf(stderr, "Exact Steiner tree supports at most %d terminals (%d given)\n", MAX_EXACT_TERMINALS, k);
+		free(distinct);
+		STATS_END("exact_steiner_tree");
+		return steiner_t;
+	}
+
+	if (k <= 1) {
+		free(distinct);
+		STATS_END("exact_steiner_tree");
+		return steiner_t;
+	}
+
+	int root = distinct[k - 1];
+	int n_sets = 1 << (k - 1);
+	int full = n_sets - 1;
+
+	// Tables of all subsets, subset S at index [S * V .. S * V + V - 1] (row 0 unused)
+	size_t n_entries = (size_t)n_sets * V;
+	if (n_entries > MAX_EXACT_TABLE_ENTRIES) {
+		fprintf(stderr, "Exact Steiner tree: %d terminals on %d cities need %zu table entries (at most %zu)\n",
+			k, V, n_entries, MAX_EXACT_TABLE_ENTRIES);
+		free(distinct);
+		STATS_END("exact_steiner_tree");
+		return steiner_t;
+	}
+	int* cost = malloc(sizeof(int) * n_entries);
+	int* back = malloc(sizeof(int) * n_entries);
+	if (cost == NULL || back == NULL) {
+		fprintf(stderr, "Exact Steiner tree: out of memory (%zu table entries)\n", n_entries);
+		free(cost);
+		free(back);
+		free(distinct);
+		STATS_END("exact_steiner_tree");
+		return steiner_t;
+	}
+
+	PQueue queue = create_pqueue(V, get_pq_kind());
+
+	// Subsets in increasing order, so every proper subset of S is done before S
+	for (int S = 1; S < n_sets; S++) {
+		int* cost_S = cost + (size_t)S * V;
+		int* back_S = back + (size_t)S * V;
+
+		if ((S & (S - 1)) == 0) {
+			// Single terminal: tree is just the terminal itself
+			int t = 0;
+			while ((1 << t) != S) {
+				t++;
+			}
+			for (int v = 0; v < V; v++) {
+				cost_S[v] = INT_MAX;
+				back_S[v] = NO_BACK;
+			}
+			cost_S[distinct[t]] = 0;
+		}
+		else {
+			// Merge step: best split of S into 2 subsets meeting at v
+			//		Only splits containing the lowest terminal of S, so each split is tried once
+			int lowest = S & -S;
+
+			#pragma omp parallel for schedule(static)
+			for (int v = 0; v < V; v++) {
+				int best = INT_MAX;
+				int best_split = 0;
+				for (int A = (S - 1) & S; A > 0; A = (A - 1) & S) {
+					if ((A & lowest) == 0) {
+						continue;
+					}
+					int cost_A = cost[(size_t)A * V + v];
+					int cost_B = cost[(size_t)(S ^ A) * V + v];
+					if (cost_A != INT_MAX && cost_B != INT_MAX && cost_A + cost_B < best) {
+						best = cost_A + cost_B;
+						best_split = A;
+					}
+				}
+				cost_S[v] = best;
+				back_S[v] = best_split == 0 ? NO_BACK : SPLIT_BACK(best_split);
+			}
+		}
+
+		// Grow step: extend trees of S along edges
+		grow_subset(self, cost_S, back_S, &queue);
+	}
+
+	if (cost[(size_t)full * V + root] == INT_MAX) {
+		fprintf(stderr, "Exact Steiner tree: terminals are not connected\n");
+	}
+	else {
+		// Rebuild tree from back pointers (stack of (subset, vertex), pending subsets are disjoint)
+		int* stack_S = malloc(sizeof(int) * k);
+		int* stack_v = malloc(sizeof(int) * k);
+		int top = 0;
+		stack_S[top] = full;
+		stack_v[top] = root;
+		top++;
+
+		while (top > 0) {
+			top--;
+			int S = stack_S[top];
+			int v = stack_v[top];
+
+			// Follow edges until reaching a terminal or a merge
+			int b = back[(size_t)S * V + v];
+			while (b >= 0) {
+				int start_v = b < v ? b : v;
+				int end_v = b < v ? v : b;
+				if (!edge_exists(&steiner_t, start_v, end_v)) {
+					add_edge(&steiner_t, start_v, end_v, csr_edge_weight(self, start_v, end_v));
+				}
+				v = b;
+				b = back[(size_t)S * V + v];
+			}
+
+			if (b != NO_BACK) {
+				int A = -(b + 1);
+				stack_S[top] = A;
+				stack_v[top] = v;
+				top++;
+				stack_S[top] = S ^ A;
+				stack_v[top] = v;
+				top++;
+			}
+		}
+
+		free(stack_S);
+		free(stack_v);
+	}
+
+	/* Free memory for dynamic arrays */
+	free(distinct);
+	free(cost);
+	free(back);
+	destroy_pqueue(&queue);
+
+	STATS_END("exact_steiner_tree");
+	return steiner_t;
+}
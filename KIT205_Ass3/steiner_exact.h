@@ -0,0 +1,28 @@
+#ifndef STEINER_EXACT_H
+#define STEINER_EXACT_H
+
+#include "graph.h"
+
+// Largest number of distinct terminals the exact solver accepts (tables grow as 2^(k-1) * V)
+#define MAX_EXACT_TERMINALS 16
+
+// Largest table the exact solver allocates, in entries (2 tables of 4 bytes per entry, so 512 MB in all)
+#define MAX_EXACT_TABLE_ENTRIES ((size_t)1 << 26)
+
+
+/* Exact (minimum cost) Steiner tree with set of terminal vertices in a CSR graph
+ *		Dreyfus-Wagner subset dynamic programming (Erickson-Monma-Veinott form):
+ *		cost[S][v] = cheapest tree connecting terminal subset S and vertex v, built from
+ *		smaller subsets (merge step, parallel over v) then grown along edges (Dijkstra step)
+ *		Subsets are bitmasks over the terminals, tables are indexed [S * V + v]
+ *		The tables are not bit-packed: a cost needs a full int, and the back pointer already packs the edge predecessor
+ *		and the merge split into 1 int. Instead the solver refuses (with a message) any map and terminal count whose
+ *		tables would exceed MAX_EXACT_TABLE_ENTRIES
+ * Parameters:
+ *		self			CSRGraph instance
+ *		terminals[]		array containing all terminal vertices (duplicates allowed)
+ *		n_terminals		number of terminals (at most MAX_EXACT_TERMINALS distinct)
+ * Return: steiner tree (Graph), empty graph if there are too many terminals or the tables do not fit
+ */
+Graph exact_steiner_tree(CSRGraph* self, int terminals[], int n_terminals);
+#endif
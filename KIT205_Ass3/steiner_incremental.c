@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "graph.h"
+#include "pqueue.h"
+#include "steiner_incremental.h"
+#include "stats.h"
+
+
+/* Add vertices to the tree and update distances to it
+ *		Dijkstra's algorithm from the new vertices only, which stops at vertices that were already as close to the tree
+ * Parameters:
+ *		self			SteinerState instance
+ *		vertices[]		vertices joining the tree
+ *		n				number of vertices
+ * Return: void
+ */
+static void grow_tree(SteinerState* self, int vertices[], int n) {
+	CSRGraph* map = self->map;
+	for (int i = 0; i < n; i++) {
+		int v = vertices[i];
+		if (!self->in_tree[v]) {
+			self->in_tree[v] = true;
+			self->n_vertices++;
+		}
+		self->tree_dist[v] = 0;
+		self->tree_pred[v] = -1;
+		if (pq_contains(&self->queue, v)) {
+			pq_decrease_key(&self->queue, v, 0);
+		}
+		else {
+			pq_insert(&self->queue, v, 0);
+		}
+	}
+
+	STATS_LOCAL(n_settled);
+	STATS_LOCAL(n_relaxed);
+	while (!pq_is_empty(&self->queue)) {
+		int u = pq_pop_min(&self->queue, NULL);
+		STATS_INC(n_settled);
+		for (int e = map->offsets[u]; e < map->offsets[u + 1]; e++) {
+			int v = map->to_vertex[e];
+			int alt = self->tree_dist[u] + map->weight[e];
+			STATS_INC(n_relaxed);
+			if (alt < self->tree_dist[v]) {
+				self->tree_dist[v] = alt;
+				self->tree_pred[v] = u;
+				if (pq_contains(&self->queue, v)) {
+					pq_decrease_key(&self->queue, v, alt);
+				}
+				else {
+					pq_insert(&self->queue, v, alt);
+				}
+			}
+		}
+	}
+	STATS_COUNT(STAT_SEARCHES, 1);
+	STATS_COUNT(STAT_SETTLED, n_settled);
+	STATS_COUNT(STAT_RELAXED, n_relaxed);
+}
+
+/* Create a Steiner state from an existing tree (one full multi-source search, later additions are incremental)
+ * Parameters:
+ *		map				CSRGraph instance (must outlive the state)
+ *		tree			Steiner tree to start from, edges stored from lower to higher vertex (copied, NULL for none)
+ *		terminals[]		terminal vertices already connected by the tree (needed if it has no edges yet)
+ *		n_terminals		number of terminals
+ * Return: SteinerState
+ */
+SteinerState create_steiner_state(CSRGraph* map, Graph* tree, int terminals[], int n_terminals) {
+	int V = map->V;
+	SteinerState state;
+	state.map = map;
+	state.tree = create_empty_graph(V);
+	state.cost = 0;
+	state.n_vertices = 0;
+	state.in_tree = malloc(sizeof(bool) * V);
+	state.tree_dist = malloc(sizeof(int) * V);
+	state.tree_pred = malloc(sizeof(int) * V);
+	state.queue = create_pqueue(V, get_pq_kind());
+	state.scratch = create_arena(sizeof(struct edgeNode) * 64);
+
+	for (int v = 0; v < V; v++) {
+		state.in_tree[v] = false;
+		state.tree_dist[v] = INT_MAX;
+		state.tree_pred[v] = -1;
+	}
+
+	// Vertices of the starting tree and terminals (all at distance 0)
+	int* vertices = malloc(sizeof(int) * (V > 0 ? V : 1));
+	int n = 0;
+	bool* listed = calloc(V > 0 ? V : 1, sizeof(bool));
+	if (tree != NULL) {
+		for (int v = 0; v < tree->V; v++) {
+			for (EdgeNodePtr current = tree->edges[v].head; current != NULL; current = current->next) {
+				int u = current->edge.to_vertex;
+				int start_v = v < u ? v : u;
+				int end_v = v < u ? u : v;
+				if (!edge_exists(&state.tree, start_v, end_v)) {
+					add_edge(&state.tree, start_v, end_v, current->edge.weight);
+					state.cost += current->edge.weight;
+				}
+				if (!listed[v]) {
+					listed[v] = true;
+					vertices[n++] = v;
+				}
+				if (!listed[u]) {
+					listed[u] = true;
+					vertices[n++] = u;
+				}
+			}
+		}
+	}
+	for (int i = 0; i < n_terminals; i++) {
+		if (!listed[terminals[i]]) {
+			listed[terminals[i]] = true;
+			vertices[n++] = terminals[i];
+		}
+	}
+	grow_tree(&state, vertices, n);
+
+	free(vertices);
+	free(listed);
+	return state;
+}
+
+/* Destroy a Steiner state (free all memory)
+ * Parameters:
+ *		self		SteinerState instance
+ * Return: void
+ */
+void destroy_steiner_state(SteinerState* self) {
+	destroy_graph(&self->tree);
+	free(self->in_tree);
+	free(self->tree_dist);
+	free(self->tree_pred);
+	destroy_pqueue(&self->queue);
+	destroy_arena(self->scratch);
+}
+
+
+/* Connect a terminal to the tree at its cheapest point (along its shortest path to the tree)
+ *		Work is proportional to the vertices that get closer to the tree, not to the whole hand
+ * Parameters:
+ *		self		SteinerState instance
+ *		terminal	terminal vertex
+ * Return: false if the terminal cannot reach the tree
+ */
+bool steiner_add_terminal(SteinerState* self, int terminal) {
+	if (self->in_tree[terminal]) {
+		return true;
+	}
+
+	// First vertex of the tree
+	if (self->n_vertices == 0) {
+		grow_tree(self, &terminal, 1);
+		return true;
+	}
+
+	if (self->tree_dist[terminal] == INT_MAX) {
+		return false;
+	}
+
+	// Path from the closest tree vertex to the terminal
+	self->cost += self->tree_dist[terminal];
+	EdgeList path = trace_path(self->tree_pred, terminal, self->scratch);
+	add_path_edges(&self->tree, self->map, path);
+
+	// Its vertices join the tree (the first one is already in it)
+	int n = 0;
+	for (EdgeNodePtr current = path.head; current != NULL; current = current->next) {
+		n++;
+	}
+	int* vertices = arena_alloc(self->scratch, sizeof(int) * n);
+	n = 0;
+	for (EdgeNodePtr current = path.head->next; current != NULL; current = current->next) {
+		vertices[n++] = current->edge.to_vertex;
+	}
+	grow_tree(self, vertices, n);
+
+	arena_reset(self->scratch);
+	return true;
+}
+
+/* Connect both cities of a newly drawn ticket to the tree
+ * Parameters:
+ *		self		SteinerState instance
+ *		from_city	first city of the ticket
+ *		to_city		second city of the ticket
+ * Return: false if a city cannot reach the tree
+ */
+bool steiner_add_ticket(SteinerState* self, int from_city, int to_city) {
+	bool from_connected = steiner_add_terminal(self, from_city);
+	bool to_connected = steiner_add_terminal(self, to_city);
+	return from_connected && to_connected;
+}
+
+/* Update the state after the weight of route uv changed in the map (e.g. claimed by another player)
+ *		The map must already have the new weight (see csr_set_edge_weight() / csr_remove_edge())
+ *		A reweighted tree route stays in the tree (cost changes), distances to the tree are repaired
+ * Parameters:
+ *		self			SteinerState instance
+ *		v				first city of the route
+ *		u				second city of the route
+ *		old_weight		weight before the change
+ *		new_weight		weight after the change (INT_MAX if the route was removed)
+ * Return: false if a removed route was part of the tree (the tree is broken, rebuild the state)
+ */
+bool steiner_route_changed(SteinerState* self, int v, int u, int old_weight, int new_weight) {
+	// Tree route (stored from lower to higher vertex)
+	int start_v = v < u ? v : u;
+	int end_v = v < u ? u : v;
+	for (EdgeNodePtr current = self->tree.edges[start_v].head; current != NULL; current = current->next) {
+		if (current->edge.to_vertex == end_v) {
+			if (new_weight == INT_MAX) {
+				return false;
+			}
+			self->cost += new_weight - current->edge.weight;
+			current->edge.weight = new_weight;
+			break;
+		}
+	}
+
+	// Distances to the tree (tree vertices are sources, so they keep distance 0)
+	int* stack = arena_alloc(self->scratch, sizeof(int) * self->map->V);
+	csr_repair_shortest_path_tree(self->map, self->tree_dist, self->tree_pred, v, u, old_weight, new_weight,
+		&self->queue, stack);
+	arena_reset(self->scratch);
+	return true;
+}
@@ -0,0 +1,79 @@
+#ifndef STEINER_INCREMENTAL_H
+#define STEINER_INCREMENTAL_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "pqueue.h"
+
+/* A Steiner tree that grows as tickets are drawn, with the distance of every vertex to it
+ *		n_vertices		number of vertices in the tree (in_tree[v] true)
+ *		tree_dist[v]	shortest distance from v to the nearest tree vertex (0 in the tree, INT_MAX if unreachable)
+ *		tree_pred[v]	next vertex on that shortest path, towards the tree (-1 in the tree)
+ *		Adding a terminal joins it along that path, then updates tree_dist only where the new tree vertices are closer
+ *		A route changing in the map repairs tree_dist only where it changes (see steiner_route_changed())
+ */
+typedef struct steinerState {
+	CSRGraph* map;
+	Graph tree;
+	int cost;
+	int n_vertices;
+	bool* in_tree;
+	int* tree_dist;
+	int* tree_pred;
+	PQueue queue;
+	Arena* scratch;
+} SteinerState;
+
+
+/* Create a Steiner state from an existing tree (one full multi-source search, later additions are incremental)
+ * Parameters:
+ *		map				CSRGraph instance (must outlive the state)
+ *		tree			Steiner tree to start from, edges stored from lower to higher vertex (copied, NULL for none)
+ *		terminals[]		terminal vertices already connected by the tree (needed if it has no edges yet)
+ *		n_terminals		number of terminals
+ * Return: SteinerState
+ */
+SteinerState create_steiner_state(CSRGraph* map, Graph* tree, int terminals[], int n_terminals);
+
+
+/* Destroy a Steiner state (free all memory)
+ * Parameters:
+ *		self		SteinerState instance
+ * Return: void
+ */
+void destroy_steiner_state(SteinerState* self);
+
+
+/* Connect a terminal to the tree at its cheapest point (along its shortest path to the tree)
+ *		Work is proportional to the vertices that get closer to the tree, not to the whole hand
+ * Parameters:
+ *		self		SteinerState instance
+ *		terminal	terminal vertex
+ * Return: false if the terminal cannot reach the tree
+ */
+bool steiner_add_terminal(SteinerState* self, int terminal);
+
+
+/* Connect both cities of a newly drawn ticket to the tree
+ * Parameters:
+ *		self		SteinerState instance
+ *		from_city	first city of the ticket
+ *		to_city		second city of the ticket
+ * Return: false if a city cannot reach the tree
+ */
+bool steiner_add_ticket(SteinerState* self, int from_city, int to_city);
+
+
+/* Update the state after the weight of route uv changed in the map (e.g. claimed by another player)
+ *		The map must already have the new weight (see csr_set_edge_weight() / csr_remove_edge())
+ *		A reweighted tree route stays in the tree (cost changes), distances to the tree are repaired
+ * Parameters:
+ *		self			SteinerState instance
+ *		v				first city of the route
+ *		u				second city of the route
+ *		old_weight		weight before the change
+ *		new_weight		weight after the change (INT_MAX if the route was removed)
+ * Return: false if a removed route was part of the tree (the tree is broken, rebuild the state)
+ */
+bool steiner_route_changed(SteinerState* self, int v, int u, int old_weight, int new_weight);
+#endif
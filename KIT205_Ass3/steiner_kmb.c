@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "graph.h"
+#include "pathcache.h"
+#include "steiner_kmb.h"
+#include "stats.h"
+
+/* Create a CSR graph from the edges of an MST-shaped Graph (each vertex v has edges to its parent), both directions */
+static CSRGraph tree_to_csr(Graph* tree) {
+	Graph both = create_empty_graph(tree->V);
+	for (int v = 0; v < tree->V; v++) {
+		for (EdgeNodePtr current = tree->edges[v].head; current != NULL; current = current->next) {
+			add_edge(&both, v, current->edge.to_vertex, current->edge.weight);
+			add_edge(&both, current->edge.to_vertex, v, current->edge.weight);
+		}
+	}
+	CSRGraph csr = create_csr_graph(&both);
+	destroy_graph(&both);
+	return csr;
+}
+
+/* Steiner tree with set of terminal vertices, Kou-Markowsky-Berman distance network heuristic
+ *		1. Distance network: complete graph on the terminals, weighted by shortest distances (cached trees or hierarchy)
+ *		2. MST of the distance network (Prim's)
+ *		3. Expand each MST edge to its shortest path in the map
+ *		4. MST of the expanded subgraph, then remove non-terminal leaves until none are left
+ *		Cost is at most 2 * (1 - 1/l) times the minimum, for l leaves of the minimum tree
+ * Parameters:
+ *		cache			PathCache of the map
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ * Return: steiner tree (Graph)
+ */
+Graph kmb_steiner_tree(PathCache* cache, int terminals[], int n_terminals) {
+	STATS_BEGIN("kmb_steiner_tree");
+	int V = cache->map->V;
+	Graph steiner_t = create_empty_graph(V);
+
+	// Terminals without duplicates
+	bool* isTerm = calloc(V, sizeof(bool));
+	int* distinct = malloc(sizeof(int) * (n_terminals > 0 ? n_terminals : 1));
+	int k = 0;
+	for (int i = 0; i < n_terminals; i++) {
+		if (!isTerm[terminals[i]]) {
+			isTerm[terminals[i]] = true;
+			distinct[k++] = terminals[i];
+		}
+	}
+	if (k < 2) {
+		free(isTerm);
+		free(distinct);
+		STATS_END("kmb_steiner_tree");
+		return steiner_t;
+	}
+
+	// 1. Distance network (1 shortest path tree per terminal, or 1 hierarchy query per pair of terminals)
+	if (cache->hierarchy == NULL) {
+		warm_path_cache(cache, distinct, k);
+	}
+	int* pair_dist = malloc(sizeof(int) * k * k);
+	for (int i = 0; i < k; i++) {
+		for (int j = i + 1; j < k; j++) {
+			pair_dist[i * k + j] = cached_distance(cache, distinct[i], distinct[j]);
+			pair_dist[j * k + i] = pair_dist[i * k + j];
+		}
+	}
+	CSRGraph network;
+	network.V = k;
+	network.E = 0;
+	network.offsets = malloc(sizeof(int) * (k + 1));
+	network.to_vertex = malloc(sizeof(int) * k * (k - 1));
+	network.weight = malloc(sizeof(int) * k * (k - 1));
+	network.mapping = NULL;
+	network.mapping_length = 0;
+	network.n_landmarks = 0;
+	network.landmark_dist = NULL;
+	for (int i = 0; i < k; i++) {
+		network.offsets[i] = network.E;
+		for (int j = 0; j < k; j++) {
+			if (j != i && pair_dist[i * k + j] != INT_MAX) {
+				network.to_vertex[network.E] = j;
+				network.weight[network.E++] = pair_dist[i * k + j];
+			}
+		}
+	}
+	network.offsets[k] = network.E;
+	free(pair_dist);
+
+	// 2. MST of the distance network
+	Graph network_mst = csr_prims_mst(&network);
+
+	// 3. Expand MST edges to shortest paths (each edge of the map added once)
+	Graph expanded = create_empty_graph(V);
+	Arena* scratch = create_arena(sizeof(struct edgeNode) * 64);
+	for (int i = 0; i < k; i++) {
+		for (EdgeNodePtr current = network_mst.edges[i].head; current != NULL; current = current->next) {
+			EdgeList path = cached_path(cache, distinct[i], distinct[current->edge.to_vertex], NULL, scratch);
+			add_path_edges(&expanded, cache->map, path);
+			arena_reset(scratch);
+		}
+	}
+
+	// 4. MST of the expanded subgraph, renumbered to its own vertices (1 pass over the V rows of expanded)
+	//		so the MST, its CSR copy and the leaf removal below only work on the vertices of the paths
+	int* local = malloc(sizeof(int) * V);
+	int* global = malloc(sizeof(int) * V);
+	int n_local = 0;
+	for (int v = 0; v < V; v++) {
+		local[v] = -1;
+	}
+	for (int v = 0; v < V; v++) {
+		for (EdgeNodePtr current = expanded.edges[v].head; current != NULL; current = current->next) {
+			int ends[2] = { v, current->edge.to_vertex };
+			for (int n = 0; n < 2; n++) {
+				if (local[ends[n]] == -1) {
+					local[ends[n]] = n_local;
+					global[n_local++] = ends[n];
+				}
+			}
+		}
+	}
+
+	Graph subgraph = create_empty_graph(n_local);
+	for (int v = 0; v < V; v++) {
+		for (EdgeNodePtr current = expanded.edges[v].head; current != NULL; current = current->next) {
+			add_edge(&subgraph, local[v], local[current->edge.to_vertex], current->edge.weight);
+			add_edge(&subgraph, local[current->edge.to_vertex], local[v], current->edge.weight);
+		}
+	}
+	CSRGraph subgraph_csr = create_csr_graph(&subgraph);
+	Graph subgraph_mst = csr_prims_mst(&subgraph_csr);
+
+	// Remove non-terminal leaves, repeatedly (a removed leaf can make its neighbour a leaf)
+	CSRGraph tree = tree_to_csr(&subgraph_mst);
+	int* degree = malloc(sizeof(int) * (n_local > 0 ? n_local : 1));
+	bool* removed = calloc(n_local > 0 ? n_local : 1, sizeof(bool));
+	int* leaves = malloc(sizeof(int) * (n_local > 0 ? n_local : 1));
+	int n_leaves = 0;
+	for (int v = 0; v < n_local; v++) {
+		degree[v] = tree.offsets[v + 1] - tree.offsets[v];
+		if (degree[v] <= 1 && !isTerm[global[v]]) {
+			leaves[n_leaves++] = v;
+		}
+	}
+	while (n_leaves > 0) {
+		int leaf = leaves[--n_leaves];
+		removed[leaf] = true;
+		for (int e = tree.offsets[leaf]; e < tree.offsets[leaf + 1]; e++) {
+			int u = tree.to_vertex[e];
+			if (!removed[u] && --degree[u] == 1 && !isTerm[global[u]]) {
+				leaves[n_leaves++] = u;
+			}
+		}
+	}
+
+	// Remaining tree edges, back in map vertices (each edge stored once, from lower to higher vertex)
+	for (int v = 0; v < n_local; v++) {
+		if (removed[v]) {
+			continue;
+		}
+		for (EdgeNodePtr current = subgraph_mst.edges[v].head; current != NULL; current = current->next) {
+			int u = current->edge.to_vertex;
+			if (!removed[u]) {
+				int start_v = global[v] < global[u] ? global[v] : global[u];
+				int end_v = global[v] < global[u] ? global[u] : global[v];
+				add_edge(&steiner_t, start_v, end_v, current->edge.weight);
+			}
+		}
+	}
+
+	/* Free memory */
+	free(isTerm);
+	free(distinct);
+	destroy_csr_graph(&network);
+	destroy_graph(&network_mst);
+	destroy_graph(&expanded);
+	destroy_arena(scratch);
+	free(local);
+	free(global);
+	destroy_graph(&subgraph);
+	destroy_csr_graph(&subgraph_csr);
+	destroy_graph(&subgraph_mst);
+	destroy_csr_graph(&tree);
+	free(degree);
+	free(removed);
+	free(leaves);
+
+	STATS_END("kmb_steiner_tree");
+	return steiner_t;
+}
@@ -0,0 +1,20 @@
+#ifndef STEINER_KMB_H
+#define STEINER_KMB_H
+
+#include "graph.h"
+#include "pathcache.h"
+
+/* Steiner tree with set of terminal vertices, Kou-Markowsky-Berman distance network heuristic
+ *		1. Distance network: complete graph on the terminals, weighted by shortest distances (cached trees or hierarchy)
+ *		2. MST of the distance network (Prim's)
+ *		3. Expand each MST edge to its shortest path in the map
+ *		4. MST of the expanded subgraph, then remove non-terminal leaves until none are left
+ *		Cost is at most 2 * (1 - 1/l) times the minimum, for l leaves of the minimum tree
+ * Parameters:
+ *		cache			PathCache of the map
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ * Return: steiner tree (Graph)
+ */
+Graph kmb_steiner_tree(PathCache* cache, int terminals[], int n_terminals);
+#endif
@@ -0,0 +1,662 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "graph.h"
+#include "pqueue.h"
+#include "workspace.h"
+#include "steiner_local.h"
+#include "stats.h"
+
+// Labels of the cities of the map during a move (labels from 3 up: other parts of the tree, where searches stop)
+#define LABEL_FREE 0		// not in the tree, or taken out by the move: searches pass through it
+#define LABEL_TREE 1		// in the tree but not part of the move: searches do not enter it
+#define LABEL_SOURCE 2		// part of the tree the searches start from
+#define LABEL_PART 3		// first of the other parts
+
+
+/* Tree being improved
+ *		Edges (edge_u < edge_v) are kept in arrays. A move cuts edges and appends new ones, and rebuild_tree() drops
+ *		the cut edges, lists the vertices again and links the edges of each vertex (first / next, end 2e is edge e
+ *		seen from edge_u[e], end 2e + 1 from edge_v[e])
+ *		Key path p has edges path_edges[path_start[p] .. path_start[p + 1]), from key vertex path_a[p] to path_b[p]
+ *		added[] lists the free cities a move has put on its new paths (labelled LABEL_SOURCE)
+ */
+typedef struct localTree {
+	CSRGraph* map;
+	long long cost;
+	bool* isTerm;
+	int* label;
+	int* first;
+	int* degree;
+	int* vertices;
+	int n_vertices;
+	int* stack;
+	int* added;
+	int n_added;
+	int* edge_u;
+	int* edge_v;
+	int* edge_w;
+	bool* cut;
+	int* next;
+	int n_edges;
+	int edge_capacity;
+	int* path_start;
+	int* path_edges;
+	int* path_a;
+	int* path_b;
+	int* path_cost;
+	int n_paths;
+} LocalTree;
+
+/* A route of the map between 2 cities of the tree, for MST re-pruning */
+typedef struct localEdge {
+	int w;
+	int u;
+	int v;
+} LocalEdge;
+
+
+/* Compare routes for qsort() (lightest first, then by cities, so the MST is the same on every platform) */
+static int compare_local_edges(const void* a, const void* b) {
+	const LocalEdge* x = a;
+	const LocalEdge* y = b;
+	if (x->w != y->w) {
+		return x->w < y->w ? -1 : 1;
+	}
+	if (x->u != y->u) {
+		return x->u < y->u ? -1 : 1;
+	}
+	return (x->v > y->v) - (x->v < y->v);
+}
+
+/* Representative of the set of element x (path halving) */
+static int find_set(int parent[], int x) {
+	while (parent[x] != x) {
+		parent[x] = parent[parent[x]];
+		x = parent[x];
+	}
+	return x;
+}
+
+/* Check if the time budget is used up (deadline 0: no budget) */
+static bool out_of_time(double deadline) {
+	return deadline > 0 && stats_now() >= deadline;
+}
+
+/* Check if a vertex of the tree is a key vertex (terminal, leaf, or 3 or more edges) */
+static bool is_key(LocalTree* self, int v) {
+	return self->isTerm[v] || self->degree[v] != 2;
+}
+
+/* Vertex at the other end of an edge end */
+static int other_end(LocalTree* self, int end) {
+	return end & 1 ? self->edge_u[end >> 1] : self->edge_v[end >> 1];
+}
+
+/* Append an edge (not linked until rebuild_tree()) */
+static void add_tree_edge(LocalTree* self, int u, int v, int w) {
+	if (self->n_edges == self->edge_capacity) {
+		self->edge_capacity *= 2;
+		self->edge_u = realloc(self->edge_u, sizeof(int) * self->edge_capacity);
+		self->edge_v = realloc(self->edge_v, sizeof(int) * self->edge_capacity);
+		self->edge_w = realloc(self->edge_w, sizeof(int) * self->edge_capacity);
+		self->cut = realloc(self->cut, sizeof(bool) * self->edge_capacity);
+		self->next = realloc(self->next, sizeof(int) * 2 * self->edge_capacity);
+		STATS_COUNT(STAT_ALLOCATIONS, 5);
+	}
+	self->edge_u[self->n_edges] = u < v ? u : v;
+	self->edge_v[self->n_edges] = u < v ? v : u;
+	self->edge_w[self->n_edges] = w;
+	self->cut[self->n_edges] = false;
+	self->n_edges++;
+}
+
+/* Drop cut edges, then list the vertices of the remaining edges and link their edges */
+static void rebuild_tree(LocalTree* self) {
+	for (int i = 0; i < self->n_added; i++) {
+		self->label[self->added[i]] = LABEL_FREE;
+	}
+	self->n_added = 0;
+	for (int i = 0; i < self->n_vertices; i++) {
+		int v = self->vertices[i];
+		self->label[v] = LABEL_FREE;
+		self->first[v] = -1;
+		self->degree[v] = 0;
+	}
+	self->n_vertices = 0;
+
+	int kept = 0;
+	for (int e = 0; e < self->n_edges; e++) {
+		if (!self->cut[e]) {
+			self->edge_u[kept] = self->edge_u[e];
+			self->edge_v[kept] = self->edge_v[e];
+			self->edge_w[kept] = self->edge_w[e];
+			self->cut[kept++] = false;
+		}
+	}
+	self->n_edges = kept;
+
+	for (int e = 0; e < self->n_edges; e++) {
+		int ends[2] = { self->edge_u[e], self->edge_v[e] };
+		for (int n = 0; n < 2; n++) {
+			int v = ends[n];
+			if (self->label[v] == LABEL_FREE) {
+				self->label[v] = LABEL_TREE;
+				self->vertices[self->n_vertices++] = v;
+			}
+			self->next[2 * e + n] = self->first[v];
+			self->first[v] = 2 * e + n;
+			self->degree[v]++;
+		}
+	}
+}
+
+/* Remove non-terminal leaves, repeatedly (a removed leaf can make its neighbour a leaf) */
+static void prune_leaves(LocalTree* self) {
+	int n_stack = 0;
+	for (int i = 0; i < self->n_vertices; i++) {
+		int v = self->vertices[i];
+		if (self->degree[v] == 1 && !self->isTerm[v]) {
+			self->stack[n_stack++] = v;
+		}
+	}
+	if (n_stack == 0) {
+		return;
+	}
+
+	while (n_stack > 0) {
+		int v = self->stack[--n_stack];
+		for (int end = self->first[v]; end != -1; end = self->next[end]) {
+			if (!self->cut[end >> 1]) {
+				self->cut[end >> 1] = true;
+				self->cost -= self->edge_w[end >> 1];
+				self->degree[v]--;
+				int u = other_end(self, end);
+				if (--self->degree[u] == 1 && !self->isTerm[u]) {
+					self->stack[n_stack++] = u;
+				}
+				break;
+			}
+		}
+	}
+	rebuild_tree(self);
+}
+
+/* Split the tree into key paths (the cut flags are used as visited flags, and cleared again) */
+static void find_key_paths(LocalTree* self) {
+	int n_path_edges = 0;
+	self->n_paths = 0;
+	for (int i = 0; i < self->n_vertices; i++) {
+		int a = self->vertices[i];
+		if (!is_key(self, a)) {
+			continue;
+		}
+		for (int end = self->first[a]; end != -1; end = self->next[end]) {
+			if (self->cut[end >> 1]) {
+				continue;
+			}
+
+			// Follow the path through vertices with 2 edges until the next key vertex
+			self->path_start[self->n_paths] = n_path_edges;
+			int cost = 0;
+			int current_end = end;
+			int v;
+			while (true) {
+				int e = current_end >> 1;
+				self->cut[e] = true;
+				self->path_edges[n_path_edges++] = e;
+				cost += self->edge_w[e];
+				v = other_end(self, current_end);
+				if (is_key(self, v)) {
+					break;
+				}
+				current_end = self->first[v];
+				if ((current_end >> 1) == e) {
+					current_end = self->next[current_end];
+				}
+			}
+			self->path_a[self->n_paths] = a;
+			self->path_b[self->n_paths] = v;
+			self->path_cost[self->n_paths++] = cost;
+		}
+	}
+	self->path_start[self->n_paths] = n_path_edges;
+
+	for (int e = 0; e < self->n_edges; e++) {
+		self->cut[e] = false;
+	}
+}
+
+/* Cut the edges of key path p, its inner vertices become free */
+static void cut_key_path(LocalTree* self, int p) {
+	for (int i = self->path_start[p]; i < self->path_start[p + 1]; i++) {
+		int e = self->path_edges[i];
+		self->cut[e] = true;
+		int ends[2] = { self->edge_u[e], self->edge_v[e] };
+		for (int n = 0; n < 2; n++) {
+			if (ends[n] != self->path_a[p] && ends[n] != self->path_b[p]) {
+				self->label[ends[n]] = LABEL_FREE;
+			}
+		}
+	}
+}
+
+/* Label the part of the tree around vertex v (through edges not cut, over vertices labelled LABEL_TREE)
+ *		Return: number of vertices in the part
+ */
+static int label_part(LocalTree* self, int v, int label) {
+	int n_labelled = 1;
+	int n_stack = 0;
+	self->label[v] = label;
+	self->stack[n_stack++] = v;
+	while (n_stack > 0) {
+		int x = self->stack[--n_stack];
+		for (int end = self->first[x]; end != -1; end = self->next[end]) {
+			int u = other_end(self, end);
+			if (!self->cut[end >> 1] && self->label[u] == LABEL_TREE) {
+				self->label[u] = label;
+				self->stack[n_stack++] = u;
+				n_labelled++;
+			}
+		}
+	}
+	return n_labelled;
+}
+
+/* Undo a move: drop the edges it appended, keep every edge and restore the labels */
+static void cancel_move(LocalTree* self, int n_edges) {
+	self->n_edges = n_edges;
+	for (int e = 0; e < self->n_edges; e++) {
+		self->cut[e] = false;
+	}
+	for (int i = 0; i < self->n_added; i++) {
+		self->label[self->added[i]] = LABEL_FREE;
+	}
+	self->n_added = 0;
+	for (int i = 0; i < self->n_vertices; i++) {
+		self->label[self->vertices[i]] = LABEL_TREE;
+	}
+}
+
+/* Dijkstra's search from every vertex labelled LABEL_SOURCE through free vertices, until the first vertex of
+ *		another part (label from LABEL_PART up), in the thread's workspace. Gives up at distance limit
+ *		Return: vertex reached (-1 if none is closer than limit), *distance = its distance
+ */
+static int search_parts(LocalTree* self, int limit, int* distance, Workspace** workspace) {
+	CSRGraph* map = self->map;
+	int* label = self->label;
+	Workspace* ws = borrow_workspace(map->V);
+	unsigned int* mark = ws->mark;
+	unsigned int epoch = ws->epoch;
+	int* dist = ws->dist;
+	int* pred_v = ws->pred_v;
+	PQueue* queue = &ws->queue;
+	STATS_LOCAL(n_settled);
+	STATS_LOCAL(n_relaxed);
+	*workspace = ws;
+
+	for (int i = 0; i < self->n_vertices + self->n_added; i++) {
+		int v = i < self->n_vertices ? self->vertices[i] : self->added[i - self->n_vertices];
+		if (label[v] == LABEL_SOURCE && !WS_REACHED(v)) {
+			WS_TOUCH(v);
+			dist[v] = 0;
+			pq_insert(queue, v, 0);
+		}
+	}
+
+	int found = -1;
+	while (!pq_is_empty(queue)) {
+		int v = pq_pop_min(queue, NULL);
+		if (dist[v] >= limit) {
+			break;
+		}
+		if (label[v] >= LABEL_PART) {
+			found = v;
+			*distance = dist[v];
+			break;
+		}
+		WS_SETTLE(v);
+		STATS_INC(n_settled);
+
+		for (int e = map->offsets[v]; e < map->offsets[v + 1]; e++) {
+			int u = map->to_vertex[e];
+			STATS_INC(n_relaxed);
+			if (label[u] == LABEL_TREE || label[u] == LABEL_SOURCE) {
+				continue;
+			}
+			WS_TOUCH(u);
+			if (!WS_SETTLED(u) && dist[v] + map->weight[e] < dist[u]) {
+				dist[u] = dist[v] + map->weight[e];
+				pred_v[u] = v;
+				if (pq_contains(queue, u)) {
+					pq_decrease_key(queue, u, dist[u]);
+				}
+				else {
+					pq_insert(queue, u, dist[u]);
+				}
+			}
+		}
+	}
+
+	STATS_COUNT(STAT_SEARCHES, 1);
+	STATS_COUNT(STAT_SETTLED, n_settled);
+	STATS_COUNT(STAT_RELAXED, n_relaxed);
+	return found;
+}
+
+/* Append the path a search found back to the source part, its free vertices join that part */
+static void join_path(LocalTree* self, Workspace* ws, int found) {
+	int v = found;
+	while (true) {
+		int u = ws->pred_v[v];
+		add_tree_edge(self, u, v, ws->dist[v] - ws->dist[u]);
+		if (self->label[u] == LABEL_SOURCE) {
+			break;
+		}
+		self->label[u] = LABEL_SOURCE;
+		self->added[self->n_added++] = u;
+		v = u;
+	}
+}
+
+/* Key-path exchange: replace key path p by a cheaper path between the 2 parts it joins, if there is one */
+static bool exchange_key_path(LocalTree* self, int p) {
+	int n_edges = self->n_edges;
+	cut_key_path(self, p);
+
+	// Search from the smaller part (the search covers every city closer to it than the path)
+	bool a_smaller = label_part(self, self->path_a[p], LABEL_TREE + 1) <= label_part(self, self->path_b[p], LABEL_TREE + 2);
+	for (int i = 0; i < self->n_vertices; i++) {
+		int v = self->vertices[i];
+		if (self->label[v] > LABEL_TREE) {
+			self->label[v] = (self->label[v] == LABEL_TREE + 1) == a_smaller ? LABEL_SOURCE : LABEL_PART;
+		}
+	}
+
+	int distance;
+	Workspace* ws;
+	int found = search_parts(self, self->path_cost[p], &distance, &ws);
+	if (found == -1) {
+		cancel_move(self, n_edges);
+		return false;
+	}
+	join_path(self, ws, found);
+	self->cost += distance - self->path_cost[p];
+	rebuild_tree(self);
+	prune_leaves(self);
+	return true;
+}
+
+/* Key-vertex elimination: take out non-terminal key vertex s and its key paths, and reconnect the parts left by
+ *		shortest paths (Prim's over the parts) if that is cheaper
+ */
+static bool eliminate_key_vertex(LocalTree* self, int s) {
+	int n_edges = self->n_edges;
+	int removed = 0;
+	int n_parts = 0;
+	int* parts = malloc(sizeof(int) * self->degree[s]);
+	for (int p = 0; p < self->n_paths; p++) {
+		if (self->path_a[p] == s || self->path_b[p] == s) {
+			cut_key_path(self, p);
+			removed += self->path_cost[p];
+			parts[n_parts++] = self->path_a[p] == s ? self->path_b[p] : self->path_a[p];
+		}
+	}
+	self->label[s] = LABEL_FREE;
+	for (int i = 0; i < n_parts; i++) {
+		label_part(self, parts[i], i == 0 ? LABEL_SOURCE : LABEL_PART + i - 1);
+	}
+
+	// Join the closest other part to everything joined so far, until all are joined or it costs too much
+	int total = 0;
+	bool joined = true;
+	for (int i = 1; i < n_parts && joined; i++) {
+		int distance;
+		Workspace* ws;
+		int found = search_parts(self, removed - total, &distance, &ws);
+		if (found == -1) {
+			joined = false;
+			break;
+		}
+		int part = self->label[found];
+		join_path(self, ws, found);
+		total += distance;
+		for (int j = 0; j < self->n_vertices; j++) {
+			if (self->label[self->vertices[j]] == part) {
+				self->label[self->vertices[j]] = LABEL_SOURCE;
+			}
+		}
+	}
+	free(parts);
+
+	if (!joined) {
+		cancel_move(self, n_edges);
+		return false;
+	}
+	self->cost += total - removed;
+	rebuild_tree(self);
+	prune_leaves(self);
+	return true;
+}
+
+/* MST re-pruning: MST of the map routes between the vertices of the tree, then remove non-terminal leaves
+ *		The old edges are kept if that costs more (the MST can join parts the tree keeps apart)
+ *		Return: true if the tree is now cheaper
+ */
+static bool reprune_tree(LocalTree* self) {
+	CSRGraph* map = self->map;
+	long long old_cost = self->cost;
+	int n_old = self->n_edges;
+	int* old_edges = malloc(sizeof(int) * 3 * (n_old > 0 ? n_old : 1));
+	for (int e = 0; e < n_old; e++) {
+		old_edges[3 * e] = self->edge_u[e];
+		old_edges[3 * e + 1] = self->edge_v[e];
+		old_edges[3 * e + 2] = self->edge_w[e];
+	}
+
+	// Routes between vertices of the tree (degree[] holds the index of each vertex until the tree is rebuilt)
+	int n_candidates = 0;
+	for (int i = 0; i < self->n_vertices; i++) {
+		int v = self->vertices[i];
+		self->degree[v] = i;
+		for (int e = map->offsets[v]; e < map->offsets[v + 1]; e++) {
+			n_candidates += self->label[map->to_vertex[e]] != LABEL_FREE && v < map->to_vertex[e];
+		}
+	}
+	LocalEdge* candidates = malloc(sizeof(LocalEdge) * (n_candidates > 0 ? n_candidates : 1));
+	n_candidates = 0;
+	for (int i = 0; i < self->n_vertices; i++) {
+		int v = self->vertices[i];
+		for (int e = map->offsets[v]; e < map->offsets[v + 1]; e++) {
+			int u = map->to_vertex[e];
+			if (self->label[u] != LABEL_FREE && v < u) {
+				candidates[n_candidates].w = map->weight[e];
+				candidates[n_candidates].u = v;
+				candidates[n_candidates++].v = u;
+			}
+		}
+	}
+	qsort(candidates, n_candidates, sizeof(LocalEdge), compare_local_edges);
+
+	// Kruskal's over the routes
+	int* parent = malloc(sizeof(int) * (self->n_vertices > 0 ? self->n_vertices : 1));
+	for (int i = 0; i < self->n_vertices; i++) {
+		parent[i] = i;
+	}
+	self->n_edges = 0;
+	self->cost = 0;
+	for (int c = 0; c < n_candidates; c++) {
+		int root_u = find_set(parent, self->degree[candidates[c].u]);
+		int root_v = find_set(parent, self->degree[candidates[c].v]);
+		if (root_u != root_v) {
+			parent[root_u] = root_v;
+			add_tree_edge(self, candidates[c].u, candidates[c].v, candidates[c].w);
+			self->cost += candidates[c].w;
+		}
+	}
+	rebuild_tree(self);
+	prune_leaves(self);
+
+	if (self->cost > old_cost) {
+		self->n_edges = 0;
+		for (int e = 0; e < n_old; e++) {
+			add_tree_edge(self, old_edges[3 * e], old_edges[3 * e + 1], old_edges[3 * e + 2]);
+		}
+		self->cost = old_cost;
+		rebuild_tree(self);
+	}
+
+	free(old_edges);
+	free(candidates);
+	free(parent);
+	STATS_COUNT(STAT_ALLOCATIONS, 3);
+	return self->cost < old_cost;
+}
+
+
+/* Improve a Steiner tree (or any union of paths between the terminals) by local search, in place
+ *		1. MST re-pruning: MST of the map routes between the cities of the tree, then remove non-terminal leaves
+ *		   (this also breaks the cycles of a union of shortest paths)
+ *		2. Key-path exchange: a key path joins 2 key vertices (terminals, and cities where 3 or more routes of the
+ *		   tree meet) through cities of neither kind. Take it out, and reconnect the 2 parts left by the shortest path
+ *		   between them through cities outside the tree, if that is cheaper
+ *		3. Key-vertex elimination: take out a non-terminal key vertex with all its key paths, and reconnect the parts
+ *		   left 1 at a time by shortest paths (Prim's over the parts), if that is cheaper
+ *		Moves are repeated until none improves the tree. Each only looks at the cost of what it removes and adds (a
+ *		search gives up as soon as it cannot beat the removed paths), and the searches use the thread's workspace
+ *		The tree is only replaced if it gets cheaper. With a budget, moves stop once it is used up (the tree is
+ *		still valid, but may then depend on the speed of the machine)
+ * Parameters:
+ *		map				CSRGraph the tree was found in
+ *		tree			pointer to the tree (Graph), replaced by the improved tree
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ *		budget_ms		time budget in milliseconds (0 for no limit)
+ * Return: train tokens saved
+ */
+int improve_steiner_tree(CSRGraph* map, Graph* tree, int terminals[], int n_terminals, double budget_ms) {
+	STATS_BEGIN("improve_steiner_tree");
+	double deadline = budget_ms > 0 ? stats_now() + budget_ms : 0;
+	int V = map->V;
+	int size = V > 0 ? V : 1;
+
+	LocalTree self;
+	self.map = map;
+	self.isTerm = calloc(size, sizeof(bool));
+	self.label = calloc(size, sizeof(int));
+	self.first = malloc(sizeof(int) * size);
+	self.degree = calloc(size, sizeof(int));
+	self.vertices = malloc(sizeof(int) * size);
+	self.n_vertices = 0;
+	self.stack = malloc(sizeof(int) * size);
+	self.added = malloc(sizeof(int) * size);
+	self.n_added = 0;
+	self.edge_capacity = size;
+	self.edge_u = malloc(sizeof(int) * self.edge_capacity);
+	self.edge_v = malloc(sizeof(int) * self.edge_capacity);
+	self.edge_w = malloc(sizeof(int) * self.edge_capacity);
+	self.cut = malloc(sizeof(bool) * self.edge_capacity);
+	self.next = malloc(sizeof(int) * 2 * self.edge_capacity);
+	self.n_edges = 0;
+	self.path_start = malloc(sizeof(int) * (size + 1));
+	self.path_edges = malloc(sizeof(int) * size);
+	self.path_a = malloc(sizeof(int) * size);
+	self.path_b = malloc(sizeof(int) * size);
+	self.path_cost = malloc(sizeof(int) * size);
+	self.n_paths = 0;
+	STATS_COUNT(STAT_ALLOCATIONS, 17);
+	for (int v = 0; v < V; v++) {
+		self.first[v] = -1;
+	}
+	for (int i = 0; i < n_terminals; i++) {
+		self.isTerm[terminals[i]] = true;
+	}
+
+	// Edges of the tree (each once, whichever way round the graph stores it), then MST re-pruning
+	for (int v = 0; v < tree->V; v++) {
+		for (EdgeNodePtr current = tree->edges[v].head; current != NULL; current = current->next) {
+			add_tree_edge(&self, v, current->edge.to_vertex, current->edge.weight);
+		}
+	}
+	long long original = graph_weight(tree);
+	rebuild_tree(&self);
+	self.cost = LLONG_MAX;
+	reprune_tree(&self);
+
+	// Moves until none improves the tree (the MST can only cost more than the original if it is not a tree)
+	bool improved = self.cost <= original;
+	while (improved && !out_of_time(deadline)) {
+		improved = false;
+
+		// Key-path exchange, round the key paths until none of them improves
+		find_key_paths(&self);
+		for (int p = 0, n_failed = 0; n_failed < self.n_paths && !out_of_time(deadline); p++) {
+			if (p >= self.n_paths) {
+				p = 0;
+			}
+			if (exchange_key_path(&self, p)) {
+				improved = true;
+				n_failed = 0;
+				find_key_paths(&self);
+			}
+			else {
+				n_failed++;
+			}
+		}
+
+		// Key-vertex elimination, round the vertices until none of them improves
+		for (int i = 0, n_failed = 0; n_failed < self.n_vertices && !out_of_time(deadline); i++) {
+			if (i >= self.n_vertices) {
+				i = 0;
+			}
+			int s = self.vertices[i];
+			if (!self.isTerm[s] && self.degree[s] >= 3 && eliminate_key_vertex(&self, s)) {
+				improved = true;
+				n_failed = 0;
+				find_key_paths(&self);
+			}
+			else {
+				n_failed++;
+			}
+		}
+
+		// MST re-pruning over the vertices the moves left in the tree
+		if (!out_of_time(deadline) && reprune_tree(&self)) {
+			improved = true;
+		}
+	}
+
+	// Replace the tree only if it got cheaper
+	int saved = 0;
+	if (self.cost < original) {
+		saved = (int)(original - self.cost);
+		destroy_graph(tree);
+		*tree = create_empty_graph(V);
+		for (int e = 0; e < self.n_edges; e++) {
+			add_edge(tree, self.edge_u[e], self.edge_v[e], self.edge_w[e]);
+		}
+	}
+
+	/* Free memory */
+	free(self.isTerm);
+	free(self.label);
+	free(self.first);
+	free(self.degree);
+	free(self.vertices);
+	free(self.stack);
+	free(self.added);
+	free(self.edge_u);
+	free(self.edge_v);
+	free(self.edge_w);
+	free(self.cut);
+	free(self.next);
+	free(self.path_start);
+	free(self.path_edges);
+	free(self.path_a);
+	free(self.path_b);
+	free(self.path_cost);
+
+	STATS_END("improve_steiner_tree");
+	return saved;
+}
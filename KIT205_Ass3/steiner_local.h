@@ -0,0 +1,28 @@
+#ifndef STEINER_LOCAL_H
+#define STEINER_LOCAL_H
+
+#include "graph.h"
+
+
+/* Improve a Steiner tree (or any union of paths between the terminals) by local search, in place
+ *		1. MST re-pruning: MST of the map routes between the cities of the tree, then remove non-terminal leaves
+ *		   (this also breaks the cycles of a union of shortest paths)
+ *		2. Key-path exchange: a key path joins 2 key vertices (terminals, and cities where 3 or more routes of the
+ *		   tree meet) through cities of neither kind. Take it out, and reconnect the 2 parts left by the shortest path
+ *		   between them through cities outside the tree, if that is cheaper
+ *		3. Key-vertex elimination: take out a non-terminal key vertex with all its key paths, and reconnect the parts
+ *		   left 1 at a time by shortest paths (Prim's over the parts), if that is cheaper
+ *		Moves are repeated until none improves the tree. Each only looks at the cost of what it removes and adds (a
+ *		search gives up as soon as it cannot beat the removed paths), and the searches use the thread's workspace
+ *		The tree is only replaced if it gets cheaper. With a budget, moves stop once it is used up (the tree is
+ *		still valid, but may then depend on the speed of the machine)
+ * Parameters:
+ *		map				CSRGraph the tree was found in
+ *		tree			pointer to the tree (Graph), replaced by the improved tree
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ *		budget_ms		time budget in milliseconds (0 for no limit)
+ * Return: train tokens saved
+ */
+int improve_steiner_tree(CSRGraph* map, Graph* tree, int terminals[], int n_terminals, double budget_ms);
+#endif
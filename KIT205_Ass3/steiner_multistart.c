@@ -0,0 +1,325 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include "graph.h"
+#include "pathcache.h"
+#include "steiner_multistart.h"
+#include "stats.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Randomised runs added by solve_steiner_tree()
+static int multistart_restarts = 0;
+
+/* Outcome of 1 greedy run
+ *		segments[] (owned by the caller) holds the (terminal, tree vertex) pair of each path added, in order
+ */
+typedef struct multistartRun {
+	long long cost;
+	int n_connected;
+	int n_segments;
+	bool given_up;
+} MultistartRun;
+
+/* Arrays of 1 thread, reused by all its runs (inTree is all false between runs) */
+typedef struct multistartScratch {
+	bool* inTree;
+	int* tree_vertices;
+	int* remaining;
+} MultistartScratch;
+
+
+/* Set the number of randomised runs multistart_steiner_tree() adds when called by solve_steiner_tree()
+ * Parameters:
+ *		n_random	randomised runs on top of the 1 run from each terminal (default 0)
+ * Return: void
+ */
+void set_multistart_restarts(int n_random) {
+	multistart_restarts = n_random > 0 ? n_random : 0;
+}
+
+/* Get the number of randomised runs multistart_steiner_tree() adds when called by solve_steiner_tree()
+ * No parameters
+ * Return: number of randomised runs
+ */
+int get_multistart_restarts() {
+	return multistart_restarts;
+}
+
+
+/* Next number of a SplitMix64 generator (same as the map generator, so runs are the same on every platform) */
+static uint64_t next_random(uint64_t* state) {
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+/* Lower bound on any tree connecting the k distinct terminals (-1 if a terminal cannot be reached)
+ *		Walking around the tree visits every terminal for twice its cost, so the tree costs at least the distance
+ *		between the 2 farthest terminals, half the sum of the distances from each terminal to its closest other
+ *		terminal, and k / (2(k - 1)) times the MST of the distance network
+ */
+static long long distance_network_bound(PathCache* cache, int distinct[], int k) {
+	long long farthest = 0;
+	long long closest_sum = 0;
+	for (int i = 0; i < k; i++) {
+		int* dist = cache->dist[distinct[i]];
+		int closest = INT_MAX;
+		for (int j = 0; j < k; j++) {
+			if (j == i) {
+				continue;
+			}
+			if (dist[distinct[j]] == INT_MAX) {
+				return -1;
+			}
+			if (dist[distinct[j]] > farthest) {
+				farthest = dist[distinct[j]];
+			}
+			if (dist[distinct[j]] < closest) {
+				closest = dist[distinct[j]];
+			}
+		}
+		closest_sum += closest;
+	}
+
+	// Prim's over the distances (complete graph, so O(k^2) without a queue)
+	int* key = malloc(sizeof(int) * k);
+	bool* in_tree = malloc(sizeof(bool) * k);
+	for (int i = 0; i < k; i++) {
+		key[i] = INT_MAX;
+		in_tree[i] = false;
+	}
+	key[0] = 0;
+	long long mst = 0;
+	for (int n = 0; n < k; n++) {
+		int next = -1;
+		for (int i = 0; i < k; i++) {
+			if (!in_tree[i] && (next == -1 || key[i] < key[next])) {
+				next = i;
+			}
+		}
+		in_tree[next] = true;
+		mst += key[next];
+		int* dist = cache->dist[distinct[next]];
+		for (int i = 0; i < k; i++) {
+			if (!in_tree[i] && dist[distinct[i]] < key[i]) {
+				key[i] = dist[distinct[i]];
+			}
+		}
+	}
+	free(key);
+	free(in_tree);
+
+	long long bound = farthest;
+	if ((closest_sum + 1) / 2 > bound) {
+		bound = (closest_sum + 1) / 2;
+	}
+	long long mst_bound = (mst * k + 2 * (k - 1) - 1) / (2 * (k - 1));
+	return mst_bound > bound ? mst_bound : bound;
+}
+
+/* 1 run of the greedy of cached_steiner_tree() from terminal distinct[start]: repeatedly connect the terminal
+ *		closest to the tree, along its shortest path tree (ties broken at random if state is not NULL)
+ *		Gives up once the cost reaches give_up
+ */
+static MultistartRun greedy_run(PathCache* cache, int distinct[], int k, int start, uint64_t* state, long long give_up,
+	MultistartScratch* scratch, int segments[]) {
+	MultistartRun run = { 0, 1, 0, false };
+	bool* inTree = scratch->inTree;
+	int* tree_vertices = scratch->tree_vertices;
+	int* remaining = scratch->remaining;
+	int n_tree = 0;
+	int n_remaining = 0;
+
+	inTree[distinct[start]] = true;
+	tree_vertices[n_tree++] = distinct[start];
+	for (int i = 0; i < k; i++) {
+		if (i != start) {
+			remaining[n_remaining++] = distinct[i];
+		}
+	}
+
+	while (n_remaining > 0) {
+		// Find closest terminal not in tree to a vertex in tree
+		int closest_distance = INT_MAX;
+		int closest_term = -1;
+		int closest_tree_v = -1;
+		int n_ties = 0;
+		for (int i = 0; i < n_remaining; i++) {
+			int* dist = cache->dist[remaining[i]];
+			for (int j = 0; j < n_tree; j++) {
+				int d = dist[tree_vertices[j]];
+				if (d < closest_distance) {
+					closest_distance = d;
+					closest_term = i;
+					closest_tree_v = tree_vertices[j];
+					n_ties = 1;
+				}
+				else if (state != NULL && d == closest_distance && d != INT_MAX && next_random(state) % ++n_ties == 0) {
+					closest_term = i;
+					closest_tree_v = tree_vertices[j];
+				}
+			}
+		}
+
+		// Remaining terminals are unreachable
+		if (closest_term == -1) {
+			break;
+		}
+
+		run.cost += closest_distance;
+		if (run.cost >= give_up) {
+			run.given_up = true;
+			break;
+		}
+		segments[2 * run.n_segments] = remaining[closest_term];
+		segments[2 * run.n_segments + 1] = closest_tree_v;
+		run.n_segments++;
+
+		// Vertices of the path join the tree, in the order cached_steiner_tree() adds them (from the terminal)
+		int first_new = n_tree;
+		for (int v = closest_tree_v; v != -1; v = cache->pred_v[remaining[closest_term]][v]) {
+			if (!inTree[v]) {
+				inTree[v] = true;
+				tree_vertices[n_tree++] = v;
+			}
+		}
+		for (int i = first_new, j = n_tree - 1; i < j; i++, j--) {
+			int temp = tree_vertices[i];
+			tree_vertices[i] = tree_vertices[j];
+			tree_vertices[j] = temp;
+		}
+
+		// Remove connected terminals from remaining (terminals passed on the way are connected too)
+		int kept = 0;
+		for (int i = 0; i < n_remaining; i++) {
+			if (!inTree[remaining[i]]) {
+				remaining[kept++] = remaining[i];
+			}
+		}
+		run.n_connected += n_remaining - kept;
+		n_remaining = kept;
+	}
+
+	// Leave inTree all false for the next run
+	for (int j = 0; j < n_tree; j++) {
+		inTree[tree_vertices[j]] = false;
+	}
+	return run;
+}
+
+
+/* Steiner tree with set of terminal vertices, best of the greedy of cached_steiner_tree() started from every terminal
+ *		The greedy grows its tree from 1 terminal, and the result depends a lot on which one. Run r starts from
+ *		distinct terminal r % k, runs from k on also break ties between equally close terminals at random (seeded
+ *		by r), and the cheapest tree is kept (the earliest run on a tie, so run 0 is cached_steiner_tree())
+ *		Runs share the shortest path trees of the terminals (computed once) and are handed out in batches of 1 per
+ *		OpenMP thread. A run gives up once it costs as much as the best of the earlier batches, and no more batches
+ *		are started once the best matches a lower bound (farthest terminals, half the distances to the closest
+ *		terminal, and k / (2(k - 1)) times the MST of the distance network)
+ *		The tree kept does not depend on the number of threads
+ * Parameters:
+ *		cache			PathCache of the map
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ *		n_random		randomised runs on top of the 1 run from each terminal
+ * Return: steiner tree (Graph)
+ */
+Graph multistart_steiner_tree(PathCache* cache, int terminals[], int n_terminals, int n_random) {
+	STATS_BEGIN("multistart_steiner_tree");
+	int V = cache->map->V;
+	Graph steiner_t = create_empty_graph(V);
+
+	// Terminals without duplicates, in order (so run 0 starts from terminals[0])
+	bool* isTerm = calloc(V, sizeof(bool));
+	int* distinct = malloc(sizeof(int) * (n_terminals > 0 ? n_terminals : 1));
+	int k = 0;
+	for (int i = 0; i < n_terminals; i++) {
+		if (!isTerm[terminals[i]]) {
+			isTerm[terminals[i]] = true;
+			distinct[k++] = terminals[i];
+		}
+	}
+	free(isTerm);
+	if (k < 2) {
+		free(distinct);
+		STATS_END("multistart_steiner_tree");
+		return steiner_t;
+	}
+
+	// Shortest path trees of the terminals, only read by the runs from here on
+	warm_path_cache(cache, distinct, k);
+	long long bound = distance_network_bound(cache, distinct, k);
+
+	int n_runs = k + (n_random > 0 ? n_random : 0);
+	MultistartRun* runs = malloc(sizeof(MultistartRun) * n_runs);
+	int* segments = malloc(sizeof(int) * 2 * (k - 1) * n_runs);
+	int batch = 1;
+#ifdef _OPENMP
+	batch = omp_get_max_threads();
+#endif
+
+	// Best run so far (read by every thread between batches, only changed by 1 of them after each batch)
+	int best = -1;
+	bool done = false;
+	#pragma omp parallel
+	{
+		MultistartScratch scratch;
+		scratch.inTree = calloc(V, sizeof(bool));
+		scratch.tree_vertices = malloc(sizeof(int) * V);
+		scratch.remaining = malloc(sizeof(int) * k);
+
+		for (int first = 0; first < n_runs && !done; first += batch) {
+			int last = first + batch < n_runs ? first + batch : n_runs;
+			long long give_up = best != -1 && runs[best].n_connected == k ? runs[best].cost : LLONG_MAX;
+
+			#pragma omp for schedule(dynamic)
+			for (int r = first; r < last; r++) {
+				uint64_t state = (uint64_t)r;
+				runs[r] = greedy_run(cache, distinct, k, r % k, r >= k ? &state : NULL, give_up, &scratch,
+					&segments[2 * (k - 1) * r]);
+			}
+
+			// Most terminals connected, then cheapest, then earliest run
+			#pragma omp single
+			{
+				for (int r = first; r < last; r++) {
+					if (!runs[r].given_up && (best == -1 || runs[r].n_connected > runs[best].n_connected
+						|| (runs[r].n_connected == runs[best].n_connected && runs[r].cost < runs[best].cost))) {
+						best = r;
+					}
+				}
+				done = runs[best].n_connected == k && runs[best].cost <= bound;
+			}
+		}
+
+		free(scratch.inTree);
+		free(scratch.tree_vertices);
+		free(scratch.remaining);
+		STATS_COUNT(STAT_ALLOCATIONS, 3);
+	}
+
+	// Tree of the best run, from its paths
+	Arena* scratch = create_arena(sizeof(struct edgeNode) * 64);
+	int* best_segments = &segments[2 * (k - 1) * best];
+	for (int s = 0; s < runs[best].n_segments; s++) {
+		EdgeList path = trace_path(cache->pred_v[best_segments[2 * s]], best_segments[2 * s + 1], scratch);
+		add_path_edges(&steiner_t, cache->map, path);
+		arena_reset(scratch);
+	}
+
+	/* Free memory */
+	free(distinct);
+	free(runs);
+	free(segments);
+	destroy_arena(scratch);
+	STATS_COUNT(STAT_ALLOCATIONS, 6);
+
+	STATS_END("multistart_steiner_tree");
+	return steiner_t;
+}
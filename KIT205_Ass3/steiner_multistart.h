@@ -0,0 +1,40 @@
+#ifndef STEINER_MULTISTART_H
+#define STEINER_MULTISTART_H
+
+#include "graph.h"
+#include "pathcache.h"
+
+
+/* Set the number of randomised runs multistart_steiner_tree() adds when called by solve_steiner_tree()
+ * Parameters:
+ *		n_random	randomised runs on top of the 1 run from each terminal (default 0)
+ * Return: void
+ */
+void set_multistart_restarts(int n_random);
+
+
+/* Get the number of randomised runs multistart_steiner_tree() adds when called by solve_steiner_tree()
+ * No parameters
+ * Return: number of randomised runs
+ */
+int get_multistart_restarts();
+
+
+/* Steiner tree with set of terminal vertices, best of the greedy of cached_steiner_tree() started from every terminal
+ *		The greedy grows its tree from 1 terminal, and the result depends a lot on which one. Run r starts from
+ *		distinct terminal r % k, runs from k on also break ties between equally close terminals at random (seeded
+ *		by r), and the cheapest tree is kept (the earliest run on a tie, so run 0 is cached_steiner_tree())
+ *		Runs share the shortest path trees of the terminals (computed once) and are handed out in batches of 1 per
+ *		OpenMP thread. A run gives up once it costs as much as the best of the earlier batches, and no more batches
+ *		are started once the best matches a lower bound (farthest terminals, half the distances to the closest
+ *		terminal, and k / (2(k - 1)) times the MST of the distance network)
+ *		The tree kept does not depend on the number of threads
+ * Parameters:
+ *		cache			PathCache of the map
+ *		terminals[]		array containing all terminal vertices
+ *		n_terminals		number of terminals (= 2 * n_tickets)
+ *		n_random		randomised runs on top of the 1 run from each terminal
+ * Return: steiner tree (Graph)
+ */
+Graph multistart_steiner_tree(PathCache* cache, int terminals[], int n_terminals, int n_random);
+#endif
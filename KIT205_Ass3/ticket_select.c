@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "graph.h"
+#include "pathcache.h"
+#include "steiner.h"
+#include "batch.h"
+#include "ticket_select.h"
+#include "stats.h"
+
+// Trees of subsets with the same points are built this many at a time (cheapest bound first), so the rest can
+//		be skipped once one fits
+#define SELECT_BATCH 32
+
+/* A subset of tickets that may fit within the budget */
+typedef struct selectCandidate {
+	int set;
+	int score;
+	int bound;
+} SelectCandidate;
+
+
+/* Compare candidates for qsort() (most points first, then cheapest bound, then subset) */
+static int compare_candidates(const void* a, const void* b) {
+	const SelectCandidate* x = a;
+	const SelectCandidate* y = b;
+	if (x->score != y->score) {
+		return x->score > y->score ? -1 : 1;
+	}
+	if (x->bound != y->bound) {
+		return x->bound < y->bound ? -1 : 1;
+	}
+	return (x->set > y->set) - (x->set < y->set);
+}
+
+/* Lower bound on the tree of a subset: the distance between its 2 farthest cities, and half the MST of the
+ *		distances between its cities (INT_MAX if a city cannot be reached), dist[] between the 2n cities (ticket t:
+ *		cities 2t and 2t + 1)
+ */
+static int subset_bound(int dist[], int n_cities, int set) {
+	int cities[2 * MAX_SELECT_TICKETS];
+	int n = 0;
+	for (int t = 0; 2 * t < n_cities; t++) {
+		if (set & (1 << t)) {
+			cities[n++] = 2 * t;
+			cities[n++] = 2 * t + 1;
+		}
+	}
+	long long farthest = 0;
+	for (int i = 0; i < n; i++) {
+		for (int j = i + 1; j < n; j++) {
+			if (dist[cities[i] * n_cities + cities[j]] > farthest) {
+				farthest = dist[cities[i] * n_cities + cities[j]];
+			}
+		}
+	}
+
+	// Prim's over the distances (the subset has at most 2 * MAX_SELECT_TICKETS cities)
+	int key[2 * MAX_SELECT_TICKETS];
+	bool in_tree[2 * MAX_SELECT_TICKETS];
+	for (int i = 0; i < n; i++) {
+		key[i] = INT_MAX;
+		in_tree[i] = false;
+	}
+	long long mst = 0;
+	if (n > 0) {
+		key[0] = 0;
+	}
+	for (int k = 0; k < n; k++) {
+		int closest = -1;
+		for (int i = 0; i < n; i++) {
+			if (!in_tree[i] && (closest == -1 || key[i] < key[closest])) {
+				closest = i;
+			}
+		}
+		if (key[closest] == INT_MAX) {
+			return INT_MAX;
+		}
+		in_tree[closest] = true;
+		mst += key[closest];
+		for (int i = 0; i < n; i++) {
+			int d = dist[cities[closest] * n_cities + cities[i]];
+			if (!in_tree[i] && d < key[i]) {
+				key[i] = d;
+			}
+		}
+	}
+
+	long long bound = (mst + 1) / 2 > farthest ? (mst + 1) / 2 : farthest;
+	return bound < INT_MAX ? (int)bound : INT_MAX;
+}
+
+/* Tree of a subset of tickets (solve_steiner_tree(), the cache must be warm if called from several threads) */
+static Graph subset_tree(PathCache* cache, TicketSet* tickets, int set) {
+	int terminals[2 * MAX_SELECT_TICKETS];
+	int n_terminals = 0;
+	for (int t = 0; t < tickets->n_tickets; t++) {
+		if (set & (1 << t)) {
+			terminals[n_terminals++] = tickets->from_cities[t];
+			terminals[n_terminals++] = tickets->to_cities[t];
+		}
+	}
+	if (n_terminals == 0) {
+		return create_empty_graph(cache->map->V);
+	}
+	return solve_steiner_tree(cache, terminals, n_terminals);
+}
+
+
+/* Choose the tickets to keep (prize-collecting Steiner tree): the most points whose tree fits within the budget
+ *		1. Distances between all ticket cities (path cache, every tree computed up front in parallel)
+ *		2. For every subset, in parallel: its points, and a lower bound on its tree (the distance between its 2
+ *		   farthest cities, and half the MST of the distances between them), kept in a table indexed by subset
+ *		3. Subsets that may fit, from most points down: the trees of all subsets with the same points are built
+ *		   in parallel (solve_steiner_tree(), cheapest bound first), and the cheapest that fits is kept
+ *		Tree costs are those of the selected Steiner tree solver, so a subset only fits if its tree does
+ * Parameters:
+ *		cache			PathCache of the map
+ *		tickets			candidate tickets (at most MAX_SELECT_TICKETS)
+ *		points[]		points of each ticket (NULL: the length of its shortest path, as on the board game)
+ *		budget			train tokens available
+ * Return: TicketSelection (nothing kept if there are too many tickets)
+ */
+TicketSelection select_tickets(PathCache* cache, TicketSet* tickets, int points[], int budget) {
+	STATS_BEGIN("select_tickets");
+	int n_tickets = tickets->n_tickets;
+	TicketSelection selection;
+	selection.score = 0;
+	selection.cost = 0;
+	selection.n_selected = 0;
+	selection.selected = calloc(n_tickets > 0 ? n_tickets : 1, sizeof(bool));
+
+	if (n_tickets > MAX_SELECT_TICKETS) {
+		fprintf(stderr, "Ticket selection supports at most %d tickets (%d given)\n", MAX_SELECT_TICKETS, n_tickets);
+		selection.tree = create_empty_graph(cache->map->V);
+		STATS_END("select_tickets");
+		return selection;
+	}
+
+	// Distances between ticket cities (ticket t: cities 2t and 2t + 1), after which the cache is only read
+	int n_cities = n_tickets * 2;
+	int* cities = malloc(sizeof(int) * (n_cities > 0 ? n_cities : 1));
+	for (int t = 0; t < n_tickets; t++) {
+		cities[2 * t] = tickets->from_cities[t];
+		cities[2 * t + 1] = tickets->to_cities[t];
+	}
+	warm_path_cache(cache, cities, n_cities);
+	int* dist = malloc(sizeof(int) * (n_cities > 0 ? n_cities * n_cities : 1));
+	for (int a = 0; a < n_cities; a++) {
+		for (int b = 0; b < n_cities; b++) {
+			dist[a * n_cities + b] = cached_distance(cache, cities[a], cities[b]);
+		}
+	}
+	int* ticket_points = malloc(sizeof(int) * (n_tickets > 0 ? n_tickets : 1));
+	for (int t = 0; t < n_tickets; t++) {
+		int length = dist[2 * t * n_cities + 2 * t + 1];
+		ticket_points[t] = points != NULL ? points[t] : (length != INT_MAX ? length : 0);
+	}
+
+	// Points and bound of every subset (table indexed by subset), those that may fit become candidates
+	int n_sets = 1 << n_tickets;
+	int* score = malloc(sizeof(int) * n_sets);
+	int* bound = malloc(sizeof(int) * n_sets);
+	#pragma omp parallel for schedule(static)
+	for (int set = 0; set < n_sets; set++) {
+		score[set] = 0;
+		for (int t = 0; t < n_tickets; t++) {
+			if (set & (1 << t)) {
+				score[set] += ticket_points[t];
+			}
+		}
+		bound[set] = subset_bound(dist, n_cities, set);
+	}
+	SelectCandidate* candidates = malloc(sizeof(SelectCandidate) * n_sets);
+	int n_candidates = 0;
+	for (int set = 0; set < n_sets; set++) {
+		// A subset without more points than nothing at all is never better
+		if (bound[set] <= budget && score[set] > 0) {
+			candidates[n_candidates].set = set;
+			candidates[n_candidates].score = score[set];
+			candidates[n_candidates].bound = bound[set];
+			n_candidates++;
+		}
+	}
+	qsort(candidates, n_candidates, sizeof(SelectCandidate), compare_candidates);
+
+	// Tree costs of the candidates (table indexed by subset, -1 until built), 1 group of equal points at a time
+	int* tree_cost = malloc(sizeof(int) * n_sets);
+	for (int set = 0; set < n_sets; set++) {
+		tree_cost[set] = -1;
+	}
+	int best_set = 0;
+	for (int first = 0; first < n_candidates && best_set == 0;) {
+		int last = first;
+		while (last < n_candidates && candidates[last].score == candidates[first].score) {
+			last++;
+		}
+
+		int group_cost = INT_MAX;
+		for (int start = first; start < last && candidates[start].bound < group_cost; start += SELECT_BATCH) {
+			int end = start + SELECT_BATCH < last ? start + SELECT_BATCH : last;
+
+			// Subsets ruled out by a cheaper tree of this group are skipped at once, the rest build a Steiner tree
+			#pragma omp parallel for schedule(dynamic)
+			for (int c = start; c < end; c++) {
+				if (candidates[c].bound >= group_cost) {
+					continue;
+				}
+				Graph tree = subset_tree(cache, tickets, candidates[c].set);
+				tree_cost[candidates[c].set] = graph_weight(&tree);
+				destroy_graph(&tree);
+			}
+
+			for (int c = start; c < end; c++) {
+				int cost = tree_cost[candidates[c].set];
+				if (cost != -1 && cost <= budget && cost < group_cost) {
+					group_cost = cost;
+					best_set = candidates[c].set;
+				}
+			}
+		}
+		first = last;
+	}
+
+	// Tree of the tickets kept
+	selection.tree = subset_tree(cache, tickets, best_set);
+	selection.cost = graph_weight(&selection.tree);
+	for (int t = 0; t < n_tickets; t++) {
+		if (best_set & (1 << t)) {
+			selection.selected[t] = true;
+			selection.score += ticket_points[t];
+			selection.n_selected++;
+		}
+	}
+
+	/* Free memory */
+	free(cities);
+	free(dist);
+	free(ticket_points);
+	free(score);
+	free(bound);
+	free(candidates);
+	free(tree_cost);
+
+	STATS_END("select_tickets");
+	return selection;
+}
+
+
+/* Destroy a ticket selection (free all memory)
+ * Parameters:
+ *		self		TicketSelection instance
+ * Return: void
+ */
+void destroy_ticket_selection(TicketSelection* self) {
+	free(self->selected);
+	destroy_graph(&self->tree);
+	self->selected = NULL;
+}
@@ -0,0 +1,47 @@
+#ifndef TICKET_SELECT_H
+#define TICKET_SELECT_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "pathcache.h"
+#include "batch.h"
+
+// Ticket selection tries every subset of the candidate tickets (2^n), so it is limited to this many
+#define MAX_SELECT_TICKETS 16
+
+/* Tickets kept within a budget of train tokens, and the tree that fulfils them
+ *		selected[n] is true if ticket n is kept, score is the sum of their points, cost the train tokens of tree
+ */
+typedef struct ticketSelection {
+	int score;
+	int cost;
+	int n_selected;
+	bool* selected;
+	Graph tree;
+} TicketSelection;
+
+
+/* Choose the tickets to keep (prize-collecting Steiner tree): the most points whose tree fits within the budget
+ *		1. Distances between all ticket cities (path cache, every tree computed up front in parallel)
+ *		2. For every subset, in parallel: its points, and a lower bound on its tree (the distance between its 2
+ *		   farthest cities, and half the MST of the distances between them), kept in a table indexed by subset
+ *		3. Subsets that may fit, from most points down: the trees of all subsets with the same points are built
+ *		   in parallel (solve_steiner_tree(), cheapest bound first), and the cheapest that fits is kept
+ *		Tree costs are those of the selected Steiner tree solver, so a subset only fits if its tree does
+ * Parameters:
+ *		cache			PathCache of the map
+ *		tickets			candidate tickets (at most MAX_SELECT_TICKETS)
+ *		points[]		points of each ticket (NULL: the length of its shortest path, as on the board game)
+ *		budget			train tokens available
+ * Return: TicketSelection (nothing kept if there are too many tickets)
+ */
+TicketSelection select_tickets(PathCache* cache, TicketSet* tickets, int points[], int budget);
+
+
+/* Destroy a ticket selection (free all memory)
+ * Parameters:
+ *		self		TicketSelection instance
+ * Return: void
+ */
+void destroy_ticket_selection(TicketSelection* self);
+#endif
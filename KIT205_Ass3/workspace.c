@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include "pqueue.h"
+#include "stats.h"
+#include "workspace.h"
+
+// Workspace of each thread (NULL until its first search)
+static Workspace* thread_workspace = NULL;
+#pragma omp threadprivate(thread_workspace)
+
+
+/* Free the arrays of a workspace */
+static void destroy_workspace(Workspace* self) {
+	free(self->mark);
+	free(self->dist);
+	free(self->pred_v);
+	destroy_pqueue(&self->queue);
+}
+
+/* Allocate the arrays of a workspace for V vertices (nothing reached or settled) */
+static void create_workspace(Workspace* self, int V) {
+	int size = V > 0 ? V : 1;
+	self->capacity = V;
+	self->epoch = 1;
+	self->mark = calloc(size, sizeof(unsigned int));
+	self->dist = malloc(sizeof(int) * size);
+	self->pred_v = malloc(sizeof(int) * size);
+	self->queue = create_pqueue(size, get_pq_kind());
+	STATS_COUNT(STAT_ALLOCATIONS, 3);
+}
+
+
+/* Borrow the workspace of the calling thread for a new search (each thread owns one, kept for the life of the thread)
+ *		Grown to V vertices if needed, the queue is empty and no vertex is reached or settled
+ *		Only 1 search at a time per thread: borrowing again starts a new search in the same arrays
+ * Parameters:
+ *		V			number of vertices of the graph to search
+ * Return: pointer to the calling thread's Workspace
+ */
+Workspace* borrow_workspace(int V) {
+	Workspace* self = thread_workspace;
+	if (self == NULL) {
+		self = malloc(sizeof(Workspace));
+		create_workspace(self, V);
+		thread_workspace = self;
+		return self;
+	}
+
+	// Too small, or the priority queue implementation was changed since
+	if (V > self->capacity || self->queue.kind != get_pq_kind()) {
+		int capacity = V > self->capacity ? V : self->capacity;
+		destroy_workspace(self);
+		create_workspace(self, capacity);
+		return self;
+	}
+
+	// New epoch (past the settled stamps of the last one): every mark is now out of date
+	//		Once the counter would wrap around, the marks are cleared instead
+	pq_clear(&self->queue);
+	if (self->epoch >= UINT_MAX - 2) {
+		int size = self->capacity > 0 ? self->capacity : 1;
+		memset(self->mark, 0, sizeof(unsigned int) * size);
+		self->epoch = 1;
+	}
+	else {
+		self->epoch += 2;
+	}
+	return self;
+}
+
+/* Free the workspace of the calling thread (it is created again by the next borrow_workspace())
+ * No parameters
+ * Return: void
+ */
+void free_workspace() {
+	if (thread_workspace != NULL) {
+		destroy_workspace(thread_workspace);
+		free(thread_workspace);
+		thread_workspace = NULL;
+	}
+}
+
+/* Free the workspaces of every thread (each thread of a parallel region frees its own)
+ *		Reaches the workspaces borrowed inside earlier parallel regions, as long as every region ran with the
+ *		default number of threads (OpenMP then keeps the same threads, and their threadprivate workspaces)
+ * No parameters
+ * Return: void
+ */
+void free_all_workspaces() {
+	#pragma omp parallel
+	{
+		free_workspace();
+	}
+}
@@ -0,0 +1,61 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <stdbool.h>
+#include <limits.h>
+#include "pqueue.h"
+
+/* Search arrays of 1 thread, reused by every Dijkstra's search and Prim's MST it runs (no allocation per call)
+ *		Entries are epoch-stamped: mark[v] is epoch once the current search reaches v and epoch + 1 once it settles v
+ *		(anything lower is left from an earlier search), and dist[v] / pred_v[v] only hold a value of the current
+ *		search once v is reached, so starting a new search is O(1) instead of clearing V entries
+ *		The macros take the arrays and epoch as local variables (mark, epoch, dist, pred_v), so the hot loops do
+ *		not read them through the workspace after every write
+ */
+typedef struct workspace {
+	int capacity;
+	unsigned int epoch;
+	unsigned int* mark;
+	int* dist;
+	int* pred_v;
+	PQueue queue;
+} Workspace;
+
+// Check if vertex v was reached / settled by the current search
+#define WS_REACHED(v) (mark[v] >= epoch)
+#define WS_SETTLED(v) (mark[v] == epoch + 1)
+
+// Mark vertex v as settled by the current search
+#define WS_SETTLE(v) (mark[v] = epoch + 1)
+
+// First time the current search looks at vertex v: dist = INT_MAX, pred_v = -1
+#define WS_TOUCH(v) (mark[v] < epoch ? (mark[v] = epoch, dist[v] = INT_MAX, pred_v[v] = -1) : 0)
+
+
+/* Borrow the workspace of the calling thread for a new search (each thread owns one, kept for the life of the thread)
+ *		Workspaces of OpenMP worker threads outlive the parallel region that borrowed them, so the next region reuses
+ *		them; free_all_workspaces() frees them all once no more searches are run (before the program exits)
+ *		Grown to V vertices if needed, the queue is empty and no vertex is reached or settled
+ *		Only 1 search at a time per thread: borrowing again starts a new search in the same arrays
+ * Parameters:
+ *		V			number of vertices of the graph to search
+ * Return: pointer to the calling thread's Workspace
+ */
+Workspace* borrow_workspace(int V);
+
+
+/* Free the workspace of the calling thread (it is created again by the next borrow_workspace())
+ * No parameters
+ * Return: void
+ */
+void free_workspace();
+
+
+/* Free the workspaces of every thread (each thread of a parallel region frees its own)
+ *		Reaches the workspaces borrowed inside earlier parallel regions, as long as every region ran with the
+ *		default number of threads (OpenMP then keeps the same threads, and their threadprivate workspaces)
+ * No parameters
+ * Return: void
+ */
+void free_all_workspaces();
+#endif